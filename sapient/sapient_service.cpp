@@ -84,6 +84,45 @@ int CSapientService::SendDetectionReport(const struct protocol_object_item_detec
     return -1;
 }
 
+int CSapientService::SendDetectionReports(const RadarTrack* track)
+{
+    if (!track) {
+        return -1;
+    }
+    
+    size_t count = track->trackObjNum;
+    const size_t capacity = sizeof(track->trackObjList) / sizeof(track->trackObjList[0]);
+    if (count > capacity) {
+        radar_log_error("RadarTrack trackObjNum %zu exceeds capacity %zu", count, capacity);
+        count = capacity;
+    }
+    if (count == 0) {
+        return 0;
+    }
+    
+    return SendDetectionReports(track->trackObjList, count);
+}
+
+int CSapientService::SendDetectionReports(const RadarTrackItem* items, size_t count)
+{
+    if (!m_impl || !m_impl->m_initialized) {
+        return -1;
+    }
+    
+    sapient_tcp_client_t* client = get_sapient_client();
+    if (!client) {
+        radar_log_error("SAPIENT client not available");
+        return -1;
+    }
+    
+    int ret = sapient_tcp_client_send_detection_reports(client, items, count);
+    if (ret != 0) {
+        radar_log_error("Failed to send %zu detection reports: %d", count, ret);
+    }
+    
+    return ret;
+}
+
 int CSapientService::SendStatusReport()
 {
     if (!m_impl || !m_impl->m_initialized) {
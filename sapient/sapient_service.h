@@ -11,6 +11,7 @@
 
 #include <string>
 #include <memory>
+#include "../../common/nanopb/radar.pb.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -36,6 +37,10 @@ public:
     // 发送检测报告（使用 protocol_object_item_detected 结构）
     int SendDetectionReport(const struct protocol_object_item_detected* target);
     
+    // 批量发送检测报告：一次调用发布整帧 RadarTrack 中的所有航迹
+    int SendDetectionReports(const RadarTrack* track);
+    int SendDetectionReports(const RadarTrackItem* items, size_t count);
+    
     // 发送状态报告
     int SendStatusReport();
     
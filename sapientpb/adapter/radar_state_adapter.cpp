@@ -19,7 +19,10 @@
 #include "../../../app/DataPath/data_path.h"
 #include <string.h>
 #include <pthread.h>
+#include <sched.h>
+#include <time.h>
 #include <cmath>
+#include <atomic>
 
 // 辅助函数：获取两个浮点数的最大值
 static inline float max_float(float a, float b) {
@@ -29,9 +32,146 @@ static inline float max_float(float a, float b) {
 #define LOG_TAG "radar_state_adapter"
 
 // 全局变量：保存最新的 RadarState（从 Alink 数据通道截取）
+// 采用 seqlock 保护：写者（Alink 发布路径）写入前后各递增一次序号，序号为奇数表示正在写入；
+// 读者不加锁，读取前后序号一致且为偶数即为一致快照，否则重试。读者之间、读者与写者之间互不阻塞。
 static RadarState g_latest_radar_state;
-static pthread_mutex_t g_radar_state_mutex = PTHREAD_MUTEX_INITIALIZER;
-static bool g_radar_state_valid = false;
+static std::atomic<uint32_t> g_radar_state_seq(0);
+static std::atomic<bool> g_radar_state_valid(false);
+static pthread_mutex_t g_radar_state_writer_mutex = PTHREAD_MUTEX_INITIALIZER;  // 仅用于串行化写者
+
+/**
+ * @brief seqlock 读：在一致快照上执行读取函数（只应拷贝所需字段，可能被重复执行）
+ * @return true 读取成功；false 尚无有效数据
+ */
+template <typename T, typename Fn>
+static bool seqlock_read(const std::atomic<uint32_t> &seq, const std::atomic<bool> &valid,
+                         const T &data, Fn &&fn)
+{
+    if (!valid.load(std::memory_order_acquire)) {
+        return false;
+    }
+    for (unsigned int spins = 0; ; spins++) {
+        uint32_t begin = seq.load(std::memory_order_acquire);
+        if ((begin & 1u) == 0) {
+            fn(data);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (seq.load(std::memory_order_relaxed) == begin) {
+                return true;
+            }
+        }
+        if (spins >= 64) {
+            sched_yield();   // 写者被抢占时让出 CPU
+        }
+    }
+}
+
+// seqlock 写：调用方负责串行化写者
+template <typename T>
+static void seqlock_write(std::atomic<uint32_t> &seq, std::atomic<bool> &valid, T &data, const T &value)
+{
+    uint32_t begin = seq.load(std::memory_order_relaxed);
+    seq.store(begin + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(&data, &value, sizeof(T));
+    seq.store(begin + 2, std::memory_order_release);
+    valid.store(true, std::memory_order_release);
+}
+
+template <typename Fn>
+static bool read_radar_state(Fn &&fn)
+{
+    return seqlock_read(g_radar_state_seq, g_radar_state_valid, g_latest_radar_state, fn);
+}
+
+// ======================== 状态变化检测 ========================
+// 截取时比较状态报告关心的 RadarState 字段（与 sky_status_reportpb.cpp 中 StatusSnapshot 的容差一致），
+// 有变化时通知订阅者，状态报告不必再按固定周期轮询；配置与温度字段由下方的传感器采样器检测。
+// 检测状态只在写者互斥锁内访问（截取路径为唯一写者）。
+struct StatusFields {
+    bool valid;
+    uint32_t sys_status;
+    uint32_t fault_count;
+    uint32_t max_fault_level;
+    double longitude, latitude, altitude;
+    double heading, pitching, rolling;
+};
+
+static StatusFields g_status_fields;
+static std::atomic<radar_state_change_cb> g_change_cb(nullptr);
+static std::atomic<void *> g_change_user(nullptr);
+
+static long long monotonic_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+// 比较并更新 RadarState 中的字段，返回变化掩码（持写者锁调用）
+static unsigned int detect_state_changes(const RadarState *state)
+{
+    const double POSITION_EPSILON = 0.00001;  // 约1米精度
+    const double ANGLE_EPSILON = 0.1;          // 0.1度精度
+
+    StatusFields &f = g_status_fields;
+    unsigned int mask = 0;
+
+    uint32_t sys_status = state->has_sysStatus ? state->sysStatus : 0;
+    uint32_t max_fault_level = 0;
+    for (uint32_t i = 0; i < state->faultCount && i < 64; i++) {
+        if (state->fault[i].faultLevel > max_fault_level) {
+            max_fault_level = state->fault[i].faultLevel;
+        }
+    }
+    double lon = state->has_radarLLA ? state->radarLLA.longitude : 0.0;
+    double lat = state->has_radarLLA ? state->radarLLA.latitude : 0.0;
+    double alt = state->has_radarLLA ? state->radarLLA.altitude : 0.0;
+    double heading = (state->has_attitude && state->attitude.has_heading) ? state->attitude.heading : 0.0;
+    double pitching = (state->has_attitude && state->attitude.has_pitching) ? state->attitude.pitching : 0.0;
+    double rolling = (state->has_attitude && state->attitude.has_rolling) ? state->attitude.rolling : 0.0;
+
+    if (!f.valid || sys_status != f.sys_status) {
+        mask |= RADAR_STATE_CHANGE_SYS_STATUS;
+    }
+    if (!f.valid || state->faultCount != f.fault_count || max_fault_level != f.max_fault_level) {
+        mask |= RADAR_STATE_CHANGE_FAULT;
+    }
+    if (!f.valid || std::fabs(lon - f.longitude) >= POSITION_EPSILON ||
+        std::fabs(lat - f.latitude) >= POSITION_EPSILON ||
+        std::fabs(alt - f.altitude) >= POSITION_EPSILON) {
+        mask |= RADAR_STATE_CHANGE_POSITION;
+    }
+    if (!f.valid || std::fabs(heading - f.heading) >= ANGLE_EPSILON ||
+        std::fabs(pitching - f.pitching) >= ANGLE_EPSILON ||
+        std::fabs(rolling - f.rolling) >= ANGLE_EPSILON) {
+        mask |= RADAR_STATE_CHANGE_ATTITUDE;
+    }
+
+    // 只在超出容差时更新基准值，缓慢漂移累积到容差后仍会触发
+    f.sys_status = sys_status;
+    f.fault_count = state->faultCount;
+    f.max_fault_level = max_fault_level;
+    if (mask & RADAR_STATE_CHANGE_POSITION) {
+        f.longitude = lon;
+        f.latitude = lat;
+        f.altitude = alt;
+    }
+    if (mask & RADAR_STATE_CHANGE_ATTITUDE) {
+        f.heading = heading;
+        f.pitching = pitching;
+        f.rolling = rolling;
+    }
+    return mask;
+}
+
+extern "C" void set_radar_state_change_callback(radar_state_change_cb cb, void *user)
+{
+    pthread_mutex_lock(&g_radar_state_writer_mutex);
+    g_status_fields.valid = false;   // 下次截取重新建立基准并报告全部字段
+    g_change_user.store(user, std::memory_order_relaxed);
+    g_change_cb.store(cb, std::memory_order_release);
+    pthread_mutex_unlock(&g_radar_state_writer_mutex);
+}
 
 /**
  * @brief 从 Alink 数据通道截取 RadarState（在发送前调用）
@@ -46,12 +186,29 @@ extern "C" void capture_radar_state_for_sapient(const RadarState *state)
         return;
     }
     
-    pthread_mutex_lock(&g_radar_state_mutex);
-    memcpy(&g_latest_radar_state, state, sizeof(RadarState));
-    g_radar_state_valid = true;
-    pthread_mutex_unlock(&g_radar_state_mutex);
+    pthread_mutex_lock(&g_radar_state_writer_mutex);
+    seqlock_write(g_radar_state_seq, g_radar_state_valid, g_latest_radar_state, *state);
+
+    // 变化检测在快照发布之后进行，不延长读者的重试窗口
+    unsigned int change_mask = 0;
+    radar_state_change_cb cb = g_change_cb.load(std::memory_order_acquire);
+    if (cb) {
+        if (!g_status_fields.valid) {
+            // 注册后的首次截取：报告全部字段（包括采样器负责的字段）
+            change_mask = RADAR_STATE_CHANGE_MODE | RADAR_STATE_CHANGE_CLUTTER |
+                          RADAR_STATE_CHANGE_TEMPERATURE;
+        }
+        change_mask |= detect_state_changes(state);
+        g_status_fields.valid = true;
+    }
+    pthread_mutex_unlock(&g_radar_state_writer_mutex);
     
     radar_log_debug("Captured RadarState from Alink data path (msgid=0x20)");
+
+    if (cb && change_mask != 0) {
+        radar_log_debug("RadarState status fields changed (mask=0x%x)", change_mask);
+        cb(change_mask, g_change_user.load(std::memory_order_relaxed));
+    }
 }
 
 /**
@@ -68,22 +225,159 @@ extern "C" int get_radar_state(RadarState *state)
         return -1;
     }
     
-    pthread_mutex_lock(&g_radar_state_mutex);
-    
-    if (!g_radar_state_valid) {
-        pthread_mutex_unlock(&g_radar_state_mutex);
+    if (!read_radar_state([state](const RadarState &latest) {
+            memcpy(state, &latest, sizeof(RadarState));
+        })) {
         radar_log_warn("No valid RadarState data captured yet");
         return -1;
     }
     
-    memcpy(state, &g_latest_radar_state, sizeof(RadarState));
-    pthread_mutex_unlock(&g_radar_state_mutex);
-    
     radar_log_debug("RadarState retrieved from captured data (Alink path)");
     
     return 0;
 }
 
+extern "C" int get_radar_heading(double *heading)
+{
+    if (!heading) {
+        return -1;
+    }
+    bool has_heading = false;
+    double value = 0.0;
+    if (!read_radar_state([&](const RadarState &latest) {
+            has_heading = latest.has_attitude && latest.attitude.has_heading;
+            value = latest.attitude.heading;
+        }) || !has_heading) {
+        return -1;
+    }
+    *heading = value;
+    return 0;
+}
+
+extern "C" int get_radar_attitude(double *heading, double *pitch, double *roll)
+{
+    bool has_heading = false;
+    Attitude attitude;
+    if (!read_radar_state([&](const RadarState &latest) {
+            has_heading = latest.has_attitude && latest.attitude.has_heading;
+            attitude = latest.attitude;
+        }) || !has_heading) {
+        return -1;
+    }
+    if (heading) *heading = attitude.heading;
+    if (pitch) *pitch = attitude.has_pitching ? attitude.pitching : 0.0;
+    if (roll) *roll = attitude.has_rolling ? attitude.rolling : 0.0;
+    return 0;
+}
+
+extern "C" int get_radar_lla(double *longitude, double *latitude, double *altitude)
+{
+    bool has_lla = false;
+    double lon = 0.0, lat = 0.0, alt = 0.0;
+    if (!read_radar_state([&](const RadarState &latest) {
+            has_lla = latest.has_radarLLA;
+            lon = latest.radarLLA.longitude;
+            lat = latest.radarLLA.latitude;
+            alt = latest.radarLLA.altitude;
+        }) || !has_lla) {
+        return -1;
+    }
+    if (longitude) *longitude = lon;
+    if (latitude) *latitude = lat;
+    if (altitude) *altitude = alt;
+    return 0;
+}
+
+extern "C" int get_radar_status_bits(unsigned int *status)
+{
+    if (!status) {
+        return -1;
+    }
+    bool has_status = false;
+    unsigned int value = 0;
+    if (!read_radar_state([&](const RadarState &latest) {
+            has_status = latest.has_status;
+            value = latest.status;
+        }) || !has_status) {
+        return -1;
+    }
+    *status = value;
+    return 0;
+}
+
+extern "C" unsigned int get_radar_state_generation(void)
+{
+    return g_radar_state_seq.load(std::memory_order_acquire) >> 1;
+}
+
+// ======================== 传感器采样器 ========================
+// 温度需要同步读取 RF/FPGA 硬件寄存器，配置状态需要按值拷贝 tCfgSystem，都不适合放在状态报告构建路径上。
+// 采样器按自己的节奏（独立的低优先级采样线程周期调用 radar_sensor_sampler_poll()）读取一次并发布到缓存快照，
+// 状态报告通过 get_radar_sensor_sample() 以 seqlock 无锁读取，不接触硬件与配置管理器。
+static radar_sensor_sample_t g_sensor_sample;
+static std::atomic<uint32_t> g_sensor_seq(0);
+static std::atomic<bool> g_sensor_valid(false);
+static pthread_mutex_t g_sensor_sampler_mutex = PTHREAD_MUTEX_INITIALIZER;  // 串行化采样（写者）
+static float g_sensor_temp_baseline = -999.0f;   // 温度变化检测基准（持采样锁访问）
+
+extern "C" void radar_sensor_sampler_poll(void)
+{
+    const float TEMP_EPSILON = 5.0f;   // 5°C 容差（避免频繁变化）
+
+    radar_sensor_sample_t sample;
+    memset(&sample, 0, sizeof(sample));
+
+    // 一次拷贝系统配置，同时取得侦测开关、OTM 与杂波状态
+    tCfgSystem syscfg = CConfigManager::GetInstance()->GetSystemCfg();
+    sample.track_enabled = syscfg.trackEnabled ? 1 : 0;
+    sample.otm_mode = syscfg.otmMode ? 1 : 0;
+    sample.clutter.filter_level = syscfg.filterLevel;
+    sample.clutter.weather_clutter_filter = syscfg.meteCluterFilter;
+    sample.temperature = get_radar_temperature();
+    sample.sample_time_ms = monotonic_ms();
+
+    pthread_mutex_lock(&g_sensor_sampler_mutex);
+    bool first = !g_sensor_valid.load(std::memory_order_relaxed);
+    const radar_sensor_sample_t &prev = g_sensor_sample;   // 只有持采样锁的写者修改，可直接读取
+    unsigned int change_mask = 0;
+    if (!first) {
+        if (sample.track_enabled != prev.track_enabled || sample.otm_mode != prev.otm_mode) {
+            change_mask |= RADAR_STATE_CHANGE_MODE;
+        }
+        if (sample.clutter.filter_level != prev.clutter.filter_level ||
+            sample.clutter.weather_clutter_filter != prev.clutter.weather_clutter_filter) {
+            change_mask |= RADAR_STATE_CHANGE_CLUTTER;
+        }
+    }
+    if (first || std::fabs(sample.temperature - g_sensor_temp_baseline) >= TEMP_EPSILON) {
+        if (!first) change_mask |= RADAR_STATE_CHANGE_TEMPERATURE;
+        g_sensor_temp_baseline = sample.temperature;
+    }
+    seqlock_write(g_sensor_seq, g_sensor_valid, g_sensor_sample, sample);
+    pthread_mutex_unlock(&g_sensor_sampler_mutex);
+
+    radar_state_change_cb cb = g_change_cb.load(std::memory_order_acquire);
+    if (cb && change_mask != 0) {
+        radar_log_debug("Sensor sample changed (mask=0x%x)", change_mask);
+        cb(change_mask, g_change_user.load(std::memory_order_relaxed));
+    }
+}
+
+extern "C" int get_radar_sensor_sample(radar_sensor_sample_t *sample)
+{
+    if (!sample) {
+        return -1;
+    }
+    if (!seqlock_read(g_sensor_seq, g_sensor_valid, g_sensor_sample,
+                      [sample](const radar_sensor_sample_t &latest) {
+                          memcpy(sample, &latest, sizeof(radar_sensor_sample_t));
+                      })) {
+        memset(sample, 0, sizeof(radar_sensor_sample_t));
+        return -1;
+    }
+    return 0;
+}
+
 /**
  * @brief 温度码转浮点数（与 device_info.cpp 中的实现一致）
  */
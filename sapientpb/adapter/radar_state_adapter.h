@@ -22,19 +22,77 @@ extern "C" {
  */
 void capture_radar_state_for_sapient(const RadarState *state);
 
+/* 状态变化掩码（set_radar_state_change_callback 回调参数） */
+#define RADAR_STATE_CHANGE_SYS_STATUS   0x01u   /* sysStatus */
+#define RADAR_STATE_CHANGE_FAULT        0x02u   /* 故障数量 / 最高故障级别 */
+#define RADAR_STATE_CHANGE_POSITION     0x04u   /* 经纬高 */
+#define RADAR_STATE_CHANGE_ATTITUDE     0x08u   /* 航向 / 俯仰 / 横滚 */
+#define RADAR_STATE_CHANGE_MODE         0x10u   /* 侦测开关 / OTM 模式 */
+#define RADAR_STATE_CHANGE_CLUTTER      0x20u   /* 滤波等级 / 气象杂波抑制 */
+#define RADAR_STATE_CHANGE_TEMPERATURE  0x40u   /* 温度（5°C 容差） */
+
+/**
+ * @brief 状态变化回调
+ * @param change_mask 变化字段掩码（RADAR_STATE_CHANGE_*）
+ * @note 在截取线程（Alink 发布路径）中同步调用，回调内只能做投递/调度，不可阻塞
+ */
+typedef void (*radar_state_change_cb)(unsigned int change_mask, void *user);
+
+/**
+ * @brief 注册状态变化回调（NULL 表示取消）
+ * @note 截取时比较状态报告关心的字段，容差与状态报告的 INFO_NEW/INFO_UNCHANGED 判断一致；
+ *       RadarState 字段每次截取都比较，配置与温度字段由传感器采样器在采样时比较
+ *       （此时回调在调用 radar_sensor_sampler_poll() 的线程中执行）。
+ *       注册后的首次截取会报告全部字段变化。
+ */
+void set_radar_state_change_callback(radar_state_change_cb cb, void *user);
+
 /**
  * @brief 获取最新的雷达状态数据（供 SAPIENT 使用）
  * @param state 输出参数，填充 RadarState 结构体
  * @return 0 成功，-1 失败
  * @note 数据来源：从 Alink Protocol 数据通道截取的 RadarState (msgid=0x20)
  *       在 Pub_Track_Attitude() 之前截取，复用已整理好的数据，性能最优
+ *       读取为无锁 seqlock 快照；只需要个别字段时使用下面的字段读取接口
  */
 int get_radar_state(RadarState *state);
 
+/**
+ * @brief 只读取雷达平台航向角（不拷贝整个 RadarState）
+ * @param heading 输出参数，航向角（度，相对于正北）
+ * @return 0 成功，-1 尚无有效数据或 RadarState 中没有航向角
+ * @note 与 get_radar_state() 一样无锁读取，不会与 Alink 发布路径互相阻塞
+ */
+int get_radar_heading(double *heading);
+
+/**
+ * @brief 只读取雷达平台姿态（航向、俯仰、横滚，度），任一输出指针可为 NULL
+ * @return 0 成功（缺少俯仰/横滚时按 0 输出），-1 尚无有效数据或 RadarState 中没有航向角
+ */
+int get_radar_attitude(double *heading, double *pitch, double *roll);
+
+/**
+ * @brief 只读取雷达位置（经度、纬度、海拔），任一输出指针可为 NULL
+ * @return 0 成功，-1 尚无有效数据或 RadarState 中没有位置
+ */
+int get_radar_lla(double *longitude, double *latitude, double *altitude);
+
+/**
+ * @brief 只读取雷达状态位（RadarState.status：运动状态、平台类型、网络速度 B12B11、功耗模式 B14B13 等）
+ * @return 0 成功，-1 尚无有效数据或 RadarState 中没有状态位
+ */
+int get_radar_status_bits(unsigned int *status);
+
+/**
+ * @brief 获取 RadarState 更新代数（每次截取加 1），可用于判断状态是否有更新
+ */
+unsigned int get_radar_state_generation(void);
+
 /**
  * @brief 获取雷达板载温度
  * @return 温度值（°C），如果失败返回 0.0f
- * @note 温度不在 RadarState (0x20) 中，需要单独获取
+ * @note 温度不在 RadarState (0x20) 中，需要单独获取；同步读取硬件寄存器，
+ *       状态报告等周期路径应使用 get_radar_sensor_sample()
  */
 float get_radar_temperature(void);
 
@@ -68,6 +126,32 @@ int get_track_enabled_status(void);
  */
 int get_otm_mode_status(void);
 
+/**
+ * @brief 传感器采样快照：不在 RadarState 中、读取成本较高的状态输入
+ */
+typedef struct {
+    int track_enabled;            // 侦测开关 (ConfigManager trackEnabled)
+    int otm_mode;                 // OTM 模式 (ConfigManager otmMode)
+    clutter_status_t clutter;     // 杂波抑制状态
+    float temperature;            // 雷达温度（°C，RF 与 FPGA 最高值，失败为 0）
+    long long sample_time_ms;     // 采样时间（CLOCK_MONOTONIC 毫秒）
+} radar_sensor_sample_t;
+
+/**
+ * @brief 采样一次温度与配置状态并发布到缓存快照
+ * @note 读取硬件寄存器并拷贝一次系统配置（可能阻塞），由独立的采样线程按固定节奏调用（见 sapient_init.c），
+ *       不可在网络反应器线程中调用；
+ *       配置或温度变化时触发 set_radar_state_change_callback() 注册的回调
+ */
+void radar_sensor_sampler_poll(void);
+
+/**
+ * @brief 读取最近一次的传感器采样快照（seqlock 无锁读取，不接触硬件与配置管理器）
+ * @param sample 输出参数
+ * @return 0 成功，-1 尚未采样（sample 被清零）
+ */
+int get_radar_sensor_sample(radar_sensor_sample_t *sample);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,43 @@
+#include "sapient_arena.h"
+
+namespace {
+struct ThreadArenaBlock {
+    alignas(8) char data[SapientScopedArena::kInitialBlockSize];
+    bool in_use;
+};
+thread_local ThreadArenaBlock t_arena_block = { {0}, false };
+}
+
+SapientScopedArena::BlockLease::BlockLease() : block(nullptr)
+{
+    if (!t_arena_block.in_use) {
+        t_arena_block.in_use = true;
+        block = t_arena_block.data;
+    }
+}
+
+SapientScopedArena::BlockLease::~BlockLease()
+{
+    if (block) {
+        t_arena_block.in_use = false;
+    }
+}
+
+google::protobuf::ArenaOptions SapientScopedArena::make_options(char *block)
+{
+    google::protobuf::ArenaOptions options;
+    if (block) {
+        options.initial_block = block;
+        options.initial_block_size = kInitialBlockSize;
+    }
+    return options;
+}
+
+SapientScopedArena::SapientScopedArena()
+    : lease_(), arena_(make_options(lease_.block))
+{
+}
+
+SapientScopedArena::~SapientScopedArena()
+{
+}
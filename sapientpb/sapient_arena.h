@@ -0,0 +1,56 @@
+/*****************************************************************************
+ * Copyright (c) 2023-2025
+ * Skyfend Technology Co., Ltd
+ *
+ * All rights reserved. Any unauthorized disclosure or publication of the
+ * confidential and proprietary information to any other party will constitute
+ * an infringement of copyright laws.
+ *
+ * @file    sapient_arena.h
+ * @brief   报文构建用的线程级 protobuf arena
+ * @details 每个构建线程持有一块 thread_local 初始块，SapientScopedArena 构造时把它交给
+ *          google::protobuf::Arena 作为首块，析构时整体释放（初始块不归还给系统，下次复用）。
+ *          一条检测报告的所有子消息和字符串都分配在初始块内，稳态下不再调用 malloc。
+ *          同一线程内嵌套使用时，内层 arena 不使用初始块，退化为普通 arena。
+ *****************************************************************************
+ */
+#ifndef __SAPIENT_ARENA_H_
+#define __SAPIENT_ARENA_H_
+
+#include <stddef.h>
+#include <google/protobuf/arena.h>
+
+class SapientScopedArena {
+public:
+    static const size_t kInitialBlockSize = 8u * 1024u;   // 覆盖一条完整的 DetectionReport
+
+    SapientScopedArena();
+    ~SapientScopedArena();
+
+    google::protobuf::Arena *get() { return &arena_; }
+
+    // 释放 arena 上的全部消息（初始块保留，供批量构建时逐条复用）
+    void reset() { arena_.Reset(); }
+
+    // 在 arena 上创建消息（随 arena 一起释放，不能 delete）
+    template <typename T>
+    T *create() { return google::protobuf::Arena::CreateMessage<T>(&arena_); }
+
+private:
+    SapientScopedArena(const SapientScopedArena &);
+    SapientScopedArena &operator=(const SapientScopedArena &);
+
+    // 初始块占用标记：声明在 arena_ 之前，保证 arena_ 先析构、再释放初始块
+    struct BlockLease {
+        char *block;
+        BlockLease();
+        ~BlockLease();
+    };
+
+    static google::protobuf::ArenaOptions make_options(char *block);
+
+    BlockLease lease_;
+    google::protobuf::Arena arena_;
+};
+
+#endif /* __SAPIENT_ARENA_H_ */
@@ -0,0 +1,98 @@
+#include "sapient_clock.h"
+#include <string.h>
+#include <time.h>
+#include <google/protobuf/timestamp.pb.h>
+
+namespace {
+
+// 按线程缓存的秒级前缀："YYYY-MM-DDTHH:MM:SS"
+struct IsoSecondCache {
+    int64_t second;
+    char prefix[19];
+};
+thread_local IsoSecondCache t_iso_cache = { INT64_MIN, {0} };
+
+inline void put2(char *p, unsigned v)
+{
+    p[0] = (char)('0' + v / 10);
+    p[1] = (char)('0' + v % 10);
+}
+
+// Unix 秒 → 日期时间（Howard Hinnant 的 civil_from_days 算法，纯整数运算）
+void format_second_prefix(int64_t unix_sec, char *p)
+{
+    int64_t days = unix_sec / 86400;
+    int64_t sod = unix_sec % 86400;
+    if (sod < 0) {
+        sod += 86400;
+        days -= 1;
+    }
+
+    days += 719468;
+    const int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    const unsigned doe = (unsigned)(days - era * 146097);
+    const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const unsigned mp = (5 * doy + 2) / 153;
+    const unsigned day = doy - (153 * mp + 2) / 5 + 1;
+    const unsigned month = mp < 10 ? mp + 3 : mp - 9;
+    const unsigned year = (unsigned)(yoe + era * 400 + (month <= 2 ? 1 : 0));
+
+    put2(p, (year / 100) % 100);
+    put2(p + 2, year % 100);
+    p[4] = '-';
+    put2(p + 5, month);
+    p[7] = '-';
+    put2(p + 8, day);
+    p[10] = 'T';
+    put2(p + 11, (unsigned)(sod / 3600));
+    p[13] = ':';
+    put2(p + 14, (unsigned)(sod / 60 % 60));
+    p[16] = ':';
+    put2(p + 17, (unsigned)(sod % 60));
+}
+
+} // namespace
+
+SapientTime SapientTime::now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    SapientTime t;
+    t.seconds = (int64_t)ts.tv_sec;
+    t.nanos = (int32_t)ts.tv_nsec;
+    return t;
+}
+
+void SapientTime::to_timestamp(google::protobuf::Timestamp *ts) const
+{
+    ts->set_seconds(seconds);
+    ts->set_nanos(nanos);
+}
+
+size_t SapientTime::format_iso8601(char *out) const
+{
+    IsoSecondCache &cache = t_iso_cache;
+    if (cache.second != seconds) {
+        format_second_prefix(seconds, cache.prefix);
+        cache.second = seconds;
+    }
+    memcpy(out, cache.prefix, sizeof(cache.prefix));
+
+    // 毫秒后缀：固定 3 位，无分支
+    unsigned ms = (unsigned)nanos / 1000000u;
+    out[19] = '.';
+    out[20] = (char)('0' + ms / 100);
+    out[21] = (char)('0' + ms / 10 % 10);
+    out[22] = (char)('0' + ms % 10);
+    out[23] = 'Z';
+    out[24] = '\0';
+    return kIso8601Len;
+}
+
+std::string SapientTime::iso8601() const
+{
+    char buf[kIso8601Len + 1];
+    size_t n = format_iso8601(buf);
+    return std::string(buf, n);
+}
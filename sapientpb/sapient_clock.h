@@ -0,0 +1,49 @@
+/*****************************************************************************
+ * Copyright (c) 2023-2025
+ * Skyfend Technology Co., Ltd
+ *
+ * All rights reserved. Any unauthorized disclosure or publication of the
+ * confidential and proprietary information to any other party will constitute
+ * an infringement of copyright laws.
+ *
+ * @file    sapient_clock.h
+ * @brief   SAPIENT 报文 UTC 时钟
+ * @details 每条报文只采样一次系统时间（SapientTime::now()），同一个采样值同时用于
+ *          ULID 时间部分、ISO 8601 字符串和 protobuf Timestamp，三者严格一致。
+ *          ISO 8601 格式化按线程缓存“秒级前缀”（YYYY-MM-DDTHH:MM:SS），同一秒内只拼接
+ *          毫秒后缀；跨秒时用整数算法换算日期，不调用 gmtime()/put_time()，线程安全。
+ *****************************************************************************
+ */
+#ifndef __SAPIENT_CLOCK_H_
+#define __SAPIENT_CLOCK_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+namespace google { namespace protobuf { class Timestamp; } }
+
+struct SapientTime {
+    static const size_t kIso8601Len = 24;   // "YYYY-MM-DDTHH:MM:SS.mmmZ"
+
+    int64_t seconds;   // Unix 秒
+    int32_t nanos;     // [0, 1e9)
+
+    // 采样当前 UTC 时间（一次 clock_gettime(CLOCK_REALTIME)）
+    static SapientTime now();
+
+    int64_t unix_ms() const { return seconds * 1000 + nanos / 1000000; }
+
+    // 填充 protobuf Timestamp
+    void to_timestamp(google::protobuf::Timestamp *ts) const;
+
+    /**
+     * @brief 格式化为 ISO 8601 UTC 字符串（毫秒精度）
+     * @param out 至少 kIso8601Len + 1 字节
+     * @return 写入的字符数（不含结尾 '\0'）
+     */
+    size_t format_iso8601(char *out) const;
+    std::string iso8601() const;
+};
+
+#endif /* __SAPIENT_CLOCK_H_ */
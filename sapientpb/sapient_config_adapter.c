@@ -63,6 +63,9 @@ static void load_sapient_config(void)
         cJSON *ip_item = cJSON_GetObjectItem(sapient_obj, "ip");
         cJSON *port_item = cJSON_GetObjectItem(sapient_obj, "port");
         cJSON *enabled_item = cJSON_GetObjectItem(sapient_obj, "enabled");
+        cJSON *bytes_item = cJSON_GetObjectItem(sapient_obj, "max_bytes_per_sec");
+        cJSON *msgs_item = cJSON_GetObjectItem(sapient_obj, "max_msgs_per_sec");
+        cJSON *budget_item = cJSON_GetObjectItem(sapient_obj, "track_report_budget");
 
         if (enabled_item && cJSON_IsFalse(enabled_item)) {
             radar_log_info("SAPIENT is disabled in config");
@@ -80,6 +83,18 @@ static void load_sapient_config(void)
         if (port_item && cJSON_IsNumber(port_item)) {
             g_sapient_config.port = port_item->valueint;
         }
+
+        if (bytes_item && cJSON_IsNumber(bytes_item) && bytes_item->valueint > 0) {
+            g_sapient_config.max_bytes_per_sec = (unsigned int)bytes_item->valueint;
+        }
+
+        if (msgs_item && cJSON_IsNumber(msgs_item) && msgs_item->valueint > 0) {
+            g_sapient_config.max_msgs_per_sec = (unsigned int)msgs_item->valueint;
+        }
+
+        if (budget_item && cJSON_IsNumber(budget_item) && budget_item->valueint > 0) {
+            g_sapient_config.track_report_budget = (unsigned int)budget_item->valueint;
+        }
     }
 
     cJSON_Delete(json);
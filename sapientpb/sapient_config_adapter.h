@@ -17,6 +17,9 @@ extern "C" {
 typedef struct {
     const char *ip;
     int port;
+    unsigned int max_bytes_per_sec;   /* 出站整形：字节/秒，0 表示按雷达网络速度状态位自动设置 */
+    unsigned int max_msgs_per_sec;    /* 出站整形：消息/秒，0 同上 */
+    unsigned int track_report_budget; /* 检测报告全局预算：条/秒，0 表示每帧上报全部航迹 */
 } sapient_config_t;
 
 /**
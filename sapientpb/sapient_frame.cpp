@@ -0,0 +1,68 @@
+#include "sapient_frame.h"
+#include <google/protobuf/message_lite.h>
+
+void SapientFrameRecycler::operator()(SapientFrame *frame) const
+{
+    SapientFramePool::instance().recycle(frame);
+}
+
+SapientFramePool &SapientFramePool::instance()
+{
+    // 有意不析构：反应器线程可能在静态析构阶段仍在归还帧缓冲
+    static SapientFramePool *pool = new SapientFramePool();
+    return *pool;
+}
+
+SapientFramePtr SapientFramePool::acquire(size_t body_len)
+{
+    SapientFrame *frame = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!free_.empty()) {
+            frame = free_.back();
+            free_.pop_back();
+        }
+    }
+    if (!frame) {
+        frame = new SapientFrame();
+    }
+    frame->reserve_body(body_len);
+    frame->body_len = 0;
+    frame->has_prefix = true;
+    frame->conflate = SAPIENT_CONFLATE_NONE;
+    frame->lane = SAPIENT_LANE_CONTROL;
+    frame->outbox_seq = -1;
+    return SapientFramePtr(frame);
+}
+
+void SapientFramePool::recycle(SapientFrame *frame)
+{
+    if (!frame) return;
+    if (frame->storage.capacity() <= kMaxPooledCapacity) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (free_.size() < max_pooled_) {
+            free_.push_back(frame);
+            return;
+        }
+    }
+    delete frame;
+}
+
+void SapientFramePool::reserve(size_t frames)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (frames > max_pooled_) max_pooled_ = frames;
+}
+
+int sapient_serialize_to_frame(const google::protobuf::MessageLite &msg, SapientFramePtr &out)
+{
+    size_t body_len = msg.ByteSizeLong();
+    if (body_len > 0xFFFFFFFFu) {
+        return -1;
+    }
+    out = SapientFramePool::instance().acquire(body_len);
+    // ByteSizeLong() 已缓存各子消息长度，这里直接写入预留好前缀空间的缓冲区
+    msg.SerializeWithCachedSizesToArray(out->body());
+    out->commit(body_len);
+    return 0;
+}
@@ -0,0 +1,141 @@
+/*****************************************************************************
+ * Copyright (c) 2023-2025
+ * Skyfend Technology Co., Ltd
+ *
+ * All rights reserved. Any unauthorized disclosure or publication of the
+ * confidential and proprietary information to any other party will constitute
+ * an infringement of copyright laws.
+ *
+ * @file    sapient_frame.h
+ * @brief   SAPIENT 池化帧缓冲
+ * @details 每个帧缓冲在消息体前预留 4 字节空间用于 little-endian 长度前缀，
+ *          protobuf 消息通过 ByteSizeLong() + SerializeWithCachedSizesToArray()
+ *          直接序列化到消息体位置，前缀与消息体连续存放，反应器一次 send() 即可发出。
+ *          帧缓冲用完后归还到池中复用，稳态下不再产生堆分配。
+ *          池中缓存的帧数上限须不小于同时在途的帧数（发送队列容量 + 发件箱重放积压 + 一次
+ *          sendmsg() 聚合的帧数），否则队列积压回落时多出的缓冲被释放，下次积压重新分配。
+ *          池常驻内存不超过 帧数上限 × kMaxPooledCapacity（检测报告帧通常只有数百字节）。
+ *****************************************************************************
+ */
+#ifndef __SAPIENT_FRAME_H_
+#define __SAPIENT_FRAME_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace google { namespace protobuf { class MessageLite; } }
+
+// 发送队列中的合并方式（见 sapient_send_queue.h）
+enum SapientConflateMode {
+    SAPIENT_CONFLATE_NONE = 0,     // 严格 FIFO（注册、状态、告警、TaskAck 等）
+    SAPIENT_CONFLATE_LATEST = 1,   // 同一 conflate_key 只保留最新一帧，原位替换队列中未发送的帧
+    SAPIENT_CONFLATE_FINAL = 2,    // 替换未发送的帧后结束该 key（航迹丢失），之后的同 key 帧重新排队
+};
+
+// 出站优先级通道（数值与 sapient_tcp.h 中的 sapient_lane_t 一致，数值越小优先级越高）
+enum SapientLane {
+    SAPIENT_LANE_CONTROL = 0,      // Registration、TaskAck 及原始字节帧
+    SAPIENT_LANE_ALERT = 1,
+    SAPIENT_LANE_STATUS = 2,
+    SAPIENT_LANE_DETECTION = 3,
+    SAPIENT_LANE_COUNT = 4,
+};
+
+// 帧缓冲（C API 中以不透明类型 sapient_frame_t 暴露）
+struct sapient_frame_t {
+    static const size_t kHeadroom = 4;   // 长度前缀预留空间
+
+    std::vector<uint8_t> storage;        // [0,4) 长度前缀，[4, 4+body_len) 消息体
+    size_t body_len;
+    bool has_prefix;                     // false 表示原始字节（不带长度前缀）
+    int conflate;                        // SapientConflateMode
+    uint32_t conflate_key;               // 合并键（检测报告为雷达航迹 ID）
+    int lane;                            // SapientLane，入队时设置
+    int64_t outbox_seq;                  // 发件箱重放帧的序号（整帧写出后确认），-1 表示非重放帧
+
+    sapient_frame_t()
+        : body_len(0), has_prefix(true), conflate(SAPIENT_CONFLATE_NONE), conflate_key(0),
+          lane(SAPIENT_LANE_CONTROL), outbox_seq(-1) {}
+
+    // 标记为可合并帧（入队前设置）
+    void set_conflate(int mode, uint32_t key) {
+        conflate = mode;
+        conflate_key = key;
+    }
+
+    // 确保消息体区域至少能容纳 len 字节（复用已有容量，不缩容）
+    void reserve_body(size_t len) {
+        if (storage.size() < kHeadroom + len) storage.resize(kHeadroom + len);
+    }
+    uint8_t *body() { return storage.data() + kHeadroom; }
+    size_t body_capacity() const { return storage.size() - kHeadroom; }
+
+    // 写入 4 字节 little-endian 长度前缀
+    void commit(size_t len) {
+        body_len = len;
+        has_prefix = true;
+        uint32_t n = (uint32_t)len;
+        storage[0] = (uint8_t)(n & 0xFF);
+        storage[1] = (uint8_t)((n >> 8) & 0xFF);
+        storage[2] = (uint8_t)((n >> 16) & 0xFF);
+        storage[3] = (uint8_t)((n >> 24) & 0xFF);
+    }
+    // 原始字节帧：不写前缀，发送时跳过预留空间
+    void commit_raw(size_t len) {
+        body_len = len;
+        has_prefix = false;
+    }
+
+    // 需要写入 socket 的完整字节范围
+    const uint8_t *data() const { return has_prefix ? storage.data() : storage.data() + kHeadroom; }
+    size_t size() const { return has_prefix ? kHeadroom + body_len : body_len; }
+};
+typedef struct sapient_frame_t SapientFrame;
+
+// 析构时把帧缓冲归还到全局池
+struct SapientFrameRecycler {
+    void operator()(SapientFrame *frame) const;
+};
+typedef std::unique_ptr<SapientFrame, SapientFrameRecycler> SapientFramePtr;
+
+class SapientFramePool {
+public:
+    static SapientFramePool &instance();
+
+    // 申请一个消息体容量 >= body_len 的帧缓冲（优先复用池中缓冲）
+    SapientFramePtr acquire(size_t body_len);
+
+    // 归还帧缓冲；超大缓冲或池已满时直接释放
+    void recycle(SapientFrame *frame);
+
+    /**
+     * @brief 保证池中最多可缓存 frames 帧（只增不减：多个客户端共用同一个池）
+     * @param frames 同时在途的帧数（发送队列容量 + 其它在途帧）
+     */
+    void reserve(size_t frames);
+
+    // 默认上限：默认发送队列容量 512 + 发件箱重放积压 64 + 一次 sendmsg() 聚合 64
+    static const size_t kDefaultMaxPooledFrames = 640;
+
+private:
+    SapientFramePool() : max_pooled_(kDefaultMaxPooledFrames) {}
+
+    static const size_t kMaxPooledCapacity = 64u * 1024u;       // 超过该容量的缓冲不回收
+
+    std::mutex mutex_;
+    size_t max_pooled_;                                          // 池中最多缓存的帧数
+    std::vector<SapientFrame *> free_;
+};
+
+/**
+ * @brief 将 protobuf 消息直接序列化到池化帧缓冲（消息体前已写好长度前缀）
+ * @param[in]  msg  待序列化的消息
+ * @param[out] out  输出帧
+ * @return 0 成功；-1 失败（消息超过 4GB 等）
+ */
+int sapient_serialize_to_frame(const google::protobuf::MessageLite &msg, SapientFramePtr &out);
+
+#endif /* __SAPIENT_FRAME_H_ */
@@ -0,0 +1,181 @@
+/*****************************************************************************
+ * Copyright (c) 2023-2025
+ * Skyfend Technology Co., Ltd
+ *
+ * All rights reserved. Any unauthorized disclosure or publication of the
+ * confidential and proprietary information to any other party will constitute
+ * an infringement of copyright laws.
+ *
+ * @file    sapient_frame_decoder.h
+ * @brief   SAPIENT 入站流式帧解码器
+ * @details 在一块可复用的接收缓冲区上维护读/写游标：socket 数据直接 recv() 到写游标处，
+ *          解码器就地提取所有完整的“4 字节小端长度前缀 + 消息体”帧，
+ *          以指针 + 长度的形式交给处理函数，不做任何拷贝。
+ *          只有跨越缓冲区末尾的不完整帧才会被搬移到缓冲区开头；
+ *          超过上限的帧按策略跳过（边收边丢弃，不分配内存）或断开连接。
+ *****************************************************************************
+ */
+#ifndef __SAPIENT_FRAME_DECODER_H_
+#define __SAPIENT_FRAME_DECODER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+// 超长帧处理策略（数值与 sapient_tcp.h 中的 sapient_rx_oversize_policy_t 一致）
+enum SapientOversizePolicy {
+    SAPIENT_OVERSIZE_SKIP = 0,        // 跳过该帧的消息体，继续解析后续帧
+    SAPIENT_OVERSIZE_DISCONNECT = 1,  // 视为协议错误，由调用方断开连接
+};
+
+class SapientFrameDecoder {
+public:
+    static const size_t kDefaultInitialCapacity = 64u * 1024u;       // 初始（常驻）缓冲区大小
+    static const uint32_t kDefaultMaxFrameLen = 4u * 1024u * 1024u;  // 默认单帧上限
+
+    SapientFrameDecoder()
+        : initial_capacity_(kDefaultInitialCapacity), max_frame_len_(kDefaultMaxFrameLen),
+          oversize_policy_(SAPIENT_OVERSIZE_SKIP), rd_(0), wr_(0), skip_remaining_(0),
+          frames_(0), oversized_(0) {}
+
+    /**
+     * @brief 配置内存上限
+     * @param initial_capacity 常驻缓冲区大小（0 表示保持不变）；处理完大帧后缓冲区会收缩回该大小
+     * @param max_frame_len    单帧消息体上限（0 表示保持不变），缓冲区最多增长到 4 + max_frame_len
+     * @param oversize_policy  超长帧处理策略（见 SapientOversizePolicy）
+     */
+    void configure(size_t initial_capacity, uint32_t max_frame_len, int oversize_policy) {
+        if (initial_capacity > 0) initial_capacity_ = initial_capacity;
+        if (max_frame_len > 0) max_frame_len_ = max_frame_len;
+        if (oversize_policy == SAPIENT_OVERSIZE_SKIP || oversize_policy == SAPIENT_OVERSIZE_DISCONNECT) {
+            oversize_policy_ = oversize_policy;
+        }
+    }
+
+    /**
+     * @brief 获取可写区域（recv() 直接写入这里）
+     * @param[out] space 可写字节数（> 0）
+     * @return 写入位置
+     */
+    uint8_t *write_ptr(size_t *space) {
+        if (rd_ == wr_) {
+            rd_ = wr_ = 0;   // 缓冲区已空：游标归零，无需搬移
+        }
+        size_t need = pending_need();
+        if (buf_.size() - wr_ < need) {
+            // 只搬移尾部不完整帧的字节（通常远小于缓冲区）
+            if (rd_ > 0) {
+                memmove(buf_.data(), buf_.data() + rd_, wr_ - rd_);
+                wr_ -= rd_;
+                rd_ = 0;
+            }
+            if (buf_.size() - wr_ < need) {
+                buf_.resize(wr_ + need);
+            }
+        }
+        *space = buf_.size() - wr_;
+        return buf_.data() + wr_;
+    }
+
+    // 提交 recv() 实际写入的字节数
+    void commit(size_t n) { wr_ += n; }
+
+    /**
+     * @brief 就地提取所有完整帧
+     * @param fn 处理函数 bool fn(const char *body, size_t len)，返回 false 表示停止解析（例如连接已关闭）
+     * @return 0 正常；1 处理函数要求停止；-1 协议错误（DISCONNECT 策略下的超长帧）
+     */
+    template <typename Fn>
+    int drain(Fn &&fn) {
+        for (;;) {
+            // 正在跳过超长帧：直接丢弃已收到的部分
+            if (skip_remaining_ > 0) {
+                size_t n = wr_ - rd_;
+                if (n > skip_remaining_) n = (size_t)skip_remaining_;
+                rd_ += n;
+                skip_remaining_ -= n;
+                if (skip_remaining_ > 0) break;
+                continue;
+            }
+
+            if (wr_ - rd_ < 4) break;
+            const uint8_t *p = buf_.data() + rd_;
+            uint32_t body_len = (uint32_t)p[0]
+                              | ((uint32_t)p[1] << 8)
+                              | ((uint32_t)p[2] << 16)
+                              | ((uint32_t)p[3] << 24);
+            if (body_len > max_frame_len_) {
+                oversized_++;
+                if (oversize_policy_ == SAPIENT_OVERSIZE_DISCONNECT) {
+                    return -1;
+                }
+                rd_ += 4;
+                skip_remaining_ = body_len;
+                continue;
+            }
+            if (wr_ - rd_ - 4 < body_len) break;   // 消息体尚未收齐
+
+            rd_ += 4 + body_len;
+            if (body_len == 0) continue;           // 空帧：忽略
+            frames_++;
+            if (!fn((const char *)p + 4, (size_t)body_len)) return 1;
+        }
+        shrink_if_idle();
+        return 0;
+    }
+
+    // 丢弃所有缓冲数据（断线重连时调用）
+    void reset() {
+        rd_ = wr_ = 0;
+        skip_remaining_ = 0;
+        shrink_if_idle();
+    }
+
+    // 当前超长帧的长度上限（供日志使用）
+    uint32_t max_frame_len() const { return max_frame_len_; }
+    uint64_t frame_count() const { return frames_; }
+    uint64_t oversized_count() const { return oversized_; }
+
+private:
+    static const size_t kMinRecvSpace = 4u * 1024u;   // 每次 recv() 至少预留的空间
+
+    // 下一次 recv() 需要的最小可写空间：不完整帧需要整帧容纳在缓冲区中
+    size_t pending_need() const {
+        size_t need = kMinRecvSpace;
+        if (skip_remaining_ == 0 && wr_ - rd_ >= 4) {
+            const uint8_t *p = buf_.data() + rd_;
+            uint32_t body_len = (uint32_t)p[0]
+                              | ((uint32_t)p[1] << 8)
+                              | ((uint32_t)p[2] << 16)
+                              | ((uint32_t)p[3] << 24);
+            if (body_len <= max_frame_len_) {
+                size_t missing = 4 + (size_t)body_len - (wr_ - rd_);
+                if (missing > need) need = missing;
+            }
+        }
+        if (buf_.empty() && need < initial_capacity_) need = initial_capacity_;
+        return need;
+    }
+
+    // 处理完大帧后缓冲区空闲时收缩回常驻大小，避免长期占用峰值内存
+    void shrink_if_idle() {
+        if (rd_ == wr_ && buf_.capacity() > initial_capacity_) {
+            std::vector<uint8_t>().swap(buf_);
+            buf_.resize(initial_capacity_);
+            rd_ = wr_ = 0;
+        }
+    }
+
+    std::vector<uint8_t> buf_;
+    size_t initial_capacity_;
+    uint32_t max_frame_len_;
+    int oversize_policy_;
+    size_t rd_;                 // 下一个未解析字节
+    size_t wr_;                 // 下一个写入位置
+    uint64_t skip_remaining_;   // 超长帧剩余待丢弃字节数
+    uint64_t frames_;
+    uint64_t oversized_;
+};
+
+#endif /* __SAPIENT_FRAME_DECODER_H_ */
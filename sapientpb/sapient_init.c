@@ -11,34 +11,67 @@
  *****************************************************************************/
 #include "sapient_init.h"
 #include "sapient_tcp.h"
+#include "sapient_reactor.h"
 #include "sapient_config_adapter.h"
+#include "sapient_track_scheduler.h"
+#include "adapter/radar_state_adapter.h"
 #include "../../common/zlog/skyfend_log.h"
 #include <stddef.h>
+#include <stdint.h>
 #include <string.h>
+#include <time.h>
 #include <arpa/inet.h>
 #include <pthread.h>
 #include <unistd.h>
-#include <time.h>
+#include <errno.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
 
 #define LOG_TAG "sapient_init"
 
 /* 全局 Sapient TCP 客户端句柄 */
 static sapient_tcp_client_t *g_sapient_client = NULL;
 
-/* ========== 后台重连机制 ========== */
-static pthread_t g_reconnect_thread;
-static int g_reconnect_thread_running = 0;
 static pthread_mutex_t g_client_mutex = PTHREAD_MUTEX_INITIALIZER;
 
-/* ========== 状态报告定时发送机制 ========== */
-static pthread_t g_status_report_thread;
-static int g_status_report_thread_running = 0;
-static const int STATUS_REPORT_INTERVAL = 5;  /* 每10秒发送一次状态报告 */
+/* ========== 事件驱动的状态报告 ==========
+ * 断线重连由客户端在 epoll 反应器中自动完成，状态报告也作为反应器定时器运行。
+ * RadarState 截取时检测状态字段变化（radar_state_adapter.h），有变化时尽快发送状态报告；
+ * 两次报告之间至少间隔 STATUS_REPORT_MIN_SPACING_MS，无变化时最长 STATUS_REPORT_HEARTBEAT_MS 发送一次心跳。
+ * 始终只有一个一次性定时器指向下一次发送时间，空闲时反应器不会被周期唤醒。
+ */
+static sapient_timer_id_t g_status_report_timer = 0;
+static const int STATUS_REPORT_INITIAL_DELAY_MS = 2000;  /* 首次发送前等待，确保连接和注册完成 */
+static const int STATUS_REPORT_MIN_SPACING_MS = 200;     /* 两次状态报告的最小间隔 */
+static const int STATUS_REPORT_HEARTBEAT_MS = 5000;      /* 无变化时的心跳间隔 */
 static const int STATUS_REPORT_DISCONNECT_THRESHOLD = 120;  /* 断网后2分钟内重连，不发送状态报告 */
 
+/* 状态报告调度状态（g_status_sched_mutex 保护；不可在持有该锁时获取 g_client_mutex） */
+static pthread_mutex_t g_status_sched_mutex = PTHREAD_MUTEX_INITIALIZER;
+static int g_status_sched_running = 0;
+static unsigned long g_status_timer_seq = 0;    /* 定时器序号：识别已被取消但仍在途的旧定时器 */
+static long long g_status_due_ms = 0;          /* 当前定时器的到期时间 */
+static long long g_status_not_before_ms = 0;   /* 首次发送的最早时间 */
+static long long g_status_last_sent_ms = 0;    /* 上次发送（或尝试发送）的时间 */
+
+/* 传感器采样：温度与配置状态按固定节奏采样并缓存，状态报告只读取缓存（radar_state_adapter.h）。
+ * 采样要同步读取硬件寄存器、拷贝系统配置，可能阻塞，因此在独立的低优先级线程中执行，
+ * 不占用网络反应器线程；反应器只读取 seqlock 快照。
+ */
+static pthread_t g_sensor_sampler_thread;
+static int g_sensor_sampler_running = 0;
+static pthread_mutex_t g_sensor_sampler_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_sensor_sampler_cond;
+static const int SENSOR_SAMPLE_INTERVAL_MS = 1000;
+static const int SENSOR_SAMPLER_NICE = 10;       /* 采样线程降低调度优先级 */
+
+/* 航迹丢失检查：周期淘汰超时航迹并发送 "lost" 报告 */
+static sapient_timer_id_t g_track_sweep_timer = 0;
+static const int TRACK_SWEEP_INTERVAL_MS = 1000;
+
 /* 前置声明 */
-static void start_status_report_thread(void);
-static void stop_status_report_thread(void);
+static void start_status_report_timer(void);
+static void stop_status_report_timer(void);
 
 /* 验证 IP 地址格式是否合法 */
 static int validate_ip(const char *ip)
@@ -82,154 +115,260 @@ static void sapient_on_message(const char *data, size_t len, void *user)
 	pthread_mutex_unlock(&g_client_mutex);
 }
 
-/* ========== 后台重连线程 ========== */
-static void *sapient_reconnect_thread(void *arg)
+static long long monotonic_ms(void)
 {
-	(void)arg;
-	int attempt = 0;
-	const int retry_interval = 10;  /* 每10秒重试一次 */
-	
-	radar_log_info("sapient reconnect thread started");
-	
-	while (g_reconnect_thread_running && g_sapient_client) {
-		attempt++;
-		radar_log_info("sapient reconnect attempt %d", attempt);
-		
-		pthread_mutex_lock(&g_client_mutex);
-		int cres = sapient_tcp_client_connect(g_sapient_client, 5);
-		pthread_mutex_unlock(&g_client_mutex);
-		
-		if (cres == 0) {
-			radar_log_info("sapient reconnect successful after %d attempts", attempt);
-			
-			/* 发送注册报文 */
-			pthread_mutex_lock(&g_client_mutex);
-			int sret = sapient_tcp_client_send_register(g_sapient_client);
-			pthread_mutex_unlock(&g_client_mutex);
-			
-			if (sret != 0) {
-				radar_log_error("sapient_tcp_client_send_register failed after reconnect: %d", sret);
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/* 安排在 due_ms 发送状态报告；已有更早的定时器时保持不变（持 g_status_sched_mutex 调用） */
+static void schedule_status_report_locked(long long due_ms, long long now_ms);
+
+/* ========== 状态报告定时器（在反应器线程中执行） ========== */
+static void sapient_status_report_timer_cb(void *arg)
+{
+	long long now_ms = monotonic_ms();
+	pthread_mutex_lock(&g_status_sched_mutex);
+	if (!g_status_sched_running || (unsigned long)(uintptr_t)arg != g_status_timer_seq) {
+		pthread_mutex_unlock(&g_status_sched_mutex);
+		return;
+	}
+	g_status_report_timer = 0;
+	g_status_last_sent_ms = now_ms;   /* 发送期间到达的变化按最小间隔顺延 */
+	pthread_mutex_unlock(&g_status_sched_mutex);
+
+	pthread_mutex_lock(&g_client_mutex);
+	if (g_sapient_client) {
+		int disconnect_elapsed = sapient_tcp_client_get_disconnect_elapsed_seconds(g_sapient_client);
+
+		/* 按“断网 2 分钟规则”执行：
+		 * - 如果 disconnect_elapsed 在 [0,120) ：不发送（哪怕已经重连成功，也继续抑制，直到满 120s）
+		 * - 如果 disconnect_elapsed >= 120 ：允许发送一次，并清除断网计时，后续恢复正常周期发送
+		 * - 如果 disconnect_elapsed < 0 ：无断网计时（首次连接或已清除），正常发送
+		 */
+		if (disconnect_elapsed >= 0 && disconnect_elapsed < STATUS_REPORT_DISCONNECT_THRESHOLD) {
+			radar_log_debug("disconnect elapsed %d < %d, skip status report",
+				disconnect_elapsed, STATUS_REPORT_DISCONNECT_THRESHOLD);
+		} else {
+			int ret = sapient_tcp_client_send_status_report(g_sapient_client);
+			if (ret != 0) {
+				radar_log_warn("sapient_tcp_client_send_status_report failed: %d", ret);
 			} else {
-				radar_log_info("sapient register sent after reconnect");
+				radar_log_debug("sapient status report sent");
 			}
-			
-			/* 设置回调并启动接收线程 */
-			pthread_mutex_lock(&g_client_mutex);
-			sapient_tcp_client_set_on_message(g_sapient_client, sapient_on_message, NULL);
-			int tret = sapient_tcp_client_start_receive_thread(g_sapient_client);
-			pthread_mutex_unlock(&g_client_mutex);
-			
-			if (tret != 0) {
-				radar_log_error("sapient_tcp_client_start_receive_thread failed after reconnect: %d", tret);
-				/* 继续重试 */
-				sleep(retry_interval);
-				continue;
-			} else {
-				radar_log_info("sapient receive thread started after reconnect");
+			if (disconnect_elapsed >= STATUS_REPORT_DISCONNECT_THRESHOLD) {
+				sapient_tcp_client_clear_disconnect_time(g_sapient_client);
+				radar_log_info("disconnect elapsed %d >= %d, clear disconnect timer and resume normal status reporting",
+					disconnect_elapsed, STATUS_REPORT_DISCONNECT_THRESHOLD);
 			}
-			
-			/* 启动状态报告线程（如果还没启动）
-			 * 状态报告线程会根据断网时间自动判断是否需要发送
-			 */
-			start_status_report_thread();
-			
-			/* 连接成功，退出重连线程 */
-			break;
 		}
-		
-		radar_log_debug("sapient reconnect attempt %d failed, will retry in %d seconds", 
-			 attempt, retry_interval);
-		sleep(retry_interval);
 	}
-	
-	g_reconnect_thread_running = 0;
-	radar_log_info("sapient reconnect thread exited");
-	return NULL;
+	pthread_mutex_unlock(&g_client_mutex);
+
+	/* 下一次心跳 */
+	pthread_mutex_lock(&g_status_sched_mutex);
+	if (g_status_sched_running) {
+		schedule_status_report_locked(now_ms + STATUS_REPORT_HEARTBEAT_MS, monotonic_ms());
+	}
+	pthread_mutex_unlock(&g_status_sched_mutex);
+}
+
+static void schedule_status_report_locked(long long due_ms, long long now_ms)
+{
+	if (due_ms < g_status_not_before_ms) {
+		due_ms = g_status_not_before_ms;
+	}
+	if (g_status_report_timer) {
+		if (g_status_due_ms <= due_ms) {
+			return;
+		}
+		sapient_reactor_cancel_timer(g_status_report_timer);
+		g_status_report_timer = 0;
+	}
+	long long delay_ms = due_ms - now_ms;
+	if (delay_ms < 0) {
+		delay_ms = 0;
+	}
+	g_status_timer_seq++;
+	g_status_report_timer = sapient_reactor_add_timer((int)delay_ms, 0,
+		sapient_status_report_timer_cb, (void *)(uintptr_t)g_status_timer_seq);
+	if (!g_status_report_timer) {
+		radar_log_error("failed to create sapient status report timer");
+		return;
+	}
+	g_status_due_ms = due_ms;
+}
+
+/* RadarState 状态字段变化（在截取线程中调用）：按最小间隔尽快发送状态报告 */
+static void sapient_on_radar_state_change(unsigned int change_mask, void *user)
+{
+	(void)user;
+	long long now_ms = monotonic_ms();
+	pthread_mutex_lock(&g_status_sched_mutex);
+	if (g_status_sched_running) {
+		long long due_ms = g_status_last_sent_ms + STATUS_REPORT_MIN_SPACING_MS;
+		if (due_ms < g_status_not_before_ms) {
+			due_ms = g_status_not_before_ms;
+		}
+		if (due_ms < now_ms) {
+			due_ms = now_ms;
+		}
+		radar_log_debug("radar state changed (mask=0x%x), status report due in %lld ms",
+			change_mask, due_ms - now_ms);
+		schedule_status_report_locked(due_ms, now_ms);
+	}
+	pthread_mutex_unlock(&g_status_sched_mutex);
+}
+
+/* 启动状态报告调度 */
+static void start_status_report_timer(void)
+{
+	pthread_mutex_lock(&g_status_sched_mutex);
+	if (g_status_sched_running) {
+		pthread_mutex_unlock(&g_status_sched_mutex);
+		radar_log_warn("status report timer already running");
+		return;
+	}
+	long long now_ms = monotonic_ms();
+	g_status_sched_running = 1;
+	g_status_not_before_ms = now_ms + STATUS_REPORT_INITIAL_DELAY_MS;
+	g_status_last_sent_ms = 0;
+	schedule_status_report_locked(g_status_not_before_ms, now_ms);
+	pthread_mutex_unlock(&g_status_sched_mutex);
+
+	set_radar_state_change_callback(sapient_on_radar_state_change, NULL);
+	radar_log_info("sapient status report scheduler started (min spacing %d ms, heartbeat %d ms)",
+		STATUS_REPORT_MIN_SPACING_MS, STATUS_REPORT_HEARTBEAT_MS);
+}
+
+/* 停止状态报告调度 */
+static void stop_status_report_timer(void)
+{
+	set_radar_state_change_callback(NULL, NULL);
+
+	pthread_mutex_lock(&g_status_sched_mutex);
+	if (g_status_sched_running) {
+		g_status_sched_running = 0;
+		if (g_status_report_timer) {
+			sapient_reactor_cancel_timer(g_status_report_timer);
+			g_status_report_timer = 0;
+		}
+		radar_log_info("sapient status report timer stopped");
+	}
+	pthread_mutex_unlock(&g_status_sched_mutex);
+}
+
+/* ========== 传感器采样线程（独立于反应器线程） ========== */
+/* 条件变量使用单调时钟，系统时间被校正时采样间隔不受影响 */
+static void sensor_sampler_cond_init(void)
+{
+	pthread_condattr_t attr;
+	pthread_condattr_init(&attr);
+	pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+	pthread_cond_init(&g_sensor_sampler_cond, &attr);
+	pthread_condattr_destroy(&attr);
 }
 
-/* ========== 状态报告定时发送线程 ========== */
-static void *sapient_status_report_thread(void *arg)
+static void *sapient_sensor_sampler_thread(void *arg)
 {
 	(void)arg;
-	radar_log_info("sapient status report thread started");
-	
-	/* 等待一小段时间，确保连接和注册完成 */
-	sleep(2);
-	
-	while (g_status_report_thread_running && g_sapient_client) {
-		pthread_mutex_lock(&g_client_mutex);
-		if (g_sapient_client) {
-			int disconnect_elapsed = sapient_tcp_client_get_disconnect_elapsed_seconds(g_sapient_client);
-
-			/* 按“断网 2 分钟规则”执行：
-			 * - 如果 disconnect_elapsed 在 [0,120) ：不发送（哪怕已经重连成功，也继续抑制，直到满 120s）
-			 * - 如果 disconnect_elapsed >= 120 ：允许发送一次，并清除断网计时，后续恢复正常周期发送
-			 * - 如果 disconnect_elapsed < 0 ：无断网计时（首次连接或已清除），正常发送
-			 */
-			if (disconnect_elapsed >= 0 && disconnect_elapsed < STATUS_REPORT_DISCONNECT_THRESHOLD) {
-				radar_log_debug("disconnect elapsed %d < %d, skip status report",
-					disconnect_elapsed, STATUS_REPORT_DISCONNECT_THRESHOLD);
-			} else {
-				int ret = sapient_tcp_client_send_status_report(g_sapient_client);
-				if (ret != 0) {
-					radar_log_warn("sapient_tcp_client_send_status_report failed: %d", ret);
-				} else {
-					radar_log_debug("sapient status report sent (periodic)");
-				}
-				if (disconnect_elapsed >= STATUS_REPORT_DISCONNECT_THRESHOLD) {
-					sapient_tcp_client_clear_disconnect_time(g_sapient_client);
-					radar_log_info("disconnect elapsed %d >= %d, clear disconnect timer and resume normal status reporting",
-						disconnect_elapsed, STATUS_REPORT_DISCONNECT_THRESHOLD);
-				}
-			}
+	/* Linux 下 nice 值按线程生效：只降低本线程的优先级 */
+	if (setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), SENSOR_SAMPLER_NICE) != 0) {
+		radar_log_warn("failed to lower sapient sensor sampler priority");
+	}
+
+	pthread_mutex_lock(&g_sensor_sampler_mutex);
+	while (g_sensor_sampler_running) {
+		/* 采样时不持锁：停止请求不必等待硬件读取 */
+		pthread_mutex_unlock(&g_sensor_sampler_mutex);
+		radar_sensor_sampler_poll();
+		pthread_mutex_lock(&g_sensor_sampler_mutex);
+
+		struct timespec deadline;
+		clock_gettime(CLOCK_MONOTONIC, &deadline);
+		deadline.tv_sec += SENSOR_SAMPLE_INTERVAL_MS / 1000;
+		deadline.tv_nsec += (long)(SENSOR_SAMPLE_INTERVAL_MS % 1000) * 1000000L;
+		if (deadline.tv_nsec >= 1000000000L) {
+			deadline.tv_sec++;
+			deadline.tv_nsec -= 1000000000L;
 		}
-		pthread_mutex_unlock(&g_client_mutex);
-		
-		/* 等待指定间隔后再次发送 */
-		for (int i = 0; i < STATUS_REPORT_INTERVAL && g_status_report_thread_running; i++) {
-			sleep(1);
+		while (g_sensor_sampler_running &&
+			   pthread_cond_timedwait(&g_sensor_sampler_cond, &g_sensor_sampler_mutex, &deadline) != ETIMEDOUT) {
 		}
 	}
-	
-	radar_log_info("sapient status report thread exited");
+	pthread_mutex_unlock(&g_sensor_sampler_mutex);
 	return NULL;
 }
 
-/* 启动状态报告线程 */
-static void start_status_report_thread(void)
+static void start_sensor_sampler(void)
 {
-	if (g_status_report_thread_running) {
-		radar_log_warn("status report thread already running");
+	static pthread_once_t cond_once = PTHREAD_ONCE_INIT;
+	pthread_once(&cond_once, sensor_sampler_cond_init);
+
+	pthread_mutex_lock(&g_sensor_sampler_mutex);
+	if (g_sensor_sampler_running) {
+		pthread_mutex_unlock(&g_sensor_sampler_mutex);
 		return;
 	}
-	
-	g_status_report_thread_running = 1;
-	if (pthread_create(&g_status_report_thread, NULL, sapient_status_report_thread, NULL) != 0) {
-		radar_log_error("failed to create sapient status report thread");
-		g_status_report_thread_running = 0;
-	} else {
-		pthread_detach(g_status_report_thread);
-		radar_log_info("sapient status report thread created");
+	/* 线程启动后立即采样一次，保证首个状态报告前已有快照 */
+	g_sensor_sampler_running = 1;
+	if (pthread_create(&g_sensor_sampler_thread, NULL, sapient_sensor_sampler_thread, NULL) != 0) {
+		g_sensor_sampler_running = 0;
+		radar_log_error("failed to create sapient sensor sampler thread");
 	}
+	pthread_mutex_unlock(&g_sensor_sampler_mutex);
 }
 
-/* 停止状态报告线程 */
-static void stop_status_report_thread(void)
+static void stop_sensor_sampler(void)
 {
-	if (g_status_report_thread_running) {
-		int was_running = g_status_report_thread_running;
-		g_status_report_thread_running = 0;
-		radar_log_info("stopping sapient status report thread...");
-		/* 等待线程退出（最多等待2秒） */
-		for (int i = 0; i < 20 && was_running; i++) {
-			usleep(100000);  /* 100ms */
+	pthread_mutex_lock(&g_sensor_sampler_mutex);
+	if (!g_sensor_sampler_running) {
+		pthread_mutex_unlock(&g_sensor_sampler_mutex);
+		return;
+	}
+	g_sensor_sampler_running = 0;
+	pthread_cond_signal(&g_sensor_sampler_cond);
+	pthread_mutex_unlock(&g_sensor_sampler_mutex);
+	pthread_join(g_sensor_sampler_thread, NULL);
+}
+
+/* ========== 航迹丢失检查定时器（在反应器线程中执行） ========== */
+static void sapient_track_sweep_timer_cb(void *arg)
+{
+	(void)arg;
+	pthread_mutex_lock(&g_client_mutex);
+	if (g_sapient_client) {
+		int ret = sapient_tcp_client_send_lost_reports(g_sapient_client);
+		if (ret != 0) {
+			radar_log_warn("sapient_tcp_client_send_lost_reports failed: %d", ret);
 		}
-		radar_log_info("sapient status report thread stopped");
+	}
+	pthread_mutex_unlock(&g_client_mutex);
+}
+
+static void start_track_sweep_timer(void)
+{
+	if (g_track_sweep_timer) {
+		return;
+	}
+	g_track_sweep_timer = sapient_reactor_add_timer(TRACK_SWEEP_INTERVAL_MS,
+		TRACK_SWEEP_INTERVAL_MS, sapient_track_sweep_timer_cb, NULL);
+	if (!g_track_sweep_timer) {
+		radar_log_error("failed to create sapient track sweep timer");
+	}
+}
+
+static void stop_track_sweep_timer(void)
+{
+	if (g_track_sweep_timer) {
+		sapient_reactor_cancel_timer(g_track_sweep_timer);
+		g_track_sweep_timer = 0;
 	}
 }
 
 /* Sapient 模块初始化
- * 读取配置、创建客户端、连接、发送注册报文、启动接收线程
+ * 读取配置、创建客户端、连接、发送注册报文、启动接收会话
  * 返回 0 表示成功，负值表示失败或配置未启用
  */
 int sapient_init(void)
@@ -268,6 +407,15 @@ int sapient_init(void)
 		return SAPIENT_ERR_CREATE_FAILED;
 	}
 
+	/* 出站整形：配置了速率时使用配置值，否则按 RadarState 的网络速度状态位自动设置 */
+	if (cfg && (cfg->max_bytes_per_sec > 0 || cfg->max_msgs_per_sec > 0)) {
+		sapient_tcp_client_set_rate_limit(g_sapient_client, cfg->max_bytes_per_sec, cfg->max_msgs_per_sec);
+	}
+	/* 检测报告按航迹价值分配全局预算（确认状态、分类、距离、接近速度） */
+	if (cfg && cfg->track_report_budget > 0) {
+		sapient_track_scheduler_set_budget(cfg->track_report_budget, 0);
+	}
+
 	/* ============ 初始连接尝试：重试3次，每次间隔5秒 ============ */
 	int initial_success = 0;
 	for (int retry = 0; retry < 3; retry++) {
@@ -285,13 +433,13 @@ int sapient_init(void)
 				radar_log_info("sapient register sent successfully");
 			}
 			
-			/* 注册回调并启动后台接收线程 */
+			/* 注册回调并启动接收会话（由反应器读取，断线后自动重连） */
 			sapient_tcp_client_set_on_message(g_sapient_client, sapient_on_message, NULL);
 			int tret = sapient_tcp_client_start_receive_thread(g_sapient_client);
 			if (tret != 0) {
 				radar_log_error("sapient_tcp_client_start_receive_thread failed: %d", tret);
 			} else {
-				radar_log_info("sapient receive thread started");
+				radar_log_info("sapient receive session started");
 				initial_success = 1;
 				
 				/* 注意：根据 SAPIENT 规范，初始状态报告应在收到 RegistrationAck 后发送
@@ -299,8 +447,10 @@ int sapient_init(void)
 				 * sapient_parse_and_handle_message() 中，收到 RegistrationAck 时发送
 				 */
 				
-				/* 启动状态报告定时发送线程 */
-				start_status_report_thread();
+				/* 启动传感器采样线程、状态报告与航迹丢失检查定时器 */
+				start_sensor_sampler();
+				start_status_report_timer();
+				start_track_sweep_timer();
 			}
 			break;
 		}
@@ -312,18 +462,23 @@ int sapient_init(void)
 		}
 	}
 	
-	/* ============ 如果初始连接失败，启动后台重连线程 ============ */
+	/* ============ 如果初始连接失败，转入后台重连 ============
+	 * 接收会话启动后，客户端在反应器中每 10 秒重试一次连接；
+	 * 首次连接成功时会自动发送注册报文（无断线时间戳即视为需要注册）。
+	 * 状态报告定时器会根据断网时间自动判断是否需要发送。
+	 */
 	if (!initial_success) {
 		radar_log_warn("sapient initial connect failed after 3 attempts (15s total)");
-		radar_log_info("starting background reconnect thread...");
-		
-		g_reconnect_thread_running = 1;
-		if (pthread_create(&g_reconnect_thread, NULL, sapient_reconnect_thread, NULL) != 0) {
-			radar_log_error("failed to create sapient reconnect thread");
-			g_reconnect_thread_running = 0;
+		radar_log_info("starting background reconnect on reactor...");
+
+		sapient_tcp_client_set_on_message(g_sapient_client, sapient_on_message, NULL);
+		int tret = sapient_tcp_client_start_receive_thread(g_sapient_client);
+		if (tret != 0) {
+			radar_log_error("failed to start sapient background reconnect: %d", tret);
 		} else {
-			pthread_detach(g_reconnect_thread);
-			radar_log_info("sapient reconnect thread created");
+			start_sensor_sampler();
+			start_status_report_timer();
+			start_track_sweep_timer();
 		}
 	}
 	
@@ -334,26 +489,24 @@ int sapient_init(void)
 /* Sapient 模块清理（如需要在退出时调用） */
 void sapient_cleanup(void)
 {
-	/* 停止状态报告线程 */
-	stop_status_report_thread();
-	
-	/* 停止后台重连线程 */
-	if (g_reconnect_thread_running) {
-		g_reconnect_thread_running = 0;
-		radar_log_info("stopping sapient reconnect thread...");
-		/* 等待线程退出（最多等待1秒） */
-		for (int i = 0; i < 10 && g_reconnect_thread_running; i++) {
-			usleep(100000);  /* 100ms */
-		}
-	}
-	
+	/* 停止状态报告、航迹丢失检查定时器与传感器采样线程 */
+	stop_status_report_timer();
+	stop_sensor_sampler();
+	stop_track_sweep_timer();
+
+	/* 先摘下全局句柄再销毁：销毁时需要与反应器线程同步，
+	 * 不能持有 g_client_mutex（接收回调/定时器回调也会获取该锁）
+	 */
 	pthread_mutex_lock(&g_client_mutex);
-	if (g_sapient_client) {
-		sapient_tcp_client_stop_receive_thread(g_sapient_client);
-		sapient_tcp_client_destroy(g_sapient_client);
-		g_sapient_client = NULL;
+	sapient_tcp_client_t *client = g_sapient_client;
+	g_sapient_client = NULL;
+	pthread_mutex_unlock(&g_client_mutex);
+
+	if (client) {
+		sapient_tcp_client_stop_receive_thread(client);
+		sapient_tcp_client_close(client);
+		sapient_tcp_client_destroy(client);
 		radar_log_info("sapient client cleaned up");
 	}
-	pthread_mutex_unlock(&g_client_mutex);
 }
 
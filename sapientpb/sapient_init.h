@@ -16,8 +16,9 @@
  * @note    线程安全性说明：
  *          - sapient_init() 不可重入，应在 main 线程中调用一次
  *          - get_sapient_client() 返回的句柄全局唯一，多线程读安全
- *          - 发送接口内部有锁保护，可在多线程中安全调用
- *          - 接收由后台线程处理，回调在接收线程上下文执行
+ *          - 发送接口只做组帧入队（由反应器线程发送），可在多线程中安全调用
+ *          - 收发、断线重连与状态报告定时器由同一个 epoll 反应器线程处理，
+ *            回调在反应器线程上下文执行
  *****************************************************************************
  */
 #ifndef __SAPIENT_INIT_H_
@@ -35,14 +36,14 @@ typedef enum {
     SAPIENT_ERR_NOT_CONFIGURED = -1,     /* 配置未设置 */
     SAPIENT_ERR_CREATE_FAILED = -2,      /* 创建客户端失败 */
     SAPIENT_ERR_CONNECT_FAILED = -3,     /* 连接服务器失败 */
-    SAPIENT_ERR_THREAD_FAILED = -4,      /* 启动接收线程失败 */
+    SAPIENT_ERR_THREAD_FAILED = -4,      /* 启动接收会话失败 */
 } sapient_error_t;
 
 /**
  * @brief SAPIENT 模块初始化
  * 
  * @details 从 dev_config 读取配置，创建 TCP 客户端，连接 DMM 服务器，
- *          发送注册报文，启动后台接收线程。
+ *          发送注册报文，启动接收会话与状态报告定时器。
  *          该函数应在 main 线程中调用一次，不可重复调用。
  * 
  * @return sapient_error_t 错误码
@@ -50,7 +51,7 @@ typedef enum {
  *         - SAPIENT_ERR_NOT_CONFIGURED: sapient.ip/port 未配置
  *         - SAPIENT_ERR_CREATE_FAILED: 创建客户端失败
  *         - SAPIENT_ERR_CONNECT_FAILED: 连接 DMM 失败
- *         - SAPIENT_ERR_THREAD_FAILED: 启动接收线程失败
+ *         - SAPIENT_ERR_THREAD_FAILED: 启动接收会话失败
  * 
  * @note 连接成功后会自动发送 Registration 报文
  * @warning 非线程安全，仅允许调用一次
@@ -60,7 +61,7 @@ int sapient_init(void);
 /**
  * @brief SAPIENT 模块清理
  * 
- * @details 停止接收线程，关闭 TCP 连接，释放资源。
+ * @details 停止状态报告定时器与接收会话，关闭 TCP 连接，释放资源。
  *          可在程序退出时调用，非必须。
  * 
  * @warning 调用后 get_sapient_client() 将返回 NULL
@@ -0,0 +1,101 @@
+#include "sapient_json.h"
+#include <atomic>
+#include <mutex>
+#include <google/protobuf/message.h>
+#include <google/protobuf/util/json_util.h>
+
+// 日志模块
+#define LOG_TAG "sapient_json"
+extern "C" {
+    #include "../../common/zlog/skyfend_log.h"
+}
+
+#define LOGD(format, ...) radar_log_debug(format, ##__VA_ARGS__)
+#define LOGE(format, ...) radar_log_error(format, ##__VA_ARGS__)
+
+static std::atomic<int> s_json_mode(SAPIENT_JSON_OFF);
+static std::atomic<unsigned int> s_sample_every(100);
+static std::atomic<unsigned int> s_sample_counter(0);
+
+static std::mutex s_sink_mutex;
+static sapient_json_sink_cb s_sink = NULL;
+static void *s_sink_user = NULL;
+
+// 根据当前模式决定本次是否渲染（热路径上只有原子读，OFF 模式下立即返回）
+static bool should_render(bool is_error)
+{
+    switch (s_json_mode.load(std::memory_order_relaxed)) {
+        case SAPIENT_JSON_ALWAYS:
+            return true;
+        case SAPIENT_JSON_SAMPLED: {
+            if (is_error) return true;
+            unsigned int every = s_sample_every.load(std::memory_order_relaxed);
+            unsigned int n = s_sample_counter.fetch_add(1, std::memory_order_relaxed);
+            return every <= 1 || n % every == 0;
+        }
+        case SAPIENT_JSON_ON_ERROR:
+            return is_error;
+        case SAPIENT_JSON_OFF:
+        default:
+            return false;
+    }
+}
+
+bool sapient_json_render(const google::protobuf::Message &msg, const char *kind,
+                         std::string &out_json, bool is_error, bool print_defaults)
+{
+    out_json.clear();
+    if (!should_render(is_error)) {
+        return false;
+    }
+
+    google::protobuf::util::JsonPrintOptions options;
+    options.add_whitespace = true;
+    options.always_print_primitive_fields = print_defaults;
+    auto status = google::protobuf::util::MessageToJsonString(msg, &out_json, options);
+    if (!status.ok()) {
+        LOGE("Failed to convert %s to JSON: %s\n", kind, status.ToString().c_str());
+        out_json.clear();
+        return false;
+    }
+
+    sapient_json_sink_cb sink;
+    void *user;
+    {
+        std::lock_guard<std::mutex> lock(s_sink_mutex);
+        sink = s_sink;
+        user = s_sink_user;
+    }
+    if (sink) {
+        sink(kind, out_json.c_str(), out_json.size(), user);
+    } else {
+        LOGD("%s%s:\n%s\n", kind, is_error ? " (error)" : "", out_json.c_str());
+    }
+    return true;
+}
+
+extern "C" {
+
+void sapient_json_set_policy(sapient_json_mode_t mode, unsigned int sample_every)
+{
+    if (sample_every > 0) {
+        s_sample_every.store(sample_every, std::memory_order_relaxed);
+    }
+    if (mode >= SAPIENT_JSON_OFF && mode <= SAPIENT_JSON_ON_ERROR) {
+        s_json_mode.store(mode, std::memory_order_relaxed);
+    }
+}
+
+sapient_json_mode_t sapient_json_get_mode(void)
+{
+    return (sapient_json_mode_t)s_json_mode.load(std::memory_order_relaxed);
+}
+
+void sapient_json_set_sink(sapient_json_sink_cb sink, void *user)
+{
+    std::lock_guard<std::mutex> lock(s_sink_mutex);
+    s_sink = sink;
+    s_sink_user = user;
+}
+
+} // extern "C"
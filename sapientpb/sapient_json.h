@@ -0,0 +1,71 @@
+/*****************************************************************************
+ * Copyright (c) 2023-2025
+ * Skyfend Technology Co., Ltd
+ *
+ * All rights reserved. Any unauthorized disclosure or publication of the
+ * confidential and proprietary information to any other party will constitute
+ * an infringement of copyright laws.
+ *
+ * @file    sapient_json.h
+ * @brief   SAPIENT 报文 JSON 渲染策略
+ * @details 基于反射的 MessageToJsonString() 比二进制编码本身还贵，而发送路径并不需要 JSON。
+ *          各 builder 统一通过 sapient_json_render() 决定是否渲染：默认关闭，
+ *          可在运行时切换为全量、1/N 采样或仅错误时渲染。渲染结果写入调用方的 out_json，
+ *          并交给调试 sink（未设置 sink 时以 debug 级别写日志）。
+ *****************************************************************************
+ */
+#ifndef __SAPIENT_JSON_H_
+#define __SAPIENT_JSON_H_
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* JSON 渲染模式 */
+typedef enum {
+    SAPIENT_JSON_OFF = 0,        /* 不渲染（默认），builder 的 out_json 保持为空 */
+    SAPIENT_JSON_ALWAYS = 1,     /* 每条消息都渲染 */
+    SAPIENT_JSON_SAMPLED = 2,    /* 每 sample_every 条渲染 1 条 */
+    SAPIENT_JSON_ON_ERROR = 3,   /* 仅在序列化失败或消息表示错误（如拒绝的 TaskAck）时渲染 */
+} sapient_json_mode_t;
+
+/* 调试 sink：kind 为消息类型（"DetectionReport"、"StatusReport" 等），json 以 '\0' 结尾。
+ * 在 builder 所在线程同步调用，回调内不可长时间阻塞。
+ */
+typedef void (*sapient_json_sink_cb)(const char *kind, const char *json, size_t len, void *user);
+
+/* 设置渲染模式（运行时可切换，任意线程）；sample_every 仅在 SAMPLED 模式下有效，0 表示保持不变 */
+void sapient_json_set_policy(sapient_json_mode_t mode, unsigned int sample_every);
+
+/* 获取当前渲染模式 */
+sapient_json_mode_t sapient_json_get_mode(void);
+
+/* 设置调试 sink（NULL 表示恢复为 debug 日志输出） */
+void sapient_json_set_sink(sapient_json_sink_cb sink, void *user);
+
+#ifdef __cplusplus
+}
+
+#include <string>
+
+namespace google { namespace protobuf { class Message; } }
+
+/**
+ * @brief 按当前策略渲染消息 JSON（供各 builder 调用）
+ * @param msg            待渲染的消息
+ * @param kind           消息类型名，传给 sink 和日志
+ * @param[out] out_json  渲染结果；未渲染时清空
+ * @param is_error       本次是否为错误事件（ON_ERROR 模式下只渲染错误事件）
+ * @param print_defaults 是否输出默认值字段（always_print_primitive_fields）
+ * @return true 已渲染；false 按策略跳过或渲染失败
+ * @note JSON 只用于调试，渲染失败只写日志，不影响报文构建结果
+ */
+bool sapient_json_render(const google::protobuf::Message &msg, const char *kind,
+                         std::string &out_json, bool is_error = false,
+                         bool print_defaults = false);
+
+#endif /* __cplusplus */
+
+#endif /* __SAPIENT_JSON_H_ */
@@ -0,0 +1,348 @@
+#include "sapient_outbox.h"
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// 日志模块
+#define LOG_TAG "sapient_outbox"
+extern "C" {
+    #include "../../common/zlog/skyfend_log.h"
+}
+
+#define LOGI(format, ...) radar_log_info(format, ##__VA_ARGS__)
+#define LOGE(format, ...) radar_log_error(format, ##__VA_ARGS__)
+
+namespace {
+
+const uint32_t kOutboxMagic = 0x424F5053;   // "SPOB"
+const uint32_t kOutboxVersion = 1;
+const size_t kHeaderSize = 4096;            // 头部独占一页，槽位按页对齐开始
+// 乱序确认的序号超过该数量时，head 直接越过最旧的未确认帧：
+// 该帧已在发送队列中被丢弃（溢出策略），永远不会被确认
+const size_t kMaxOutOfOrderCommits = 1024;
+
+// 头部标记：两份交替写入，恢复时取 CRC 有效且 gen 较大的一份
+struct Marker {
+    uint64_t gen;
+    uint64_t head_seq;
+    uint64_t tail_seq;
+    uint32_t crc;
+    uint32_t reserved;
+};
+
+uint32_t crc32_update(uint32_t crc, const void *data, size_t len)
+{
+    static uint32_t table[256];
+    static std::once_flag once;
+    std::call_once(once, []() {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) {
+                c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+            }
+            table[i] = c;
+        }
+    });
+
+    const uint8_t *p = (const uint8_t *)data;
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++) {
+        crc = table[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+uint32_t marker_crc(const Marker &m)
+{
+    return crc32_update(0, &m, offsetof(Marker, crc));
+}
+
+} // namespace
+
+struct SapientOutbox::FileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slot_size;
+    uint32_t slot_count;
+    Marker markers[2];
+};
+
+// 槽位头：crc 覆盖其后的头部字段与消息体
+struct SapientOutbox::SlotHeader {
+    uint32_t crc;
+    uint32_t body_len;
+    uint64_t seq;
+    int64_t unix_ms;
+    uint8_t lane;
+    uint8_t has_prefix;
+    uint8_t reserved[6];
+};
+
+SapientOutbox::SapientOutbox()
+    : fd_(-1), base_(NULL), map_len_(0), slot_size_(0), slot_count_(0),
+      head_seq_(0), read_seq_(0), tail_seq_(0), marker_gen_(0), overwritten_(0) {}
+
+SapientOutbox::~SapientOutbox()
+{
+    close();
+}
+
+int SapientOutbox::open(const char *path, size_t slot_size, size_t slot_count)
+{
+    if (!path || !*path) return -1;
+    if (slot_size == 0) slot_size = kDefaultSlotSize;
+    if (slot_count == 0) slot_count = kDefaultSlotCount;
+    // 槽位按 8 字节对齐，至少能放下槽位头和一个最小的消息体
+    slot_size = (slot_size + 7) & ~(size_t)7;
+    if (slot_size < sizeof(SlotHeader) + 64 || slot_size > 0xFFFFFFFFu || slot_count > 0xFFFFFFFFu) {
+        LOGE("invalid outbox geometry: slot_size=%zu slot_count=%zu\n", slot_size, slot_count);
+        return -1;
+    }
+
+    close();
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    int fd = ::open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        LOGE("open outbox %s failed: %s\n", path, strerror(errno));
+        return -1;
+    }
+    size_t map_len = kHeaderSize + slot_size * slot_count;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size != map_len) {
+        // 新文件或槽位配置变化：按新尺寸重建（旧内容作废）
+        if (ftruncate(fd, 0) != 0 || ftruncate(fd, (off_t)map_len) != 0) {
+            LOGE("resize outbox %s failed: %s\n", path, strerror(errno));
+            ::close(fd);
+            return -1;
+        }
+    }
+    void *p = mmap(NULL, map_len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) {
+        LOGE("mmap outbox %s failed: %s\n", path, strerror(errno));
+        ::close(fd);
+        return -1;
+    }
+
+    fd_ = fd;
+    base_ = (uint8_t *)p;
+    map_len_ = map_len;
+    slot_size_ = slot_size;
+    slot_count_ = slot_count;
+    head_seq_ = read_seq_ = tail_seq_ = 0;
+    committed_.clear();
+    marker_gen_ = 0;
+
+    FileHeader *hdr = (FileHeader *)base_;
+    if (hdr->magic != kOutboxMagic || hdr->version != kOutboxVersion ||
+        hdr->slot_size != (uint32_t)slot_size || hdr->slot_count != (uint32_t)slot_count) {
+        memset(hdr, 0, sizeof(*hdr));
+        hdr->magic = kOutboxMagic;
+        hdr->version = kOutboxVersion;
+        hdr->slot_size = (uint32_t)slot_size;
+        hdr->slot_count = (uint32_t)slot_count;
+        write_marker_locked();
+        LOGI("outbox %s initialized: %zu slots x %zu bytes\n", path, slot_count, slot_size);
+    } else {
+        recover_locked();
+        LOGI("outbox %s opened: %llu frames pending\n", path,
+             (unsigned long long)(tail_seq_ - head_seq_));
+    }
+    return 0;
+}
+
+void SapientOutbox::close()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (base_) {
+        msync(base_, map_len_, MS_SYNC);
+        munmap(base_, map_len_);
+        base_ = NULL;
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    head_seq_ = read_seq_ = tail_seq_ = 0;
+    committed_.clear();
+}
+
+bool SapientOutbox::is_open()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return base_ != NULL;
+}
+
+bool SapientOutbox::slot_valid_locked(uint64_t seq)
+{
+    const uint8_t *slot = base_ + kHeaderSize + (size_t)(seq % slot_count_) * slot_size_;
+    const SlotHeader *sh = (const SlotHeader *)slot;
+    if (sh->seq != seq || sh->body_len > slot_size_ - sizeof(SlotHeader)) {
+        return false;
+    }
+    uint32_t crc = crc32_update(0, slot + sizeof(uint32_t),
+                                sizeof(SlotHeader) - sizeof(uint32_t) + sh->body_len);
+    return crc == sh->crc;
+}
+
+// 写入新一代标记（写在较旧的那一份上，写到一半崩溃时另一份仍然有效）
+void SapientOutbox::write_marker_locked()
+{
+    FileHeader *hdr = (FileHeader *)base_;
+    marker_gen_++;
+    Marker &m = hdr->markers[marker_gen_ & 1];
+    m.gen = marker_gen_;
+    m.head_seq = head_seq_;
+    m.tail_seq = tail_seq_;
+    m.reserved = 0;
+    m.crc = marker_crc(m);
+}
+
+void SapientOutbox::recover_locked()
+{
+    FileHeader *hdr = (FileHeader *)base_;
+    const Marker *best = NULL;
+    for (int i = 0; i < 2; i++) {
+        const Marker &m = hdr->markers[i];
+        if (m.crc != marker_crc(m) || m.tail_seq < m.head_seq) continue;
+        if (!best || m.gen > best->gen) best = &m;
+    }
+    if (best) {
+        marker_gen_ = best->gen;
+        head_seq_ = best->head_seq;
+        tail_seq_ = best->tail_seq;
+    } else {
+        // 两份标记都损坏：扫描全部槽位，按有效帧的序号范围恢复（宁可重复重放也不丢帧）
+        bool any = false;
+        uint64_t lo = 0, hi = 0;
+        for (size_t i = 0; i < slot_count_; i++) {
+            const SlotHeader *sh = (const SlotHeader *)(base_ + kHeaderSize + i * slot_size_);
+            if (sh->seq % slot_count_ != i || !slot_valid_locked(sh->seq)) continue;
+            if (!any || sh->seq < lo) lo = sh->seq;
+            if (!any || sh->seq > hi) hi = sh->seq;
+            any = true;
+        }
+        if (any) {
+            head_seq_ = lo;
+            tail_seq_ = hi + 1;
+        }
+        LOGE("outbox markers corrupted, recovered %llu frames by scanning\n",
+             (unsigned long long)(tail_seq_ - head_seq_));
+    }
+
+    // 标记更新之前写完的帧：沿 tail 向后找序号连续且 CRC 正确的槽位
+    while (slot_valid_locked(tail_seq_)) {
+        tail_seq_++;
+    }
+    if (tail_seq_ - head_seq_ > slot_count_) {
+        head_seq_ = tail_seq_ - slot_count_;
+    }
+    read_seq_ = head_seq_;
+    write_marker_locked();
+}
+
+int SapientOutbox::append(const SapientFrame &frame, int lane, int64_t unix_ms)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!base_) return -1;
+    if (frame.body_len > slot_size_ - sizeof(SlotHeader)) {
+        LOGE("outbox: frame of %zu bytes exceeds slot size %zu, not stored\n", frame.body_len, slot_size_);
+        return -1;
+    }
+
+    if (tail_seq_ - head_seq_ >= slot_count_) {
+        head_seq_++;   // 写满：覆盖最旧的帧（可能已读出、正在发送，其确认将被忽略）
+        overwritten_++;
+        if (read_seq_ < head_seq_) read_seq_ = head_seq_;
+        advance_head_locked();
+    }
+
+    uint8_t *slot = base_ + kHeaderSize + (size_t)(tail_seq_ % slot_count_) * slot_size_;
+    SlotHeader *sh = (SlotHeader *)slot;
+    memcpy(slot + sizeof(SlotHeader), frame.storage.data() + SapientFrame::kHeadroom, frame.body_len);
+    sh->body_len = (uint32_t)frame.body_len;
+    sh->seq = tail_seq_;
+    sh->unix_ms = unix_ms;
+    sh->lane = (uint8_t)lane;
+    sh->has_prefix = frame.has_prefix ? 1 : 0;
+    memset(sh->reserved, 0, sizeof(sh->reserved));
+    sh->crc = crc32_update(0, slot + sizeof(uint32_t), sizeof(SlotHeader) - sizeof(uint32_t) + frame.body_len);
+
+    tail_seq_++;
+    write_marker_locked();
+    return 0;
+}
+
+bool SapientOutbox::peek(SapientFramePtr &out, int *lane, int64_t *unix_ms)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!base_) return false;
+
+    while (read_seq_ < tail_seq_) {
+        uint64_t seq = read_seq_++;
+        if (!slot_valid_locked(seq)) {
+            LOGE("outbox: corrupted slot %llu skipped\n", (unsigned long long)seq);
+            committed_.insert(seq);
+            advance_head_locked();
+            continue;
+        }
+        const uint8_t *slot = base_ + kHeaderSize + (size_t)(seq % slot_count_) * slot_size_;
+        const SlotHeader *sh = (const SlotHeader *)slot;
+        out = SapientFramePool::instance().acquire(sh->body_len);
+        memcpy(out->body(), slot + sizeof(SlotHeader), sh->body_len);
+        if (sh->has_prefix) out->commit(sh->body_len);
+        else out->commit_raw(sh->body_len);
+        out->outbox_seq = (int64_t)seq;
+        if (lane) *lane = sh->lane;
+        if (unix_ms) *unix_ms = sh->unix_ms;
+        return true;
+    }
+    return false;
+}
+
+void SapientOutbox::commit(uint64_t seq)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!base_ || seq < head_seq_ || seq >= read_seq_) return;
+    committed_.insert(seq);
+    advance_head_locked();
+}
+
+// head 越过连续已确认的帧，有变化时写入标记（持锁调用）
+void SapientOutbox::advance_head_locked()
+{
+    uint64_t old_head = head_seq_;
+    while (!committed_.empty() && *committed_.begin() < head_seq_) {
+        committed_.erase(committed_.begin());
+    }
+    if (committed_.size() > kMaxOutOfOrderCommits) {
+        head_seq_ = *committed_.begin();
+    }
+    while (!committed_.empty() && *committed_.begin() == head_seq_) {
+        committed_.erase(committed_.begin());
+        head_seq_++;
+    }
+    if (head_seq_ != old_head) write_marker_locked();
+}
+
+size_t SapientOutbox::size()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return (size_t)(tail_seq_ - read_seq_);
+}
+
+size_t SapientOutbox::unconfirmed()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return (size_t)(read_seq_ - head_seq_ - committed_.size());
+}
+
+uint64_t SapientOutbox::overwritten_count()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return overwritten_;
+}
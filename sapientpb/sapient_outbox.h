@@ -0,0 +1,102 @@
+/*****************************************************************************
+ * Copyright (c) 2023-2025
+ * Skyfend Technology Co., Ltd
+ *
+ * All rights reserved. Any unauthorized disclosure or publication of the
+ * confidential and proprietary information to any other party will constitute
+ * an infringement of copyright laws.
+ *
+ * @file    sapient_outbox.h
+ * @brief   SAPIENT 断线存储转发发件箱
+ * @details 断线期间的出站帧写入内存映射的环形文件：文件由一个头部页和固定大小的槽位组成，
+ *          每个槽位存放一帧（带序号与 CRC），写满后覆盖最旧的帧，磁盘与内存占用恒定。
+ *          头部保存两份交替写入、各自带 CRC 的 head/tail 标记；进程崩溃后取有效且较新的
+ *          一份，再沿 tail 向后扫描序号连续、CRC 正确的槽位，找回标记更新前已写完的帧。
+ *          重连并完成注册后由发送端按速率上限取出重放：peek() 依次读出待重放的帧，
+ *          帧完整写入 socket 后再 commit() 确认，head 只越过已确认的帧。
+ *          进程在重放中途崩溃时，已读出但尚未确认的帧在下次启动后会再次重放（可能重复，不会丢失）。
+ *****************************************************************************
+ */
+#ifndef __SAPIENT_OUTBOX_H_
+#define __SAPIENT_OUTBOX_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <mutex>
+#include <set>
+#include <string>
+#include "sapient_frame.h"
+
+class SapientOutbox {
+public:
+    static const size_t kDefaultSlotSize = 2048;     // 单槽位字节数（含槽位头）
+    static const size_t kDefaultSlotCount = 4096;    // 默认 8MB
+
+    SapientOutbox();
+    ~SapientOutbox();
+
+    /**
+     * @brief 打开（不存在时创建）发件箱文件，恢复上次未重放的帧
+     * @param path       文件路径
+     * @param slot_size  槽位大小（0 使用默认值）；与已有文件不一致时文件被重建
+     * @param slot_count 槽位数（0 使用默认值）
+     * @return 0 成功；-1 失败
+     */
+    int open(const char *path, size_t slot_size, size_t slot_count);
+    void close();
+    bool is_open();
+
+    /**
+     * @brief 持久化一帧（任意线程）
+     * @param frame   待保存的帧（保存消息体与是否带长度前缀，不改变帧本身）
+     * @param lane    出站通道（SapientLane），重放时按原通道入队
+     * @param unix_ms 帧产生的 UTC 时间（毫秒），用于重放时判断检测报告是否过期
+     * @return 0 成功；-1 未打开或帧超过槽位容量
+     * @note 环形写满时覆盖最旧的帧
+     */
+    int append(const SapientFrame &frame, int lane, int64_t unix_ms);
+
+    /**
+     * @brief 读出下一帧待重放的帧（不移除，须在发送完成后 commit()）
+     * @param[out] out     重建的池化帧，out->outbox_seq 为该帧序号
+     * @param[out] lane    原通道
+     * @param[out] unix_ms 原产生时间
+     * @return true 取到；false 没有待重放的帧
+     */
+    bool peek(SapientFramePtr &out, int *lane, int64_t *unix_ms);
+
+    /**
+     * @brief 确认一帧已发送（或已丢弃），之后不再重放
+     * @param seq peek() 得到的帧序号；确认可以乱序，head 只越过连续已确认的帧
+     * @note 已被覆盖或已确认的序号被忽略
+     */
+    void commit(uint64_t seq);
+
+    size_t size();                  // 尚未读出重放的帧数
+    size_t unconfirmed();           // 已读出、尚未确认的帧数
+    uint64_t overwritten_count();   // 写满时被覆盖的帧数
+
+private:
+    struct FileHeader;
+    struct SlotHeader;
+
+    bool slot_valid_locked(uint64_t seq);
+    void advance_head_locked();
+    void write_marker_locked();
+    void recover_locked();
+
+    std::mutex mutex_;
+    int fd_;
+    uint8_t *base_;
+    size_t map_len_;
+    size_t slot_size_;
+    size_t slot_count_;
+    uint64_t head_seq_;       // 最旧一帧（尚未确认）的序号，持久化
+    uint64_t read_seq_;       // 下一帧待读出重放的序号（仅内存，打开时从 head 开始）
+    uint64_t tail_seq_;       // 下一帧的序号
+    std::set<uint64_t> committed_;   // 已确认但 head 尚未越过的序号（乱序确认）
+    uint64_t marker_gen_;
+    uint64_t overwritten_;
+};
+
+#endif /* __SAPIENT_OUTBOX_H_ */
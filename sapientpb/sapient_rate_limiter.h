@@ -0,0 +1,76 @@
+/*****************************************************************************
+ * Copyright (c) 2023-2025
+ * Skyfend Technology Co., Ltd
+ *
+ * All rights reserved. Any unauthorized disclosure or publication of the
+ * confidential and proprietary information to any other party will constitute
+ * an infringement of copyright laws.
+ *
+ * @file    sapient_rate_limiter.h
+ * @brief   SAPIENT 出站令牌桶整形器
+ * @details 每个连接一个字节速率桶和一个消息速率桶（速率为 0 表示不限）。
+ *          反应器写 socket 前按令牌数限制本次出队的帧数与写出的字节数，令牌不足时
+ *          按补足所需时间挂起写出；检测报告调度据此估算链路容量，超出部分在构建前被稀疏，
+ *          而不是堆积在发送队列中。仅在反应器线程中使用，不加锁。
+ *****************************************************************************
+ */
+#ifndef __SAPIENT_RATE_LIMITER_H_
+#define __SAPIENT_RATE_LIMITER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+class SapientTokenBucket {
+public:
+    SapientTokenBucket() : rate_(0.0), burst_(0.0), tokens_(0.0), last_us_(0) {}
+
+    /**
+     * @brief 设置速率与桶容量
+     * @param rate  每秒补充的令牌数，<= 0 表示不限速
+     * @param burst 桶容量（允许的突发量），<= 0 时取 1 秒的令牌数
+     */
+    void configure(double rate, double burst) {
+        bool was_unlimited = unlimited();
+        rate_ = rate > 0.0 ? rate : 0.0;
+        burst_ = burst > 0.0 ? burst : rate_;
+        if (was_unlimited || tokens_ > burst_) tokens_ = burst_;
+    }
+
+    bool unlimited() const { return rate_ <= 0.0; }
+    double rate() const { return rate_; }
+
+    // 按流逝时间补充令牌
+    void refill(int64_t now_us) {
+        if (last_us_ == 0) {
+            tokens_ = burst_;   // 首次使用：桶是满的
+            last_us_ = now_us;
+            return;
+        }
+        if (now_us <= last_us_) return;
+        tokens_ += rate_ * (double)(now_us - last_us_) / 1e6;
+        if (tokens_ > burst_) tokens_ = burst_;
+        last_us_ = now_us;
+    }
+
+    // 当前可用令牌（不限速时返回一个足够大的值）
+    double available() const { return unlimited() ? 1e18 : tokens_; }
+
+    // 扣除令牌（允许透支：字节桶按实际写出的字节扣除，透支部分由之后的补充偿还）
+    void consume(double n) {
+        if (!unlimited()) tokens_ -= n;
+    }
+
+    // 令牌数达到 n 还需等待的微秒数（0 表示已满足）
+    int64_t wait_us(double n) const {
+        if (unlimited() || tokens_ >= n) return 0;
+        return (int64_t)((n - tokens_) * 1e6 / rate_) + 1;
+    }
+
+private:
+    double rate_;
+    double burst_;
+    double tokens_;
+    int64_t last_us_;
+};
+
+#endif /* __SAPIENT_RATE_LIMITER_H_ */
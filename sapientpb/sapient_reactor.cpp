@@ -0,0 +1,275 @@
+#include "sapient_reactor.h"
+#include <memory>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+// 日志模块
+#define LOG_TAG "sapient_reactor"
+extern "C" {
+    #include "../../common/zlog/skyfend_log.h"
+}
+
+#define LOGI(format, ...) radar_log_info(format, ##__VA_ARGS__)
+#define LOGE(format, ...) radar_log_error(format, ##__VA_ARGS__)
+
+SapientReactor &SapientReactor::instance()
+{
+    static SapientReactor *reactor = new SapientReactor();
+    return *reactor;
+}
+
+SapientReactor::SapientReactor()
+    : epfd_(-1), wakeup_fd_(-1), running_(false), next_timer_id_(1)
+{
+    epfd_ = epoll_create1(EPOLL_CLOEXEC);
+    wakeup_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epfd_ < 0 || wakeup_fd_ < 0) {
+        LOGE("sapient reactor init failed: %s\n", strerror(errno));
+        return;
+    }
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = wakeup_fd_;
+    epoll_ctl(epfd_, EPOLL_CTL_ADD, wakeup_fd_, &ev);
+}
+
+int SapientReactor::start()
+{
+    std::lock_guard<std::mutex> lock(lifecycle_mutex_);
+    if (running_) return 0;
+    if (epfd_ < 0 || wakeup_fd_ < 0) return -1;
+    running_ = true;
+    thread_ = std::thread([this]() { loop(); });
+    LOGI("Sapient reactor thread started\n");
+    return 0;
+}
+
+void SapientReactor::stop()
+{
+    std::lock_guard<std::mutex> lock(lifecycle_mutex_);
+    if (!running_) return;
+    running_ = false;
+    wakeup();
+    if (thread_.joinable()) thread_.join();
+    LOGI("Sapient reactor thread stopped\n");
+}
+
+bool SapientReactor::in_loop_thread() const
+{
+    return loop_thread_id_.load() == std::this_thread::get_id();
+}
+
+int SapientReactor::add_fd(int fd, uint32_t events, IoHandler handler)
+{
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = events;
+    ev.data.fd = fd;
+    if (epoll_ctl(epfd_, EPOLL_CTL_ADD, fd, &ev) != 0) {
+        LOGE("epoll_ctl(ADD, %d) failed: %s\n", fd, strerror(errno));
+        return -1;
+    }
+    handlers_[fd] = std::move(handler);
+    return 0;
+}
+
+int SapientReactor::modify_fd(int fd, uint32_t events)
+{
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = events;
+    ev.data.fd = fd;
+    if (epoll_ctl(epfd_, EPOLL_CTL_MOD, fd, &ev) != 0) {
+        LOGE("epoll_ctl(MOD, %d) failed: %s\n", fd, strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+void SapientReactor::remove_fd(int fd)
+{
+    epoll_ctl(epfd_, EPOLL_CTL_DEL, fd, NULL);
+    handlers_.erase(fd);
+}
+
+SapientReactor::TimerId SapientReactor::add_timer(int delay_ms, int interval_ms, Task cb)
+{
+    TimerId id = next_timer_id_++;
+    TimerEntry entry;
+    entry.when = Clock::now() + std::chrono::milliseconds(delay_ms > 0 ? delay_ms : 0);
+    entry.interval_ms = interval_ms;
+    entry.cb = std::move(cb);
+
+    if (in_loop_thread()) {
+        insert_timer(id, std::move(entry));
+    } else {
+        // 定时器表只在反应器线程中修改；投递按 FIFO 执行，随后的 cancel_timer() 一定排在插入之后
+        std::shared_ptr<TimerEntry> holder = std::make_shared<TimerEntry>(std::move(entry));
+        post([this, id, holder]() { insert_timer(id, std::move(*holder)); });
+    }
+    return id;
+}
+
+void SapientReactor::insert_timer(TimerId id, TimerEntry &&entry)
+{
+    timer_heap_.push(HeapItem(entry.when, id));
+    timers_[id] = std::move(entry);
+}
+
+void SapientReactor::cancel_timer(TimerId id)
+{
+    if (id == 0) return;
+    if (in_loop_thread()) {
+        timers_.erase(id);
+    } else {
+        post([this, id]() { timers_.erase(id); });
+    }
+}
+
+void SapientReactor::post(Task task)
+{
+    bool need_wakeup;
+    {
+        std::lock_guard<std::mutex> lock(post_mutex_);
+        need_wakeup = posted_.empty();   // 队列非空说明已有一次唤醒在途，合并唤醒
+        posted_.push_back(std::move(task));
+    }
+    if (need_wakeup) wakeup();
+}
+
+void SapientReactor::run_sync(Task task)
+{
+    if (in_loop_thread() || !running_) {
+        task();
+        return;
+    }
+    std::mutex done_mutex;
+    std::condition_variable done_cv;
+    bool done = false;
+    post([&]() {
+        task();
+        std::lock_guard<std::mutex> lock(done_mutex);
+        done = true;
+        done_cv.notify_one();
+    });
+    std::unique_lock<std::mutex> lock(done_mutex);
+    done_cv.wait(lock, [&]() { return done; });
+}
+
+void SapientReactor::wakeup()
+{
+    uint64_t one = 1;
+    ssize_t n = write(wakeup_fd_, &one, sizeof(one));
+    (void)n;
+}
+
+void SapientReactor::run_posted()
+{
+    std::vector<Task> tasks;
+    {
+        std::lock_guard<std::mutex> lock(post_mutex_);
+        tasks.swap(posted_);
+    }
+    for (size_t i = 0; i < tasks.size(); i++) {
+        tasks[i]();
+    }
+}
+
+void SapientReactor::run_timers()
+{
+    Clock::time_point now = Clock::now();
+    while (!timer_heap_.empty() && timer_heap_.top().first <= now) {
+        HeapItem item = timer_heap_.top();
+        timer_heap_.pop();
+
+        auto it = timers_.find(item.second);
+        if (it == timers_.end() || it->second.when != item.first) {
+            continue;   // 已取消或已重新调度的过期堆元素
+        }
+
+        // 回调中可能取消自身或添加新定时器，先拷贝回调再执行
+        Task cb = it->second.cb;
+        if (it->second.interval_ms > 0) {
+            it->second.when = now + std::chrono::milliseconds(it->second.interval_ms);
+            timer_heap_.push(HeapItem(it->second.when, item.second));
+        } else {
+            timers_.erase(it);
+        }
+        cb();
+    }
+}
+
+int SapientReactor::next_timeout_ms()
+{
+    // 清理堆顶已取消的定时器，避免为其提前唤醒
+    while (!timer_heap_.empty()) {
+        auto it = timers_.find(timer_heap_.top().second);
+        if (it != timers_.end() && it->second.when == timer_heap_.top().first) break;
+        timer_heap_.pop();
+    }
+    if (timer_heap_.empty()) return -1;   // 无定时器：一直阻塞到有 I/O 或投递任务
+
+    auto delta = std::chrono::duration_cast<std::chrono::milliseconds>(
+        timer_heap_.top().first - Clock::now()).count();
+    if (delta <= 0) return 0;
+    // 向上取整到毫秒，避免提前醒来后空转一轮
+    return (int)delta + 1;
+}
+
+void SapientReactor::loop()
+{
+    loop_thread_id_ = std::this_thread::get_id();
+    struct epoll_event events[kMaxEvents];
+
+    while (running_) {
+        int n = epoll_wait(epfd_, events, kMaxEvents, next_timeout_ms());
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            LOGE("epoll_wait failed: %s\n", strerror(errno));
+            break;
+        }
+
+        for (int i = 0; i < n; i++) {
+            int fd = events[i].data.fd;
+            if (fd == wakeup_fd_) {
+                uint64_t cnt;
+                while (read(wakeup_fd_, &cnt, sizeof(cnt)) > 0) {}
+                continue;
+            }
+            auto it = handlers_.find(fd);
+            if (it == handlers_.end()) continue;   // 本轮中已被移除
+            // 处理函数可能移除自身（断线），拷贝后再调用
+            IoHandler handler = it->second;
+            handler(events[i].events);
+        }
+
+        run_posted();
+        run_timers();
+    }
+
+    // 退出前执行剩余的投递任务，保证 run_sync() 的调用方不会永久等待
+    run_posted();
+    loop_thread_id_ = std::thread::id();
+}
+
+extern "C" {
+
+sapient_timer_id_t sapient_reactor_add_timer(int delay_ms, int interval_ms,
+                                             sapient_reactor_timer_cb cb, void *user)
+{
+    if (!cb) return 0;
+    SapientReactor &reactor = SapientReactor::instance();
+    if (reactor.start() != 0) return 0;
+    return (sapient_timer_id_t)reactor.add_timer(delay_ms, interval_ms, [cb, user]() { cb(user); });
+}
+
+void sapient_reactor_cancel_timer(sapient_timer_id_t id)
+{
+    SapientReactor::instance().cancel_timer((SapientReactor::TimerId)id);
+}
+
+} // extern "C"
@@ -0,0 +1,128 @@
+/*****************************************************************************
+ * Copyright (c) 2023-2025
+ * Skyfend Technology Co., Ltd
+ *
+ * All rights reserved. Any unauthorized disclosure or publication of the
+ * confidential and proprietary information to any other party will constitute
+ * an infringement of copyright laws.
+ *
+ * @file    sapient_reactor.h
+ * @brief   SAPIENT epoll 反应器
+ * @details 单线程 epoll 事件循环，统一负责非阻塞 socket 的读、写、连接完成
+ *          以及定时器（重连、RegistrationAck 超时、周期状态报告）。
+ *          一个反应器线程可同时服务多个客户端连接；空闲时阻塞在 epoll_wait()
+ *          上直到最近的定时器到期，不再有轮询式的周期唤醒。
+ *****************************************************************************
+ */
+#ifndef __SAPIENT_REACTOR_H_
+#define __SAPIENT_REACTOR_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 定时器回调（在反应器线程中执行，回调内不可长时间阻塞） */
+typedef void (*sapient_reactor_timer_cb)(void *user);
+
+/* 定时器句柄，0 表示无效 */
+typedef unsigned long long sapient_timer_id_t;
+
+/* 在共享反应器上添加定时器：delay_ms 后首次触发，interval_ms > 0 时周期触发。
+ * 反应器线程未启动时会自动启动。返回定时器句柄，失败返回 0。
+ */
+sapient_timer_id_t sapient_reactor_add_timer(int delay_ms, int interval_ms,
+                                             sapient_reactor_timer_cb cb, void *user);
+
+/* 取消定时器（可在任意线程调用；正在执行的回调不会被打断） */
+void sapient_reactor_cancel_timer(sapient_timer_id_t id);
+
+#ifdef __cplusplus
+}
+
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+class SapientReactor {
+public:
+    typedef std::function<void(uint32_t events)> IoHandler;
+    typedef std::function<void()> Task;
+    typedef uint64_t TimerId;
+
+    // 进程内共享的反应器（有意不析构，避免静态析构阶段与反应器线程竞争）
+    static SapientReactor &instance();
+
+    // 启动反应器线程（已启动时直接返回 0）
+    int start();
+
+    // 停止反应器线程并等待其退出（不可在反应器线程中调用）
+    void stop();
+
+    bool in_loop_thread() const;
+
+    /* 以下 fd 相关接口只能在反应器线程中调用 */
+    int add_fd(int fd, uint32_t events, IoHandler handler);
+    int modify_fd(int fd, uint32_t events);
+    void remove_fd(int fd);
+
+    // 添加定时器（任意线程）：delay_ms 后触发，interval_ms > 0 时周期触发
+    TimerId add_timer(int delay_ms, int interval_ms, Task cb);
+
+    // 取消定时器（任意线程）
+    void cancel_timer(TimerId id);
+
+    // 投递任务到反应器线程执行（任意线程，FIFO）
+    void post(Task task);
+
+    // 在反应器线程中执行任务并等待完成；在反应器线程中调用时直接执行
+    void run_sync(Task task);
+
+private:
+    SapientReactor();
+
+    typedef std::chrono::steady_clock Clock;
+
+    struct TimerEntry {
+        Clock::time_point when;
+        int interval_ms;
+        Task cb;
+    };
+    // 小顶堆元素：(到期时间, 定时器 id)，取消的定时器惰性跳过
+    typedef std::pair<Clock::time_point, TimerId> HeapItem;
+
+    void loop();
+    void wakeup();
+    void run_posted();
+    void run_timers();
+    int next_timeout_ms();
+    void insert_timer(TimerId id, TimerEntry &&entry);
+
+    static const int kMaxEvents = 16;
+
+    int epfd_;
+    int wakeup_fd_;                          // eventfd：跨线程投递任务时唤醒 epoll_wait()
+    std::thread thread_;
+    std::atomic<std::thread::id> loop_thread_id_;
+    std::atomic<bool> running_;
+    std::mutex lifecycle_mutex_;
+
+    std::unordered_map<int, IoHandler> handlers_;   // 仅反应器线程访问
+
+    std::unordered_map<TimerId, TimerEntry> timers_; // 仅反应器线程访问
+    std::priority_queue<HeapItem, std::vector<HeapItem>, std::greater<HeapItem> > timer_heap_;
+    std::atomic<TimerId> next_timer_id_;
+
+    std::mutex post_mutex_;
+    std::vector<Task> posted_;
+};
+
+#endif /* __cplusplus */
+
+#endif /* __SAPIENT_REACTOR_H_ */
@@ -0,0 +1,61 @@
+#include "sapient_region_index.h"
+#include <math.h>
+#include <algorithm>
+
+void SapientRegionIndex::build(const std::vector<Box> &boxes)
+{
+    boxes_.clear();
+    indices_.clear();
+    level_bounds_.clear();
+    item_count_ = boxes.size();
+    if (item_count_ == 0) return;
+
+    // STR 排序：先按中心经度切成 ceil(sqrt(叶子节点数)) 个条带，条带内按中心纬度排序
+    std::vector<uint32_t> order(item_count_);
+    for (size_t i = 0; i < item_count_; i++) order[i] = (uint32_t)i;
+    auto center_lon = [&boxes](uint32_t i) { return boxes[i].min_lon + boxes[i].max_lon; };
+    auto center_lat = [&boxes](uint32_t i) { return boxes[i].min_lat + boxes[i].max_lat; };
+    std::sort(order.begin(), order.end(),
+              [&](uint32_t a, uint32_t b) { return center_lon(a) < center_lon(b); });
+    size_t leaf_nodes = (item_count_ + kNodeSize - 1) / kNodeSize;
+    size_t slice_size = (size_t)ceil(sqrt((double)leaf_nodes)) * kNodeSize;
+    for (size_t s = 0; s < item_count_; s += slice_size) {
+        auto first = order.begin() + s;
+        auto last = order.begin() + std::min(s + slice_size, item_count_);
+        std::sort(first, last, [&](uint32_t a, uint32_t b) { return center_lat(a) < center_lat(b); });
+    }
+
+    size_t total = item_count_;
+    for (size_t n = item_count_; n > 1;) {
+        n = (n + kNodeSize - 1) / kNodeSize;
+        total += n;
+    }
+    boxes_.reserve(total);
+    indices_.reserve(total);
+    for (size_t i = 0; i < item_count_; i++) {
+        boxes_.push_back(boxes[order[i]]);
+        indices_.push_back(order[i]);
+    }
+    level_bounds_.push_back(item_count_);
+
+    // 逐层把相邻的 kNodeSize 个节点打包为一个父节点，直到只剩根节点
+    size_t level_start = 0;
+    size_t level_end = item_count_;
+    while (level_end - level_start > 1) {
+        for (size_t i = level_start; i < level_end; i += kNodeSize) {
+            size_t end = std::min(i + kNodeSize, level_end);
+            Box b = boxes_[i];
+            for (size_t k = i + 1; k < end; k++) {
+                b.min_lon = std::min(b.min_lon, boxes_[k].min_lon);
+                b.min_lat = std::min(b.min_lat, boxes_[k].min_lat);
+                b.max_lon = std::max(b.max_lon, boxes_[k].max_lon);
+                b.max_lat = std::max(b.max_lat, boxes_[k].max_lat);
+            }
+            boxes_.push_back(b);
+            indices_.push_back((uint32_t)i);
+        }
+        level_start = level_end;
+        level_end = boxes_.size();
+        level_bounds_.push_back(level_end);
+    }
+}
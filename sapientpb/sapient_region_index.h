@@ -0,0 +1,90 @@
+/*****************************************************************************
+ * Copyright (c) 2023-2025
+ * Skyfend Technology Co., Ltd
+ *
+ * All rights reserved. Any unauthorized disclosure or publication of the
+ * confidential and proprietary information to any other party will constitute
+ * an infringement of copyright laws.
+ *
+ * @file    sapient_region_index.h
+ * @brief   区域包围盒的静态打包 R 树
+ * @details 一次性批量构建（STR：按中心经度分条带、条带内按中心纬度排序，再逐层每 16 个打包），
+ *          构建后不可修改，所有节点存放在一块连续数组中。查询"哪些包围盒包含该经纬度"
+ *          只下降到包含该点的子树，复杂度约为 O(log n + 命中数)。
+ *          由 Task 区域编译时构建（sapient_task_filter.h），不在检测热路径上。
+ *****************************************************************************
+ */
+#ifndef __SAPIENT_REGION_INDEX_H_
+#define __SAPIENT_REGION_INDEX_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+class SapientRegionIndex {
+public:
+    struct Box {
+        double min_lon, min_lat, max_lon, max_lat;
+
+        bool contains(double lon, double lat) const {
+            return lon >= min_lon && lon <= max_lon && lat >= min_lat && lat <= max_lat;
+        }
+    };
+
+    /**
+     * @brief 批量构建索引（替换原有内容）
+     * @param boxes 包围盒，查询时以其下标作为 ID 返回
+     */
+    void build(const std::vector<Box> &boxes);
+
+    size_t size() const { return item_count_; }
+    bool empty() const { return item_count_ == 0; }
+
+    /**
+     * @brief 依次访问包含 (lon, lat) 的包围盒
+     * @param fn  bool fn(size_t id)，返回 true 时停止查询
+     * @return true 被 fn 提前停止；false 已访问全部命中项
+     */
+    template <typename Fn>
+    bool visit(double lon, double lat, Fn fn) const
+    {
+        if (item_count_ == 0) return false;
+
+        // 待访问的子节点组：{组起始位置, 所在层}；每层最多压入 kNodeSize 个，栈深度有界
+        struct Pending { uint32_t start; uint32_t level; };
+        Pending stack[kMaxLevels * kNodeSize];
+        size_t top = 0;
+        size_t start = boxes_.size() - 1;
+        size_t level = level_bounds_.size() - 1;
+        for (;;) {
+            size_t end = start + kNodeSize < level_bounds_[level] ? start + kNodeSize : level_bounds_[level];
+            for (size_t pos = start; pos < end; pos++) {
+                if (!boxes_[pos].contains(lon, lat)) continue;
+                if (start < item_count_) {
+                    if (fn((size_t)indices_[pos])) return true;
+                } else {
+                    stack[top].start = indices_[pos];
+                    stack[top].level = (uint32_t)(level - 1);
+                    top++;
+                }
+            }
+            if (top == 0) return false;
+            top--;
+            start = stack[top].start;
+            level = stack[top].level;
+        }
+    }
+
+private:
+    static const size_t kNodeSize = 16;
+    static const size_t kMaxLevels = 8;       // 16^8 个包围盒，远超实际区域数
+
+    // 所有层的包围盒连续存放：[0, item_count_) 为叶子（已按 STR 排序），其后逐层为父节点
+    std::vector<Box> boxes_;
+    // 叶子：原始 ID；父节点：其子节点组在 boxes_ 中的起始位置
+    std::vector<uint32_t> indices_;
+    std::vector<size_t> level_bounds_;        // 各层在 boxes_ 中的结束位置
+    size_t item_count_ = 0;
+};
+
+#endif /* __SAPIENT_REGION_INDEX_H_ */
@@ -0,0 +1,303 @@
+#include "sapient_send_queue.h"
+#include <chrono>
+
+// 默认防饿死权重：告警只让位于控制帧；状态、检测在更高优先级通道持续有帧时，每 8 帧至少出队一帧
+static const unsigned int kDefaultLaneWait[SAPIENT_LANE_COUNT] = { 0, 0, 8, 8 };
+
+SapientSendQueue::SapientSendQueue(size_t capacity)
+    : total_(0), capacity_(capacity > 0 ? capacity : 1), policy_(SAPIENT_OVERFLOW_DROP_OLDEST),
+      block_timeout_ms_(100), closed_(false), dropped_(0), conflated_(0)
+{
+    for (int i = 0; i < SAPIENT_LANE_COUNT; i++) {
+        lanes_[i].max_wait = kDefaultLaneWait[i];
+    }
+}
+
+void SapientSendQueue::configure(size_t capacity, int policy, int block_timeout_ms)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (capacity > 0) capacity_ = capacity;
+    if (policy >= SAPIENT_OVERFLOW_DROP_OLDEST && policy <= SAPIENT_OVERFLOW_BLOCK) {
+        policy_ = policy;
+    }
+    if (block_timeout_ms >= 0) block_timeout_ms_ = block_timeout_ms;
+    // 容量变大时唤醒阻塞中的生产者
+    not_full_.notify_all();
+}
+
+void SapientSendQueue::set_lane_weight(int lane, unsigned int max_wait)
+{
+    if (lane <= SAPIENT_LANE_CONTROL || lane >= SAPIENT_LANE_COUNT) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    lanes_[lane].max_wait = max_wait;
+}
+
+int SapientSendQueue::lane_of(const SapientFramePtr &frame)
+{
+    int lane = frame->lane;
+    return (lane >= 0 && lane < SAPIENT_LANE_COUNT) ? lane : SAPIENT_LANE_CONTROL;
+}
+
+// 淘汰比 lane 优先级更低的通道中最旧的一帧（从最低优先级通道开始）；返回 false 表示没有可淘汰的帧
+bool SapientSendQueue::drop_lower_locked(int lane)
+{
+    for (int i = SAPIENT_LANE_COUNT - 1; i > lane; i--) {
+        if (!lanes_[i].frames.empty()) {
+            pop_front_locked(lanes_[i], NULL);
+            dropped_++;
+            return true;
+        }
+    }
+    return false;
+}
+
+// 为 lane 通道的新帧腾出位置（持锁调用）；返回 false 表示新帧应被丢弃
+// 队列满时先淘汰低优先级通道的帧，只有不存在更低优先级的帧时才按溢出策略处理
+bool SapientSendQueue::make_room_locked(std::unique_lock<std::mutex> &lock, bool allow_block, int lane)
+{
+    if (closed_) {
+        dropped_++;
+        return false;
+    }
+
+    while (total_ >= capacity_ && drop_lower_locked(lane)) {}
+    if (total_ >= capacity_) {
+        int policy = policy_;
+        if (policy == SAPIENT_OVERFLOW_BLOCK && !allow_block) {
+            policy = SAPIENT_OVERFLOW_DROP_NEWEST;
+        }
+        switch (policy) {
+            case SAPIENT_OVERFLOW_DROP_NEWEST:
+                dropped_++;
+                return false;
+
+            case SAPIENT_OVERFLOW_BLOCK: {
+                auto deadline = std::chrono::steady_clock::now() +
+                                std::chrono::milliseconds(block_timeout_ms_);
+                bool has_room = not_full_.wait_until(lock, deadline, [this]() {
+                    return closed_ || total_ < capacity_;
+                });
+                if (!has_room || closed_) {
+                    dropped_++;
+                    return false;
+                }
+                break;
+            }
+
+            case SAPIENT_OVERFLOW_DROP_OLDEST:
+            default:
+                // 只丢弃本通道最旧的帧，不挤掉更高优先级的帧；容量可能被调小，一次性丢弃到有空位为止
+                while (total_ >= capacity_ && !lanes_[lane].frames.empty()) {
+                    pop_front_locked(lanes_[lane], NULL);
+                    dropped_++;
+                }
+                if (total_ >= capacity_) {
+                    dropped_++;
+                    return false;
+                }
+                break;
+        }
+    }
+    return true;
+}
+
+// 可合并帧：队列中已有同 key 的未发送帧时原位替换（旧帧归还到池中），返回 true
+bool SapientSendQueue::try_conflate_locked(SapientFramePtr &frame)
+{
+    if (frame->conflate == SAPIENT_CONFLATE_NONE || closed_) return false;
+    Lane &lane = lanes_[lane_of(frame)];
+    auto it = lane.pending_keys.find(frame->conflate_key);
+    if (it == lane.pending_keys.end()) return false;
+
+    SapientFramePtr &slot = lane.frames[(size_t)(it->second - lane.head_seq)];
+    slot = std::move(frame);
+    if (slot->conflate == SAPIENT_CONFLATE_FINAL) {
+        lane.pending_keys.erase(it);   // 航迹已结束：之后的同 key 帧重新排队，不能覆盖 lost 报告
+    }
+    conflated_++;
+    return true;
+}
+
+void SapientSendQueue::push_back_locked(SapientFramePtr &&frame)
+{
+    Lane &lane = lanes_[lane_of(frame)];
+    if (frame->conflate == SAPIENT_CONFLATE_LATEST) {
+        lane.pending_keys[frame->conflate_key] = lane.head_seq + lane.frames.size();
+    }
+    lane.frames.push_back(std::move(frame));
+    total_++;
+}
+
+// 放回队首的帧已出队过、不在合并索引中，不会再被替换（可能已部分写出）
+void SapientSendQueue::push_front_locked(SapientFramePtr &&frame)
+{
+    Lane &lane = lanes_[lane_of(frame)];
+    lane.frames.push_front(std::move(frame));
+    lane.head_seq--;
+    total_++;
+}
+
+// 出队通道队首帧并维护合并索引；out 为 NULL 时直接丢弃
+void SapientSendQueue::pop_front_locked(Lane &lane, SapientFramePtr *out)
+{
+    SapientFramePtr &front = lane.frames.front();
+    if (front->conflate == SAPIENT_CONFLATE_LATEST) {
+        auto it = lane.pending_keys.find(front->conflate_key);
+        if (it != lane.pending_keys.end() && it->second == lane.head_seq) {
+            lane.pending_keys.erase(it);
+        }
+    }
+    if (out) *out = std::move(front);
+    lane.frames.pop_front();
+    lane.head_seq++;
+    total_--;
+}
+
+// 选择下一个出队的通道（持锁调用）：严格优先级，但等待次数达到权重的
+// 低优先级通道优先出队一帧；返回 -1 表示队列为空
+int SapientSendQueue::select_lane_locked()
+{
+    int chosen = -1;
+    for (int i = 0; i < SAPIENT_LANE_COUNT; i++) {
+        if (lanes_[i].frames.empty()) continue;
+        if (chosen < 0) {
+            chosen = i;   // 最高优先级的非空通道
+        } else if (lanes_[i].max_wait > 0 && lanes_[i].waited >= lanes_[i].max_wait) {
+            chosen = i;   // 防饿死：更高优先级通道持续有帧时强制轮到一次
+            break;
+        }
+    }
+    for (int i = 0; i < SAPIENT_LANE_COUNT; i++) {
+        Lane &lane = lanes_[i];
+        lane.waited = (i == chosen || lane.frames.empty()) ? 0 : lane.waited + 1;
+    }
+    return chosen;
+}
+
+int SapientSendQueue::push(SapientFramePtr &&frame, bool allow_block)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (try_conflate_locked(frame)) {
+        return 0;
+    }
+    if (!make_room_locked(lock, allow_block, lane_of(frame))) {
+        return -1;
+    }
+    // BLOCK 策略等待期间可能已有同 key 帧入队
+    if (!try_conflate_locked(frame)) {
+        push_back_locked(std::move(frame));
+    }
+    return 0;
+}
+
+size_t SapientSendQueue::push_batch(std::vector<SapientFramePtr> &frames, bool allow_block)
+{
+    size_t accepted = 0;
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (size_t i = 0; i < frames.size(); i++) {
+        if (!frames[i]) continue;
+        if (try_conflate_locked(frames[i])) {
+            accepted++;
+            continue;
+        }
+        if (make_room_locked(lock, allow_block, lane_of(frames[i]))) {
+            if (!try_conflate_locked(frames[i])) {
+                push_back_locked(std::move(frames[i]));
+            }
+            accepted++;
+        }
+    }
+    lock.unlock();
+    frames.clear();   // 被丢弃的帧在这里归还到帧缓冲池
+    return accepted;
+}
+
+void SapientSendQueue::push_front(SapientFramePtr &&frame)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    push_front_locked(std::move(frame));
+}
+
+bool SapientSendQueue::try_pop(SapientFramePtr &out)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    int lane = select_lane_locked();
+    if (lane < 0) {
+        return false;
+    }
+    pop_front_locked(lanes_[lane], &out);
+    lanes_[lane].popped++;
+    lock.unlock();
+    not_full_.notify_one();
+    return true;
+}
+
+size_t SapientSendQueue::try_pop_batch(std::deque<SapientFramePtr> &out, size_t max_frames)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    size_t n = 0;
+    while (n < max_frames) {
+        int lane = select_lane_locked();
+        if (lane < 0) break;
+        out.emplace_back();
+        pop_front_locked(lanes_[lane], &out.back());
+        lanes_[lane].popped++;
+        n++;
+    }
+    lock.unlock();
+    if (n > 0) not_full_.notify_all();
+    return n;
+}
+
+// 各帧放回所属通道的队首，通道内保持原顺序
+void SapientSendQueue::push_front_batch(std::deque<SapientFramePtr> &frames)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    while (!frames.empty()) {
+        push_front_locked(std::move(frames.back()));
+        frames.pop_back();
+    }
+}
+
+void SapientSendQueue::close()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+    }
+    not_full_.notify_all();
+}
+
+void SapientSendQueue::reopen()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    closed_ = false;
+}
+
+size_t SapientSendQueue::size()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return total_;
+}
+
+uint64_t SapientSendQueue::dropped_count()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return dropped_;
+}
+
+uint64_t SapientSendQueue::conflated_count()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return conflated_;
+}
+
+void SapientSendQueue::lane_stats(int lane, size_t *queued, uint64_t *popped)
+{
+    if (queued) *queued = 0;
+    if (popped) *popped = 0;
+    if (lane < 0 || lane >= SAPIENT_LANE_COUNT) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (queued) *queued = lanes_[lane].frames.size();
+    if (popped) *popped = lanes_[lane].popped;
+}
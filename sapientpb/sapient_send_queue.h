@@ -0,0 +1,145 @@
+/*****************************************************************************
+ * Copyright (c) 2023-2025
+ * Skyfend Technology Co., Ltd
+ *
+ * All rights reserved. Any unauthorized disclosure or publication of the
+ * confidential and proprietary information to any other party will constitute
+ * an infringement of copyright laws.
+ *
+ * @file    sapient_send_queue.h
+ * @brief   SAPIENT 出站发送队列（有界 MPSC）
+ * @details 生产者（跟踪线程、状态定时器、接收回调）只负责把已组帧的池化帧缓冲
+ *          （4 字节长度前缀 + 消息体，见 sapient_frame.h）入队，由反应器线程
+ *          在 socket 可写时出队并写入。生产者永远不接触 socket，也不会被重连阻塞。
+ *          检测报告按航迹 ID 合并：同一航迹尚未发送的报告被新报告原位替换（保持原排队位置），
+ *          链路变慢时队列深度受在线航迹数约束，DMM 不会依次收到一串过时位置；
+ *          其余帧（注册、状态、告警、TaskAck）保持严格 FIFO。
+ *          帧按类别分入优先级通道（控制 > 告警 > 状态 > 检测，见 SapientLane），出队时严格按
+ *          优先级选择；低优先级通道连续被跳过的帧数达到其权重时强制出队一帧，避免饿死。
+ *          队列满时优先淘汰低优先级通道最旧的帧，检测流量饱和时控制帧不会被挤掉。
+ *****************************************************************************
+ */
+#ifndef __SAPIENT_SEND_QUEUE_H_
+#define __SAPIENT_SEND_QUEUE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include "sapient_frame.h"
+
+// 队列溢出策略（数值与 sapient_tcp.h 中的 sapient_queue_overflow_policy_t 一致）
+enum SapientQueueOverflowPolicy {
+    SAPIENT_OVERFLOW_DROP_OLDEST = 0,  // 丢弃队首最旧的帧，新帧入队
+    SAPIENT_OVERFLOW_DROP_NEWEST = 1,  // 丢弃当前要入队的新帧
+    SAPIENT_OVERFLOW_BLOCK = 2,        // 阻塞等待空位，超过期限后丢弃新帧
+};
+
+class SapientSendQueue {
+public:
+    explicit SapientSendQueue(size_t capacity = 512);
+
+    /**
+     * @brief 设置通道的防饿死权重
+     * @param lane     通道（SAPIENT_LANE_ALERT 及以下；控制通道优先级最高，无需设置）
+     * @param max_wait 该通道有帧等待时，最多让更高优先级通道连续出队的帧数（0 表示只按严格优先级）
+     */
+    void set_lane_weight(int lane, unsigned int max_wait);
+
+    /**
+     * @brief 修改队列容量与溢出策略（运行时可调）
+     * @param capacity         最大帧数，0 表示保持不变
+     * @param policy           溢出策略（见 SapientQueueOverflowPolicy）
+     * @param block_timeout_ms BLOCK 策略下的最长等待时间（毫秒）
+     */
+    void configure(size_t capacity, int policy, int block_timeout_ms);
+
+    /**
+     * @brief 入队一帧到 frame->lane 通道（生产者调用，可多线程并发）
+     * @note 可合并帧（frame->conflate != NONE）若队列中已有同 key 未发送帧，则原位替换，不占新位置
+     * @param allow_block 是否允许按 BLOCK 策略等待；消费者线程自身入队时必须为 false，
+     *                    此时 BLOCK 策略退化为丢弃新帧
+     * @return 0 入队成功；-1 队列已关闭或按溢出策略丢弃了该帧
+     */
+    int push(SapientFramePtr &&frame, bool allow_block = true);
+
+    /**
+     * @brief 一次加锁入队多帧（同一帧雷达数据的批量检测报告）
+     * @param frames      待入队的帧，调用后被清空（被丢弃的帧归还到池中）
+     * @param allow_block 同 push()
+     * @return 实际入队的帧数，每帧按溢出策略单独处理
+     */
+    size_t push_batch(std::vector<SapientFramePtr> &frames, bool allow_block = true);
+
+    /**
+     * @brief 将帧放回所属通道的队首（断线时未发完的帧，保证重连后优先重发）
+     * @note 不受容量限制，避免消费者自身因溢出策略阻塞
+     */
+    void push_front(SapientFramePtr &&frame);
+
+    // 按原顺序将多帧放回队首（调用后 frames 被清空）
+    void push_front_batch(std::deque<SapientFramePtr> &frames);
+
+    /**
+     * @brief 非阻塞出队一帧（仅反应器线程调用）
+     * @return true 取到帧；false 队列为空
+     */
+    bool try_pop(SapientFramePtr &out);
+
+    /**
+     * @brief 非阻塞出队最多 max_frames 帧，追加到 out 末尾（仅反应器线程调用，供 writev 聚合发送）
+     * @return 出队的帧数
+     */
+    size_t try_pop_batch(std::deque<SapientFramePtr> &out, size_t max_frames);
+
+    // 关闭队列：唤醒阻塞中的生产者，之后的 push 全部失败
+    void close();
+
+    // 重新打开队列（客户端重新连接后使用）
+    void reopen();
+
+    size_t size();
+    uint64_t dropped_count();
+    uint64_t conflated_count();   // 被新报告原位替换的帧数
+
+    // 单个通道的统计：当前排队帧数、累计出队帧数（任一指针可为 NULL）
+    void lane_stats(int lane, size_t *queued, uint64_t *popped);
+
+private:
+    struct Lane {
+        std::deque<SapientFramePtr> frames;
+        // 合并索引：key → 未发送帧的绝对序号；队列下标 = 序号 - head_seq
+        std::unordered_map<uint32_t, uint64_t> pending_keys;
+        uint64_t head_seq;        // frames 队首元素的绝对序号
+        unsigned int max_wait;    // 防饿死权重
+        unsigned int waited;      // 有帧等待期间被跳过的次数
+        uint64_t popped;
+
+        Lane() : head_seq(0), max_wait(0), waited(0), popped(0) {}
+    };
+
+    static int lane_of(const SapientFramePtr &frame);
+    bool make_room_locked(std::unique_lock<std::mutex> &lock, bool allow_block, int lane);
+    bool drop_lower_locked(int lane);
+    bool try_conflate_locked(SapientFramePtr &frame);
+    void push_back_locked(SapientFramePtr &&frame);
+    void push_front_locked(SapientFramePtr &&frame);
+    void pop_front_locked(Lane &lane, SapientFramePtr *out);
+    int select_lane_locked();
+
+    Lane lanes_[SAPIENT_LANE_COUNT];
+    size_t total_;                // 所有通道的帧数之和
+    std::mutex mutex_;
+    std::condition_variable not_full_;
+    size_t capacity_;
+    int policy_;
+    int block_timeout_ms_;
+    bool closed_;
+    uint64_t dropped_;
+    uint64_t conflated_;
+};
+
+#endif /* __SAPIENT_SEND_QUEUE_H_ */
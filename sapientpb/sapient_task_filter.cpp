@@ -0,0 +1,421 @@
+#include "sapient_task_filter.h"
+#include "../sapient/task.pb.h"
+#include <math.h>
+#include <strings.h>
+
+// 日志模块
+#define LOG_TAG "sapient_filter"
+
+extern "C" {
+    #include "../../common/zlog/skyfend_log.h"
+}
+
+#define LOGI(format, ...) radar_log_info(format, ##__VA_ARGS__)
+#define LOGE(format, ...) radar_log_error(format, ##__VA_ARGS__)
+
+using namespace sapient_msg::bsi_flex_335_v2_0;
+
+namespace {
+
+const uint32_t kClassOtherBit = 1u << 6;
+const uint32_t kAllClasses = 0x7F;
+// 多边形最小面积（平方度，约 1 平方米），低于该值视为退化
+const double kMinPolygonArea = 1e-10;
+
+// 雷达分类 → 位（0~5 各占一位，其余取值归入"其它"）
+inline uint32_t class_bit(uint32_t classification)
+{
+    return classification < 6 ? (1u << classification) : kClassOtherBit;
+}
+
+// SAPIENT 分类名 → 雷达分类位集（与 DetectionReport 构建时的映射一致：直升机按 "Other" 上报）
+uint32_t class_mask_of(const std::string &type)
+{
+    static const struct { const char *name; uint32_t mask; } kClassNames[] = {
+        { "Unknown", 1u << 0 },
+        { "Air vehicle", 1u << 1 },
+        { "UAV rotary wing", 1u << 1 },
+        { "Human", 1u << 2 },
+        { "Land vehicle", 1u << 3 },
+        { "Animal", 1u << 4 },
+        { "Bird", 1u << 4 },
+        { "Other", (1u << 5) | kClassOtherBit },
+    };
+    for (size_t i = 0; i < sizeof(kClassNames) / sizeof(kClassNames[0]); i++) {
+        if (strcasecmp(type.c_str(), kClassNames[i].name) == 0) return kClassNames[i].mask;
+    }
+    return 0;
+}
+
+uint32_t behaviour_mask_of(const std::string &type)
+{
+    if (strcasecmp(type.c_str(), "Passive") == 0) return 1u << SAPIENT_BEHAVIOUR_PASSIVE;
+    if (strcasecmp(type.c_str(), "Active") == 0) return 1u << SAPIENT_BEHAVIOUR_ACTIVE;
+    return 0;
+}
+
+// 只支持按置信度比较；其它参数名视为不限
+void compile_parameter(const Task::Parameter &param, SapientTaskFilter::ClassRule &rule)
+{
+    rule.op = OPERATOR_ALL;
+    rule.value = 0.0f;
+    if (strcasecmp(param.name().c_str(), "confidence") != 0) {
+        if (param.has_name()) LOGI("class filter parameter '%s' ignored\n", param.name().c_str());
+        return;
+    }
+    rule.op = param.operator_();
+    rule.value = param.value();
+}
+
+bool compare(int op, float actual, float value)
+{
+    switch (op) {
+        case OPERATOR_GREATER_THAN: return actual > value;
+        case OPERATOR_LESS_THAN: return actual < value;
+        case OPERATOR_EQUAL: return fabsf(actual - value) < 1e-3f;
+        default: return true;
+    }
+}
+
+// 把 [-180, 180) 之外的方位差折回
+inline double angle_diff(double a, double b)
+{
+    double d = fmod(a - b, 360.0);
+    if (d < -180.0) d += 360.0;
+    else if (d >= 180.0) d -= 360.0;
+    return d;
+}
+
+bool compile_area(const Task::Region &src, SapientTaskFilter::Region &dst, std::string &error)
+{
+    const LocationOrRangeBearing &area = src.region_area();
+    if (area.fov_oneof_case() == LocationOrRangeBearing::kLocationList) {
+        const LocationList &list = area.location_list();
+        if (list.locations_size() < 3) {
+            error = "region " + src.region_id() + ": polygon needs at least 3 locations";
+            return false;
+        }
+        double twice_area = 0.0;
+        dst.is_sector = false;
+        dst.polygon.reserve(list.locations_size());
+        for (int i = 0; i < list.locations_size(); i++) {
+            const Location &loc = list.locations(i);
+            double scale = 1.0;
+            if (loc.coordinate_system() == LOCATION_COORDINATE_SYSTEM_LAT_LNG_RAD_M) {
+                scale = 180.0 / M_PI;
+            } else if (loc.coordinate_system() != LOCATION_COORDINATE_SYSTEM_LAT_LNG_DEG_M &&
+                       loc.coordinate_system() != LOCATION_COORDINATE_SYSTEM_UNSPECIFIED) {
+                error = "region " + src.region_id() + ": only lat/lng coordinates are supported";
+                return false;
+            }
+            SapientTaskFilter::Point p = { loc.x() * scale, loc.y() * scale };
+            if (i == 0) {
+                dst.min_lon = dst.max_lon = p.lon;
+                dst.min_lat = dst.max_lat = p.lat;
+            } else {
+                dst.min_lon = std::min(dst.min_lon, p.lon);
+                dst.max_lon = std::max(dst.max_lon, p.lon);
+                dst.min_lat = std::min(dst.min_lat, p.lat);
+                dst.max_lat = std::max(dst.max_lat, p.lat);
+            }
+            dst.polygon.push_back(p);
+            // 鞋带公式（相对首个顶点，避免大坐标相减的精度损失）
+            if (i >= 2) {
+                const SapientTaskFilter::Point &o = dst.polygon[0];
+                const SapientTaskFilter::Point &a = dst.polygon[i - 1];
+                twice_area += (a.lon - o.lon) * (p.lat - o.lat) - (p.lon - o.lon) * (a.lat - o.lat);
+            }
+        }
+        // 顶点重合或共线的多边形不包含任何点
+        if (fabs(twice_area) / 2.0 < kMinPolygonArea) {
+            error = "region " + src.region_id() + ": area has no extent";
+            return false;
+        }
+        return true;
+    }
+    if (area.fov_oneof_case() == LocationOrRangeBearing::kRangeBearing) {
+        const RangeBearingCone &cone = area.range_bearing();
+        double angle_scale = 1.0;
+        double range_scale = 1.0;
+        switch (cone.coordinate_system()) {
+            case RANGE_BEARING_COORDINATE_SYSTEM_DEGREES_M: break;
+            case RANGE_BEARING_COORDINATE_SYSTEM_RADIANS_M: angle_scale = 180.0 / M_PI; break;
+            case RANGE_BEARING_COORDINATE_SYSTEM_DEGREES_KM: range_scale = 1000.0; break;
+            case RANGE_BEARING_COORDINATE_SYSTEM_RADIANS_KM: angle_scale = 180.0 / M_PI; range_scale = 1000.0; break;
+            default:
+                error = "region " + src.region_id() + ": unsupported range/bearing units";
+                return false;
+        }
+        // 扇区判定按真北方位比较；磁北、网格北与平台航向基准无法换算
+        if (cone.datum() != RANGE_BEARING_DATUM_TRUE) {
+            error = "region " + src.region_id() + ": only true-north range/bearing datum is supported";
+            return false;
+        }
+        dst.is_sector = true;
+        dst.azimuth = cone.azimuth() * angle_scale;
+        // 未给出水平范围时视为全向
+        dst.half_width = cone.has_horizontal_extent() ? cone.horizontal_extent() * angle_scale / 2.0 : 180.0;
+        dst.max_range = cone.has_range() ? (cone.range() + cone.range_error()) * range_scale : HUGE_VAL;
+        return true;
+    }
+    error = "region " + src.region_id() + ": region_area is empty";
+    return false;
+}
+
+void compile_filters(const Task::Region &src, SapientTaskFilter::Region &dst)
+{
+    for (int i = 0; i < src.class_filter_size(); i++) {
+        const Task::ClassFilter &cf = src.class_filter(i);
+        uint32_t mask = class_mask_of(cf.type());
+        if (mask == 0) {
+            LOGI("region %s: unknown class '%s' ignored\n", src.region_id().c_str(), cf.type().c_str());
+            continue;
+        }
+        if (cf.sub_class_filter_size() == 0) {
+            SapientTaskFilter::ClassRule rule;
+            rule.class_mask = mask;
+            compile_parameter(cf.parameter(), rule);
+            dst.class_rules.push_back(rule);
+            continue;
+        }
+        // 子分类进一步收窄分类位集；无法识别的子分类按父分类处理
+        for (int k = 0; k < cf.sub_class_filter_size(); k++) {
+            const Task::SubClassFilter &sf = cf.sub_class_filter(k);
+            uint32_t sub_mask = class_mask_of(sf.type()) & mask;
+            SapientTaskFilter::ClassRule rule;
+            rule.class_mask = sub_mask ? sub_mask : mask;
+            compile_parameter(sf.has_parameter() ? sf.parameter() : cf.parameter(), rule);
+            dst.class_rules.push_back(rule);
+        }
+    }
+    for (int i = 0; i < src.behaviour_filter_size(); i++) {
+        uint32_t mask = behaviour_mask_of(src.behaviour_filter(i).type());
+        if (mask == 0) {
+            LOGI("region %s: unsupported behaviour '%s' ignored\n", src.region_id().c_str(),
+                 src.behaviour_filter(i).type().c_str());
+        }
+        dst.behaviour_mask |= mask;
+    }
+}
+
+} // namespace
+
+SapientTrackBehaviour sapient_track_behaviour(const RadarTrackItem &item)
+{
+    switch (item.motionType) {
+        case 1:  // 静止
+            return SAPIENT_BEHAVIOUR_PASSIVE;
+        case 2:  // 悬停
+        case 3:  // 靠近
+        case 4:  // 远离
+            return SAPIENT_BEHAVIOUR_ACTIVE;
+        default: {
+            // 兜底：优先用 absVel，其次用径向速度/ENU 速度分量判断是否"有运动"
+            const float ACTIVE_SPEED_THRESHOLD = 0.5f;
+            const float enu_speed_hint = fabsf(item.vx) + fabsf(item.vy) + fabsf(item.vz);
+            if (fabsf(item.absVel) > ACTIVE_SPEED_THRESHOLD ||
+                fabsf(item.velocity) > ACTIVE_SPEED_THRESHOLD ||
+                enu_speed_hint > ACTIVE_SPEED_THRESHOLD) {
+                return SAPIENT_BEHAVIOUR_ACTIVE;
+            }
+            return SAPIENT_BEHAVIOUR_PASSIVE;
+        }
+    }
+}
+
+std::shared_ptr<const SapientTaskFilter> SapientTaskFilter::compile(const Task &task, std::string &error)
+{
+    std::shared_ptr<SapientTaskFilter> filter(new SapientTaskFilter());
+    filter->task_id_ = task.task_id();
+    filter->regions_.reserve(task.region_size());
+
+    for (int i = 0; i < task.region_size(); i++) {
+        const Task::Region &src = task.region(i);
+        if (src.type() != Task::REGION_TYPE_AREA_OF_INTEREST && src.type() != Task::REGION_TYPE_IGNORE &&
+            src.type() != Task::REGION_TYPE_BOUNDARY) {
+            continue;   // 移动节点的可去/禁入区域与检测上报无关
+        }
+        Region region;
+        region.type = src.type();
+        region.region_id = src.region_id();
+        region.is_sector = false;
+        region.min_lon = region.min_lat = region.max_lon = region.max_lat = 0.0;
+        region.azimuth = region.half_width = region.max_range = 0.0;
+        region.behaviour_mask = 0;
+        if (!compile_area(src, region, error)) {
+            return std::shared_ptr<const SapientTaskFilter>();
+        }
+        compile_filters(src, region);
+
+        size_t index = filter->regions_.size();
+        switch (src.type()) {
+            case Task::REGION_TYPE_IGNORE: filter->ignore_.add(region, index); break;
+            case Task::REGION_TYPE_AREA_OF_INTEREST: filter->interest_.add(region, index); break;
+            default: filter->boundary_.add(region, index); break;
+        }
+        filter->regions_.push_back(std::move(region));
+    }
+    filter->build_index(filter->ignore_);
+    filter->build_index(filter->interest_);
+    filter->build_index(filter->boundary_);
+    return filter;
+}
+
+void SapientTaskFilter::build_index(RegionGroup &group)
+{
+    std::vector<SapientRegionIndex::Box> boxes(group.polygons.size());
+    for (size_t i = 0; i < group.polygons.size(); i++) {
+        const Region &region = regions_[group.polygons[i]];
+        boxes[i] = SapientRegionIndex::Box{ region.min_lon, region.min_lat, region.max_lon, region.max_lat };
+    }
+    group.index.build(boxes);
+}
+
+// 射线法：从点向东的射线与多边形各边的交点数为奇数时在内部（包围盒已由 R 树排除）
+bool SapientTaskFilter::polygon_contains(const Region &region, const Point &pos)
+{
+    bool inside = false;
+    const std::vector<Point> &poly = region.polygon;
+    for (size_t i = 0, j = poly.size() - 1; i < poly.size(); j = i++) {
+        if ((poly[i].lat > pos.lat) != (poly[j].lat > pos.lat)) {
+            double x = poly[j].lon + (pos.lat - poly[j].lat) * (poly[i].lon - poly[j].lon) /
+                                     (poly[i].lat - poly[j].lat);
+            if (pos.lon < x) inside = !inside;
+        }
+    }
+    return inside;
+}
+
+// 分类条件之间为"或"，分类与行为之间为"与"；未设置的筛选器不限制
+bool SapientTaskFilter::filters_match(const Region &region, const RadarTrackItem &item)
+{
+    if (region.behaviour_mask && !(region.behaviour_mask & (1u << sapient_track_behaviour(item)))) {
+        return false;
+    }
+    if (region.class_rules.empty()) return true;
+    uint32_t bit = class_bit(item.classification);
+    float confidence = std::min(item.classifyProb / 100.0f, 1.0f);
+    for (size_t i = 0; i < region.class_rules.size(); i++) {
+        const ClassRule &rule = region.class_rules[i];
+        if ((rule.class_mask & bit) && compare(rule.op, confidence, rule.value)) return true;
+    }
+    return false;
+}
+
+bool SapientTaskFilter::sector_contains(const Region &region, const RadarTrackItem &item, double bearing)
+{
+    return item.range > 0.0f && item.range <= region.max_range &&
+           fabs(angle_diff(bearing, region.azimuth)) <= region.half_width;
+}
+
+bool SapientTaskFilter::group_matches(const RegionGroup &group, const RadarTrackItem &item, bool has_pos,
+                                      const Point &pos, double bearing, bool check_filters) const
+{
+    for (size_t i = 0; i < group.sectors.size(); i++) {
+        const Region &region = regions_[group.sectors[i]];
+        if (sector_contains(region, item, bearing) && (!check_filters || filters_match(region, item))) {
+            return true;
+        }
+    }
+    if (!has_pos) return false;
+    return group.index.visit(pos.lon, pos.lat, [&](size_t id) {
+        const Region &region = regions_[group.polygons[id]];
+        return polygon_contains(region, pos) && (!check_filters || filters_match(region, item));
+    });
+}
+
+bool SapientTaskFilter::accept(const RadarTrackItem &item, const SapientTrackBatch &batch, size_t index) const
+{
+    double bearing = batch.bearing(index);
+    Point pos = { 0.0, 0.0 };
+    bool has_pos = batch.position(index, &pos.lon, &pos.lat, NULL);
+
+    if (!ignore_.empty() && group_matches(ignore_, item, has_pos, pos, bearing, true)) {
+        return false;
+    }
+    // 边界区只限定范围，不应用筛选器
+    if (!boundary_.empty() && !group_matches(boundary_, item, has_pos, pos, bearing, false)) {
+        return false;
+    }
+    return interest_.empty() || group_matches(interest_, item, has_pos, pos, bearing, true);
+}
+
+SapientTaskFilterEngine &SapientTaskFilterEngine::instance()
+{
+    static SapientTaskFilterEngine *engine = new SapientTaskFilterEngine();
+    return *engine;
+}
+
+int SapientTaskFilterEngine::apply_task(const Task &task, std::string &reason)
+{
+    std::shared_ptr<const SapientTaskFilter> cur = snapshot();
+    if (task.control() == Task::CONTROL_STOP || task.control() == Task::CONTROL_PAUSE) {
+        if (cur && cur->task_id() == task.task_id()) {
+            clear();
+            reason = "region filter removed";
+        }
+        return 0;
+    }
+    if (task.region_size() == 0) return release_for_task(task, cur, reason);
+
+    std::string error;
+    std::shared_ptr<const SapientTaskFilter> filter = SapientTaskFilter::compile(task, error);
+    if (!filter) {
+        LOGE("task %s: region filter rejected: %s\n", task.task_id().c_str(), error.c_str());
+        reason = error;
+        return -1;
+    }
+    // 只有移动节点区域等与检测无关的类型：与不带区域的 Task 同样处理
+    if (filter->region_count() == 0) return release_for_task(task, cur, reason);
+    std::atomic_store(&current_, filter);
+    LOGI("task %s: %zu regions installed\n", task.task_id().c_str(), filter->region_count());
+    reason = std::to_string(filter->region_count()) + " regions applied";
+    return 0;
+}
+
+// 不带检测区域的 Task：同一任务（重发或更新）保持当前筛选；另一个任务 START 时清除上一任务的筛选，
+// 否则新任务之后的 STOP/PAUSE 无法清除这份不属于它的筛选
+int SapientTaskFilterEngine::release_for_task(const Task &task, const std::shared_ptr<const SapientTaskFilter> &cur,
+                                              std::string &reason)
+{
+    if (!cur || cur->task_id() == task.task_id() || task.control() != Task::CONTROL_START) {
+        LOGI("task %s: no detection regions, region filter unchanged\n", task.task_id().c_str());
+        return 0;
+    }
+    LOGI("task %s: no detection regions, region filter of task %s removed\n",
+         task.task_id().c_str(), cur->task_id().c_str());
+    clear();
+    reason = "region filter removed";
+    return 0;
+}
+
+void SapientTaskFilterEngine::clear()
+{
+    std::atomic_store(&current_, std::shared_ptr<const SapientTaskFilter>());
+    LOGI("region filter cleared\n");
+}
+
+void SapientTaskFilterEngine::get_stats(size_t *regions, uint64_t *passed, uint64_t *blocked) const
+{
+    std::shared_ptr<const SapientTaskFilter> cur = snapshot();
+    if (regions) *regions = cur ? cur->region_count() : 0;
+    if (passed) *passed = passed_.load(std::memory_order_relaxed);
+    if (blocked) *blocked = blocked_.load(std::memory_order_relaxed);
+}
+
+extern "C" {
+
+void sapient_task_filter_clear(void)
+{
+    SapientTaskFilterEngine::instance().clear();
+}
+
+void sapient_task_filter_get_stats(size_t *regions, unsigned long long *passed, unsigned long long *blocked)
+{
+    uint64_t p = 0, b = 0;
+    SapientTaskFilterEngine::instance().get_stats(regions, &p, &b);
+    if (passed) *passed = (unsigned long long)p;
+    if (blocked) *blocked = (unsigned long long)b;
+}
+
+} // extern "C"
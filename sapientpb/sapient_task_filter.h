@@ -0,0 +1,183 @@
+/*****************************************************************************
+ * Copyright (c) 2023-2025
+ * Skyfend Technology Co., Ltd
+ *
+ * All rights reserved. Any unauthorized disclosure or publication of the
+ * confidential and proprietary information to any other party will constitute
+ * an infringement of copyright laws.
+ *
+ * @file    sapient_task_filter.h
+ * @brief   Task 区域与筛选器引擎
+ * @details 收到带 region 的 Task 时，把区域与筛选器编译为内存中的判定结构：
+ *          多边形区域（经纬度）带包围盒预筛选与射线法点在多边形判定，扇区区域（相对本节点的
+ *          距离/方位）按方位差与距离判定；分类筛选器编译为雷达分类位集 + 置信度条件，
+ *          行为筛选器编译为行为位集。编译在接收线程中完成，完成后以指针交换整体替换，
+ *          检测报告构建时每帧取一次快照，在任何 protobuf 构建之前逐航迹判定。
+ *          判定规则：落在忽略区（且满足该区域筛选器）的航迹不上报；存在关注区时只上报
+ *          落在某个关注区内且满足其筛选器的航迹；存在边界区时不上报边界之外的航迹。
+ *          多边形区域按类型分组建立打包 R 树（sapient_region_index.h），逐航迹只判定包围盒
+ *          包含该点的区域；扇区区域数量少且与本节点位置相关，逐个判定。
+ *****************************************************************************
+ */
+#ifndef __SAPIENT_TASK_FILTER_H_
+#define __SAPIENT_TASK_FILTER_H_
+
+#include <stddef.h>
+#include "../../common/nanopb/radar.pb.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 清除当前生效的区域筛选（之后上报全部航迹） */
+void sapient_task_filter_clear(void);
+
+/* 获取筛选统计：当前区域数、累计通过与拦截的航迹数（任一指针可为 NULL） */
+void sapient_task_filter_get_stats(size_t *regions, unsigned long long *passed, unsigned long long *blocked);
+
+#ifdef __cplusplus
+}
+
+#include <stdint.h>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include "sapient_region_index.h"
+#include "sapient_track_kernel.h"
+
+namespace sapient_msg { namespace bsi_flex_335_v2_0 { class Task; } }
+
+// 航迹行为（与 DetectionReport.behaviour 的取值一致）
+enum SapientTrackBehaviour {
+    SAPIENT_BEHAVIOUR_PASSIVE = 0,
+    SAPIENT_BEHAVIOUR_ACTIVE = 1,
+};
+
+/**
+ * @brief 按运动类型判断航迹行为；运动类型未知时按速度兜底（> 0.5m/s 视为 Active）
+ */
+SapientTrackBehaviour sapient_track_behaviour(const RadarTrackItem &item);
+
+// 编译后的区域集合（不可变，多个线程可同时读取）
+class SapientTaskFilter {
+public:
+    struct Point {
+        double lon;
+        double lat;
+    };
+
+    // 分类条件：航迹分类在位集中，且置信度满足比较条件
+    struct ClassRule {
+        uint32_t class_mask;      // 位 i 对应雷达分类 i（0~5），位 6 为其它
+        int op;                   // Operator（registration.proto）
+        float value;              // 置信度阈值（0~1）
+    };
+
+    struct Region {
+        int type;                 // Task::RegionType
+        std::string region_id;
+        bool is_sector;
+        // 多边形（经纬度，度）及其包围盒
+        std::vector<Point> polygon;
+        double min_lon, min_lat, max_lon, max_lat;
+        // 扇区（相对本节点，方位为真北方位，度；距离，米）
+        double azimuth, half_width, max_range;
+        std::vector<ClassRule> class_rules;   // 为空表示不按分类筛选
+        uint32_t behaviour_mask;              // 为 0 表示不按行为筛选
+    };
+
+    /**
+     * @brief 编译 Task 中的区域
+     * @param task        Task 消息
+     * @param[out] error  编译失败的原因
+     * @return 编译结果；失败（不支持的坐标系、顶点不足等）返回空指针
+     */
+    static std::shared_ptr<const SapientTaskFilter> compile(const sapient_msg::bsi_flex_335_v2_0::Task &task,
+                                                            std::string &error);
+
+    /**
+     * @brief 判定航迹是否应上报
+     * @param item  航迹
+     * @param batch 本帧批量坐标转换结果（真北方位；航迹无经纬度时由雷达位置推算的位置）
+     * @param index 航迹在 batch 中的下标
+     * @return true 上报；false 被区域或筛选器排除
+     */
+    bool accept(const RadarTrackItem &item, const SapientTrackBatch &batch, size_t index) const;
+
+    const std::string &task_id() const { return task_id_; }
+    size_t region_count() const { return regions_.size(); }
+
+private:
+    // 同一类型的区域：多边形经 R 树索引，扇区逐个判定
+    struct RegionGroup {
+        std::vector<size_t> sectors;      // regions_ 下标
+        std::vector<size_t> polygons;     // regions_ 下标，按 R 树中的 ID 排列
+        SapientRegionIndex index;
+
+        bool empty() const { return sectors.empty() && polygons.empty(); }
+        void add(const Region &region, size_t i) {
+            (region.is_sector ? sectors : polygons).push_back(i);
+        }
+    };
+
+    SapientTaskFilter() {}
+
+    void build_index(RegionGroup &group);
+    // 组内是否存在包含该航迹（check_filters 时还须满足区域筛选器）的区域
+    bool group_matches(const RegionGroup &group, const RadarTrackItem &item, bool has_pos,
+                       const Point &pos, double bearing, bool check_filters) const;
+    static bool sector_contains(const Region &region, const RadarTrackItem &item, double bearing);
+    static bool polygon_contains(const Region &region, const Point &pos);
+    static bool filters_match(const Region &region, const RadarTrackItem &item);
+
+    std::string task_id_;
+    std::vector<Region> regions_;
+    RegionGroup ignore_;
+    RegionGroup interest_;
+    RegionGroup boundary_;
+};
+
+// 当前生效的区域筛选（以指针交换整体替换）
+class SapientTaskFilterEngine {
+public:
+    static SapientTaskFilterEngine &instance();
+
+    /**
+     * @brief 按 Task 更新筛选：带检测相关区域时编译并替换；STOP/PAUSE 当前筛选所属任务时清除。
+     *        不带检测区域时：同一任务保持当前筛选，其它任务 START 时清除（新任务取代旧任务）
+     * @param task        Task 消息
+     * @param[out] reason 附加到 TaskAck 的说明
+     * @return 0 成功（或与区域无关）；-1 区域无法编译，应拒绝该任务（原筛选保持不变）
+     */
+    int apply_task(const sapient_msg::bsi_flex_335_v2_0::Task &task, std::string &reason);
+
+    void clear();
+
+    // 当前筛选快照（无筛选时为空指针），每帧取一次
+    std::shared_ptr<const SapientTaskFilter> snapshot() const {
+        return std::atomic_load(&current_);
+    }
+
+    void record(uint64_t passed, uint64_t blocked) {
+        if (passed) passed_.fetch_add(passed, std::memory_order_relaxed);
+        if (blocked) blocked_.fetch_add(blocked, std::memory_order_relaxed);
+    }
+
+    void get_stats(size_t *regions, uint64_t *passed, uint64_t *blocked) const;
+
+private:
+    SapientTaskFilterEngine() : passed_(0), blocked_(0) {}
+
+    // Task 不带检测区域时按任务 ID 决定保持还是清除当前筛选
+    int release_for_task(const sapient_msg::bsi_flex_335_v2_0::Task &task,
+                         const std::shared_ptr<const SapientTaskFilter> &cur, std::string &reason);
+
+    std::shared_ptr<const SapientTaskFilter> current_;
+    std::atomic<uint64_t> passed_;
+    std::atomic<uint64_t> blocked_;
+};
+
+#endif
+
+#endif /* __SAPIENT_TASK_FILTER_H_ */
@@ -2,26 +2,39 @@
 #include "../../common/nanopb/radar.pb.h"
 #include "../sapient/sapient_message.pb.h"
 #include "../sapient/task.pb.h"
+#include "../sapient/registration_ack.pb.h"
 #include "sky_task_handler.h"
+#include "sapient_send_queue.h"
+#include "sapient_frame.h"
+#include "sapient_frame_decoder.h"
+#include "sapient_reactor.h"
+#include "sapient_outbox.h"
+#include "sapient_clock.h"
+#include "sapient_rate_limiter.h"
+#include "sapient_track_registry.h"
+#include "adapter/radar_state_adapter.h"
 #include <string>
 #include <iostream>
 #include <cstring>
 #include <algorithm>
-#include <thread>
 #include <atomic>
+#include <mutex>
+#include <condition_variable>
 #include <vector>
+#include <deque>
 #include <chrono>
 
 // socket 相关头文件
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <netinet/in.h>
 #include <netinet/tcp.h>
 #include <arpa/inet.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <errno.h>
-#include <sys/select.h>
+#include <sys/epoll.h>
 
 // 日志模块
 #define LOG_TAG "sapient_tcp"
@@ -33,8 +46,8 @@ extern "C" {
 #define LOGI(format, ...) radar_log_info(format, ##__VA_ARGS__)
 #define LOGE(format, ...) radar_log_error(format, ##__VA_ARGS__)
 
-// 从 sky_registrationpb.cpp 中声明的构建函数
-int sapient_build_registration(std::string &out_serialized, std::string &out_json);
+// 从 sky_registrationpb.cpp 中声明的构建函数（缓存的注册报文 + 本次 timestamp，直接组帧）
+int sapient_build_registration_frame(SapientFramePtr &out);
 // 基于 RadarTrackItem 的 detection report 构建函数（C++ 接口）
 extern "C" int sapient_build_detection_report_from_track_item_cpp(std::string &out_serialized, std::string &out_json, const RadarTrackItem *track_item);
 // 从 sky_status_reportpb.cpp 中声明的构建函数
@@ -42,218 +55,284 @@ int sapient_build_status_report(std::string &out_serialized, std::string &out_js
 // 从 sky_alert_reportpb.cpp 中声明的构建函数
 int sapient_build_alert_report(std::string &out_serialized, std::string &out_json,
                                const char *description, int type, int status);
+// 帧缓冲版本的构建函数：直接序列化到池化帧（已带 4 字节长度前缀），发送热路径使用
+int sapient_build_detection_report_frame(SapientFramePtr &out_frame, std::string &out_json,
+                                         const RadarTrackItem *track_item);
+size_t sapient_build_detection_report_frames(std::vector<SapientFramePtr> &out_frames,
+                                             const RadarTrackItem *items, size_t count,
+                                             size_t max_reports);
+size_t sapient_build_lost_detection_frames(std::vector<SapientFramePtr> &out_frames);
+int sapient_build_status_report_frame(SapientFramePtr &out_frame, std::string &out_json, bool full);
+int sapient_build_alert_report_frame(SapientFramePtr &out_frame, std::string &out_json,
+                                     const char *description, int type, int status);
 
 // 简单的 C++ 封装类，提供连接、发送、接收、回调功能。
+// socket 为非阻塞模式，由共享的 epoll 反应器（sapient_reactor.h）统一负责连接完成、
+// 读、写、断线重连与 RegistrationAck 超时；其它线程只通过发送队列和 post() 与之交互。
 class SapientTcpClientImpl {
 public:
     SapientTcpClientImpl(const std::string &h, int p)
-        : host(h), port(p), sockfd(-1), on_msg(nullptr), user(nullptr), running(false), is_connected(false),
-          disconnect_time_valid_(false), registration_ack_received_(false), waiting_for_registration_ack_(false) {}
-
-    // 注意：send_mutex_ 保护所有 TCP 发送操作（send_pb / send_all），
-    // 确保 4 字节长度前缀 + 消息体作为原子操作写入 socket。
-    // 否则多线程（状态报告线程 + 跟踪数据线程）并发发送时，
-    // 字节流会交错，导致 SDA 帧解析器失步，所有后续消息不可解析。
+        : host(h), port(p), sockfd(-1), on_msg(nullptr), user(nullptr),
+          reactor_(SapientReactor::instance()), state_(kStateDisconnected),
+          running(false), is_connected(false), force_registration_(false), flush_pending_(false),
+          auto_registration_(false), want_write_(false), tx_offset_(0),
+          connect_timer_(0), reconnect_timer_(0), ack_timer_(0), reconnect_attempt_(0),
+          connect_result_(kConnectIdle), sync_rx_waiters_(0), sync_rx_seq_(0),
+          disconnect_time_valid_(false), registration_ack_received_(false), waiting_for_registration_ack_(false),
+          outbox_enabled_(false), outbox_policy_(0), outbox_rate_(kDefaultOutboxReplayRate),
+          outbox_max_detection_age_ms_(kDefaultOutboxDetectionMaxAgeMs), replay_timer_(0),
+          outbox_replayed_(0), outbox_expired_(0), shaper_timer_(0), rate_auto_(true),
+          rate_bytes_(0), rate_msgs_(0), rate_class_(-1), rate_checked_ms_(0), thinned_(0),
+          avg_detection_bytes_(kDefaultDetectionFrameBytes) {}
+
+    // 注意：所有 socket 读写只在反应器线程中进行。
+    // 生产者（状态定时器、跟踪数据线程、接收回调）只把完整的池化帧
+    // （4 字节长度前缀 + 消息体，连续存放）放入 send_queue_ 并唤醒反应器，
+    // 因此不同线程的字节流不会交错，也不会因为断线重连（每次 10 秒）而阻塞调用方。
 
     ~SapientTcpClientImpl() {
-        stop_receive_thread();
-        close_socket();
+        close_connection();
     }
 
-    // 尝试连接（带超时）
+    // 同步连接（带超时）：在反应器中发起非阻塞连接，调用线程等待结果
+    // 不能在反应器线程（接收回调、定时器回调）中调用
     int connect_with_timeout(int timeout_sec) {
-        const char *use_host = host.empty() ? getenv("SAPIENT_HOST") : host.c_str();
-        int use_port = (port <= 0) ? (getenv("SAPIENT_PORT") ? atoi(getenv("SAPIENT_PORT")) : 0) : port;
-        if (!use_host || use_port <= 0) {
-            LOGE("sapient client: invalid host/port\n");
+        if (reactor_.in_loop_thread()) {
+            LOGE("sapient client: synchronous connect is not allowed on the reactor thread\n");
             return -1;
         }
-
-        sockfd = socket(AF_INET, SOCK_STREAM, 0);
-        if (sockfd < 0) {
-            std::cerr << "socket() failed: " << strerror(errno) << std::endl;
+        if (reactor_.start() != 0) {
+            LOGE("sapient client: failed to start reactor\n");
             return -1;
         }
 
-        struct sockaddr_in srv;
-        memset(&srv, 0, sizeof(srv));
-        srv.sin_family = AF_INET;
-        srv.sin_port = htons(use_port);
-        if (inet_pton(AF_INET, use_host, &srv.sin_addr) <= 0) {
-            std::cerr << "inet_pton failed for host " << use_host << std::endl;
-            close(sockfd); sockfd = -1; return -1;
-        }
-
-        int flags = fcntl(sockfd, F_GETFL, 0);
-        if (flags >= 0) fcntl(sockfd, F_SETFL, flags | O_NONBLOCK);
-
-        int rc = connect(sockfd, (struct sockaddr*)&srv, sizeof(srv));
-        if (rc < 0 && errno != EINPROGRESS) {
-            std::cerr << "connect() failed: " << strerror(errno) << std::endl;
-            close(sockfd); sockfd = -1; return -1;
-        }
-
-        if (rc < 0) {
-            fd_set wfds;
-            FD_ZERO(&wfds);
-            FD_SET(sockfd, &wfds);
-            struct timeval tv;
-            tv.tv_sec = (timeout_sec > 0 ? timeout_sec : 5);
-            tv.tv_usec = 0;
-            rc = select(sockfd + 1, NULL, &wfds, NULL, &tv);
-            if (rc <= 0) {
-                std::cerr << "connect timeout or select error" << std::endl;
-                close(sockfd); sockfd = -1; return -1;
-            }
-            int so_error = 0; socklen_t len = sizeof(so_error);
-            getsockopt(sockfd, SOL_SOCKET, SO_ERROR, &so_error, &len);
-            if (so_error != 0) {
-                std::cerr << "socket error after select: " << strerror(so_error) << std::endl;
-                close(sockfd); sockfd = -1; return -1;
-            }
-        }
-
-        // 设置 TCP_NODELAY（禁用 Nagle 算法，降低延迟）
-        int nodelay = 1;
-        if (setsockopt(sockfd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay)) < 0) {
-            std::cerr << "setsockopt(TCP_NODELAY) failed: " << strerror(errno) << std::endl;
-        }
-        
-        // 设置 SO_KEEPALIVE（启用 TCP keepalive，快速检测断开）
-        int keepalive = 1;
-        if (setsockopt(sockfd, SOL_SOCKET, SO_KEEPALIVE, &keepalive, sizeof(keepalive)) < 0) {
-            std::cerr << "setsockopt(SO_KEEPALIVE) failed: " << strerror(errno) << std::endl;
+        int timeout_ms = (timeout_sec > 0 ? timeout_sec : 5) * 1000;
+        {
+            std::lock_guard<std::mutex> lock(connect_mutex_);
+            connect_result_ = kConnectPending;
         }
-        
-        // 设置 keepalive 参数：10秒开始探测，5秒间隔，3次失败即断开（总共约20秒）
-        int keepidle = 10;   // 10秒空闲后开始探测
-        int keepintvl = 5;   // 每5秒探测一次
-        int keepcnt = 3;     // 3次失败即认为断开
-        setsockopt(sockfd, IPPROTO_TCP, TCP_KEEPIDLE, &keepidle, sizeof(keepidle));
-        setsockopt(sockfd, IPPROTO_TCP, TCP_KEEPINTVL, &keepintvl, sizeof(keepintvl));
-        setsockopt(sockfd, IPPROTO_TCP, TCP_KEEPCNT, &keepcnt, sizeof(keepcnt));
-
-        // 恢复阻塞
-        if (flags >= 0) fcntl(sockfd, F_SETFL, flags);
-        
-        is_connected = true;  // 连接成功，标记为已连接
-        // 注意：不要在这里清除 disconnect_time_valid_。
-        // 断线时间戳用于“断网后 2 分钟规则”（registration / status 发送策略），
-        // 应由上层在满足条件并完成一次动作后主动清除。
-        return 0;
+        reactor_.post([this, timeout_ms]() { start_connect(timeout_ms, false); });
+
+        // 超时由反应器中的连接定时器负责，这里多等 1 秒兜底
+        std::unique_lock<std::mutex> lock(connect_mutex_);
+        connect_cv_.wait_for(lock, std::chrono::milliseconds(timeout_ms + 1000),
+                             [this]() { return connect_result_ != kConnectPending; });
+        int result = connect_result_;
+        connect_result_ = kConnectIdle;
+        return result == 0 ? 0 : -1;
     }
 
-    void close_socket() {
-        if (sockfd >= 0) { close(sockfd); sockfd = -1; }
-        is_connected = false;  // 标记连接已断开
+    // 关闭连接：取消所有定时器、关闭 socket，并停止自动重连
+    void close_connection() {
+        running = false;
+        send_queue_.close();
+        reactor_.run_sync([this]() {
+            cancel_timer(reconnect_timer_);
+            cancel_timer(ack_timer_);
+            cancel_timer(replay_timer_);
+            close_fd();
+            finish_connect_request(-1);
+        });
         // 记录断线时间戳（用于判断重连时是否需要发送 registration）
         // 如果已经有时间戳，不更新（保留更早的断线时间，更符合规范要求）
+        mark_disconnect_time();
+    }
+
+    // 记录断线时间（已有时间戳时保留更早的断线时间）
+    void mark_disconnect_time() {
+        std::lock_guard<std::mutex> lock(disconnect_mutex_);
         if (!disconnect_time_valid_) {
             disconnect_time_ = std::chrono::steady_clock::now();
             disconnect_time_valid_ = true;
         }
     }
 
-    // 内部发送函数，支持可选的锁参数（避免死锁）
-    int send_all_impl(const void *data, size_t len, bool already_locked = false) {
-        // 发送前检查连接状态（使用 flag 快速检查，避免频繁系统调用）
-        if (sockfd < 0 || !is_connected.load()) {
-            std::unique_lock<std::mutex> lock(reconnect_mutex, std::defer_lock);
-            if (!already_locked) {
-                lock.lock();
-            }
-            // 双重检查：可能在获取锁的过程中，其他线程已经重连成功
-            // 如果此时 is_connected 已为 true，说明其他线程已重连，直接跳过
-            if (sockfd < 0 || !is_connected.load()) {
-                // 如果 sockfd >= 0 但 is_connected 为 false，可能是误判，再确认一次
-                if (sockfd >= 0 && is_socket_alive()) {
-                    is_connected = true;  // 连接实际正常，更新 flag
-                } else {
-                    // 确实断开，尝试重连
-                    LOGI("Socket disconnected, attempting reconnect before send\n");
-                    if (reconnect_with_backoff() != 0) {
-                        return -1;  // 重连失败
-                    }
-                    // 重连成功，已在 reconnect_with_backoff() 中发送注册报文
-                }
-            }
-        }
-        
-        const uint8_t *p = (const uint8_t*)data;
-        size_t remaining = len;
-        while (remaining > 0) {
-            ssize_t n = send(sockfd, p, remaining, 0);
-            if (n <= 0) {
-                // 发送失败，可能是连接断开
-                if (errno == EPIPE || errno == ECONNRESET || errno == ENOTCONN) {
-                    is_connected = false;  // 标记连接已断开
-                    // 记录断线时间
-                    if (!disconnect_time_valid_) {
-                        disconnect_time_ = std::chrono::steady_clock::now();
-                        disconnect_time_valid_ = true;
-                    }
-                    LOGI("Send failed due to connection error, attempting reconnect\n");
-                    std::unique_lock<std::mutex> lock(reconnect_mutex, std::defer_lock);
-                    if (!already_locked) {
-                        lock.lock();
-                    }
-                    if (reconnect_with_backoff() == 0) {
-                        // 重连成功，是否发送注册报文由 reconnect_with_backoff() 根据断线时间决定
-                        // 继续发送剩余数据（极小概率部分发送场景，实际中几乎不会发生）
-                        continue;
-                    }
-                }
-                LOGE("send() failed: %s\n", strerror(errno));
-                return -1;
-            }
-            remaining -= (size_t)n; p += n;
-        }
-        return 0;
+    // 组帧：从帧缓冲池申请缓冲，拷贝消息体并写入 4 字节 little-endian 长度前缀
+    static SapientFramePtr build_frame(const void *data, size_t len) {
+        SapientFramePtr frame = SapientFramePool::instance().acquire(len);
+        if (len > 0) memcpy(frame->body(), data, len);
+        frame->commit(len);
+        return frame;
     }
 
-    // 公开接口：发送数据（自动处理重连）
+    // 公开接口：发送原始字节（入队，由反应器发送并处理重连）
     int send_all(const void *data, size_t len) {
-        return send_all_impl(data, len, false);
-    }
-
-    // 内部发送protobuf函数，支持可选的锁参数（避免死锁）
-    // 关键修复：使用 send_mutex_ 保护整个 send_pb 操作（4字节长度前缀 + 消息体）
-    // 防止多线程（状态报告线程 + 跟踪数据线程）并发发送导致字节流交错
-    int send_pb_impl(const void *data, size_t len, bool already_locked = false) {
-        std::lock_guard<std::mutex> send_lock(send_mutex_);  // 原子化保护
-        // 4 bytes little-endian prefix
-        uint32_t body_len = (uint32_t)len;
-        uint8_t len_buf[4];
-        len_buf[0] = (uint8_t)(body_len & 0xFF);
-        len_buf[1] = (uint8_t)((body_len >> 8) & 0xFF);
-        len_buf[2] = (uint8_t)((body_len >> 16) & 0xFF);
-        len_buf[3] = (uint8_t)((body_len >> 24) & 0xFF);
-        if (send_all_impl(len_buf, sizeof(len_buf), already_locked) != 0) return -1;
-        return send_all_impl(data, len, already_locked);
-    }
-
-    // 公开接口：发送protobuf数据
+        if (!data || len == 0) return -1;
+        SapientFramePtr frame = SapientFramePool::instance().acquire(len);
+        memcpy(frame->body(), data, len);
+        frame->commit_raw(len);
+        return enqueue_frame(std::move(frame));
+    }
+
+    // 公开接口：发送 protobuf 数据（组帧后入队，O(1) 返回）
+    // 返回 0 表示已入队；-1 表示按溢出策略被丢弃
     int send_pb(const void *data, size_t len) {
-        return send_pb_impl(data, len, false);
+        return enqueue_frame(build_frame(data, len));
     }
 
-    int send_register() {
-        std::string bin, json;
-        if (sapient_build_registration(bin, json) != 0) {
-            std::cerr << "sapient_build_registration failed" << std::endl;
+    // 入队已组好的帧（零拷贝路径：构建函数直接序列化到帧缓冲）；lane 为出站优先级通道
+    int enqueue_frame(SapientFramePtr &&frame, int lane = SAPIENT_LANE_CONTROL) {
+        if (!frame) return -1;
+        frame->lane = lane;
+        if (store_offline(frame)) return 0;
+        // 反应器线程是队列的唯一消费者，自身入队时不能按 BLOCK 策略等待
+        if (send_queue_.push(std::move(frame), !reactor_.in_loop_thread()) != 0) {
+            LOGE("sapient send queue full or closed, frame dropped (dropped=%llu)\n",
+                 (unsigned long long)send_queue_.dropped_count());
             return -1;
         }
-        
-        // 记录 Registration 发送时间，启动 30 秒超时检测
+        schedule_flush();
+        return 0;
+    }
+
+    // 批量入队（一次加锁、一次 flush 投递）；返回 0 表示全部入队，-1 表示有帧被丢弃
+    int enqueue_frames(std::vector<SapientFramePtr> &frames, int lane) {
+        if (frames.empty()) return 0;
+        for (size_t i = 0; i < frames.size(); i++) {
+            if (!frames[i]) continue;
+            frames[i]->lane = lane;
+            if (store_offline(frames[i])) frames[i].reset();   // 已写入发件箱，帧归还到池中
+        }
+        size_t total = 0;
+        for (size_t i = 0; i < frames.size(); i++) {
+            if (frames[i]) total++;
+        }
+        if (total == 0) {
+            frames.clear();
+            return 0;
+        }
+        size_t accepted = send_queue_.push_batch(frames, !reactor_.in_loop_thread());
+        if (accepted > 0) schedule_flush();
+        if (accepted < total) {
+            LOGE("sapient send queue full or closed, %zu of %zu frames dropped (dropped=%llu)\n",
+                 total - accepted, total, (unsigned long long)send_queue_.dropped_count());
+            return -1;
+        }
+        return 0;
+    }
+
+    void configure_send_queue(size_t capacity, int policy, int block_timeout_ms) {
+        send_queue_.configure(capacity, policy, block_timeout_ms);
+        // 帧池按在途帧数扩容：队列容量 + 重放积压 + 正在发送的帧
+        if (capacity > 0) {
+            SapientFramePool::instance().reserve(capacity + kOutboxReplayMaxQueued + kMaxTxIov);
+        }
+        LOGI("sapient send queue configured: capacity=%zu, policy=%d, block_timeout=%dms\n",
+             capacity, policy, block_timeout_ms);
+    }
+
+    void get_send_queue_stats(size_t *queued, unsigned long long *dropped) {
+        if (queued) *queued = send_queue_.size();
+        if (dropped) *dropped = (unsigned long long)send_queue_.dropped_count();
+    }
+
+    unsigned long long get_conflated_count() {
+        return (unsigned long long)send_queue_.conflated_count();
+    }
+
+    void set_lane_weight(int lane, unsigned int max_wait) {
+        send_queue_.set_lane_weight(lane, max_wait);
+        LOGI("sapient send lane %d anti-starvation weight set to %u\n", lane, max_wait);
+    }
+
+    void get_lane_stats(int lane, size_t *queued, unsigned long long *sent) {
+        uint64_t n = 0;
+        send_queue_.lane_stats(lane, queued, &n);
+        if (sent) *sent = (unsigned long long)n;
+    }
+
+    // 启用断线发件箱（任意线程）；文件中上次未重放的帧在下次注册完成后重放
+    int enable_outbox(const char *path, size_t slot_size, size_t slot_count, int policy) {
+        if (outbox_.open(path, slot_size, slot_count) != 0) return -1;
+        outbox_policy_ = policy;
+        outbox_enabled_ = true;
+        LOGI("sapient outbox enabled: %s, policy=%d, %zu frames pending\n", path, policy, outbox_.size());
+        return 0;
+    }
+
+    void disable_outbox() {
+        outbox_enabled_ = false;
+        run_in_loop_sync([this]() { cancel_timer(replay_timer_); });
+        outbox_.close();
+    }
+
+    void configure_outbox_replay(unsigned int frames_per_sec, unsigned int detection_max_age_ms) {
+        if (frames_per_sec > 0) outbox_rate_ = frames_per_sec;
+        outbox_max_detection_age_ms_ = detection_max_age_ms;
+        LOGI("sapient outbox replay: %u frames/s, detection max age %ums\n",
+             outbox_rate_.load(), detection_max_age_ms);
+    }
+
+    void get_outbox_stats(size_t *pending, unsigned long long *replayed, unsigned long long *expired,
+                          unsigned long long *overwritten) {
+        if (pending) *pending = outbox_.size();
+        if (replayed) *replayed = (unsigned long long)outbox_replayed_.load();
+        if (expired) *expired = (unsigned long long)outbox_expired_.load();
+        if (overwritten) *overwritten = (unsigned long long)outbox_.overwritten_count();
+    }
+
+    // 手动设置整形速率（任意线程），关闭按 network_speed 自动设置
+    void set_rate_limit(unsigned int bytes_per_sec, unsigned int msgs_per_sec) {
+        rate_auto_ = false;
+        apply_rate_limit(bytes_per_sec, msgs_per_sec);
+    }
+
+    // 恢复自动设置：先解除限速，下一次发送时按最新的 RadarState 状态位重新计算
+    void set_rate_limit_auto() {
+        rate_auto_ = true;
+        rate_class_ = -1;
+        rate_checked_ms_ = 0;
+        apply_rate_limit(0, 0);
+    }
+
+    void get_rate_limit_stats(unsigned int *bytes_per_sec, unsigned int *msgs_per_sec,
+                              unsigned long long *thinned) {
+        if (bytes_per_sec) *bytes_per_sec = rate_bytes_.load();
+        if (msgs_per_sec) *msgs_per_sec = rate_msgs_.load();
+        if (thinned) *thinned = (unsigned long long)thinned_.load();
+    }
+
+    void configure_rx_limits(size_t initial_buffer, uint32_t max_frame_len, int oversize_policy) {
+        run_in_loop_sync([&]() { decoder_.configure(initial_buffer, max_frame_len, oversize_policy); });
+        LOGI("sapient rx limits configured: buffer=%zu, max_frame=%u, oversize_policy=%d\n",
+             initial_buffer, max_frame_len, oversize_policy);
+    }
+
+    void get_rx_stats(unsigned long long *frames, unsigned long long *oversized) {
+        run_in_loop_sync([&]() {
+            if (frames) *frames = (unsigned long long)decoder_.frame_count();
+            if (oversized) *oversized = (unsigned long long)decoder_.oversized_count();
+        });
+    }
+
+    // 记录 Registration 发送时间，启动 30 秒超时定时器
+    void arm_registration_ack_timer() {
         {
             std::lock_guard<std::mutex> lock(registration_mutex_);
             registration_sent_time_ = std::chrono::steady_clock::now();
             registration_ack_received_ = false;
             waiting_for_registration_ack_ = true;
         }
+        run_in_loop([this]() {
+            cancel_timer(ack_timer_);
+            ack_timer_ = reactor_.add_timer(kRegistrationAckTimeoutMs, 0, [this]() {
+                ack_timer_ = 0;
+                on_registration_ack_timeout();
+            });
+        });
+    }
+
+    int send_register() {
+        SapientFramePtr frame;
+        if (sapient_build_registration_frame(frame) != 0) {
+            std::cerr << "sapient_build_registration failed" << std::endl;
+            return -1;
+        }
+
+        arm_registration_ack_timer();
         LOGI("Registration sent, waiting for RegistrationAck (30 second timeout)\n");
-        
-        return send_pb(bin.data(), bin.size());
+
+        return enqueue_frame(std::move(frame));
     }
 
 
@@ -263,319 +342,143 @@ public:
             LOGE("send_detection_report_from_track_item: track_item is null\n");
             return -1;
         }
-        
-        std::string bin, json;
-        if (sapient_build_detection_report_from_track_item_cpp(bin, json, track_item) != 0) {
+
+        if (detection_allowance(1) == 0) {
+            // 链路容量已用尽：只刷新航迹存活时间，本次报告稀疏掉
+            SapientTrackRegistry::instance().touch(*track_item, steady_us() / 1000);
+            thinned_++;
+            return 0;
+        }
+
+        SapientFramePtr frame;
+        std::string json;
+        int ret = sapient_build_detection_report_frame(frame, json, track_item);
+        if (ret < 0) {
             LOGE("sapient_build_detection_report_from_track_item failed\n");
             return -1;
         }
-        
-        return send_pb(bin.data(), bin.size());
+        if (ret == 1) {
+            return 0;   // 航位推算抑制、调度推迟或区域筛选排除：本次无需发送
+        }
+
+        return enqueue_frame(std::move(frame), SAPIENT_LANE_DETECTION);
     }
 
-    // 发送 status report
-    int send_status_report() {
-        std::string bin, json;
-        if (sapient_build_status_report(bin, json) != 0) {
-            std::cerr << "sapient_build_status_report failed" << std::endl;
+    // 批量发送同一帧雷达数据的所有航迹：共享帧上下文一次构建，整批入队后由一次 flush 聚合写出
+    int send_detection_reports(const RadarTrackItem *items, size_t count) {
+        if (!items || count == 0) {
+            LOGE("send_detection_reports: no track items\n");
             return -1;
         }
-        return send_pb(bin.data(), bin.size());
-    }
 
-    // 同步接收一次：解析 4 字节小端长度前缀，随后读取完整消息体；
-    // 触发回调（如已设置），并将消息体拷贝到调用者缓冲区（若提供且有空间）。
-    // 返回值：>0 为拷贝到 buf 的消息体字节数；0 为超时；负值为错误。
-    int receive_once(void *buf, size_t buf_len, int timeout_sec) {
-        if (sockfd < 0) return -1;
-
-        auto recv_fully = [&](uint8_t *dst, size_t need) -> int {
-            size_t got = 0;
-            while (got < need) {
-                fd_set rfds; FD_ZERO(&rfds); FD_SET(sockfd, &rfds);
-                struct timeval tv; tv.tv_sec = timeout_sec; tv.tv_usec = 0;
-                int rc = select(sockfd + 1, &rfds, NULL, NULL, &tv);
-                if (rc == 0) return 0; // 超时
-                if (rc < 0) return -1; // select 错误
-                ssize_t n = recv(sockfd, dst + got, need - got, 0);
-                if (n <= 0) return -1; // 连接关闭或错误
-                got += (size_t)n;
-            }
-            return (int)got;
-        };
+        // 整形限速时只构建链路容量允许的报告数，由调度器按航迹价值选出（其余推迟，不入队积压）
+        size_t allowance = detection_allowance(count);
+        if (allowance < count) thinned_ += count - allowance;
 
-        // 读取 4 字节长度前缀（小端）
-        uint8_t len_buf[4];
-        int hn = recv_fully(len_buf, sizeof(len_buf));
-        if (hn <= 0) return hn; // 0=超时，-1=错误
-        uint32_t body_len = (uint32_t)len_buf[0]
-                          | ((uint32_t)len_buf[1] << 8)
-                          | ((uint32_t)len_buf[2] << 16)
-                          | ((uint32_t)len_buf[3] << 24);
-        if (body_len == 0 || body_len > (32u * 1024u * 1024u)) {
-            std::cerr << "invalid sapient frame length: " << body_len << std::endl;
+        std::vector<SapientFramePtr> frames;
+        size_t built = sapient_build_detection_report_frames(frames, items, count, allowance);
+        update_detection_frame_size(frames);
+        int ret = enqueue_frames(frames, SAPIENT_LANE_DETECTION);
+        if (built < count) {
+            LOGE("sapient_build_detection_report_frames: %zu of %zu reports failed\n", count - built, count);
             return -1;
         }
+        return ret;
+    }
 
-        // 读取完整消息体
-        std::string body;
-        body.resize(body_len);
-        int bn = recv_fully(reinterpret_cast<uint8_t*>(&body[0]), body_len);
-        if (bn <= 0) return bn; // 0=超时，-1=错误
+    // 发送超时丢失航迹的 "lost" 报告（无丢失航迹时不构建任何消息）
+    int send_lost_reports() {
+        std::vector<SapientFramePtr> frames;
+        size_t n = sapient_build_lost_detection_frames(frames);
+        if (n == 0) return 0;
+        LOGI("Sending %zu lost-track detection reports\n", n);
+        return enqueue_frames(frames, SAPIENT_LANE_DETECTION);
+    }
 
-        // 回调传入完整消息体（不含前缀）
-        if (on_msg) on_msg(body.data(), body.size(), user);
+    // 发送 status report：状态无变化时为紧凑心跳；full 为 true 时发送完整报告
+    int send_status_report(bool full = false) {
+        refresh_rate_budget();   // 状态定时器周期调用：无航迹时也能跟上网络速度的变化
+        SapientFramePtr frame;
+        std::string json;
+        if (sapient_build_status_report_frame(frame, json, full) != 0) {
+            std::cerr << "sapient_build_status_report failed" << std::endl;
+            return -1;
+        }
+        return enqueue_frame(std::move(frame), SAPIENT_LANE_STATUS);
+    }
+
+    // 同步接收一次：等待反应器收到的下一条完整消息（回调照常触发），
+    // 并将消息体拷贝到调用者缓冲区（若提供且有空间）。
+    // 返回值：>0 为拷贝到 buf 的消息体字节数；0 为超时；负值为错误。
+    int receive_once(void *buf, size_t buf_len, int timeout_sec) {
+        if (reactor_.in_loop_thread()) return -1;   // 反应器线程等待自身会死锁
+        if (!is_connected.load()) return -1;
+
+        std::unique_lock<std::mutex> lock(sync_rx_mutex_);
+        uint64_t seq = sync_rx_seq_;
+        sync_rx_waiters_++;
+        bool got = sync_rx_cv_.wait_for(lock, std::chrono::seconds(timeout_sec), [&]() {
+            return sync_rx_seq_ != seq || !is_connected.load();
+        });
+        sync_rx_waiters_--;
+        if (!got) return 0;                         // 超时
+        if (sync_rx_seq_ == seq) return -1;         // 等待期间连接断开
 
-        // 如果调用者提供缓冲区，则拷贝消息体
-        int copy_len = (int)std::min(buf_len, (size_t)body_len);
+        int copy_len = (int)std::min(buf_len, sync_rx_body_.size());
         if (buf && copy_len > 0) {
-            memcpy(buf, body.data(), (size_t)copy_len);
+            memcpy(buf, sync_rx_body_.data(), (size_t)copy_len);
         }
         return copy_len;
     }
 
-    void set_on_message(sapient_tcp_on_message_cb cb, void *u) { on_msg = cb; user = u; }
+    void set_on_message(sapient_tcp_on_message_cb cb, void *u) {
+        // 回调在反应器线程中读取，切换到反应器线程修改
+        run_in_loop_sync([this, cb, u]() { on_msg = cb; user = u; });
+    }
 
-    // 启动后台接收线程：循环读取完整帧并触发回调
-    // 接收线程负责检测连接断开并自动重连
+    // 启动接收会话：连接由反应器读取并触发回调，断线后自动按 10 秒间隔重连
+    // 尚未连接时直接进入后台重连流程（替代原先独立的重连线程）
     int start_receive_thread() {
         if (running) {
-            LOGI("Receive thread already running\n");
-            return 0; // 已启动
+            LOGI("Receive session already running\n");
+            return 0;
         }
-        if (sockfd < 0) {
-            LOGE("Cannot start receive thread: socket not connected\n");
+        if (reactor_.start() != 0) {
+            LOGE("Cannot start receive session: reactor not running\n");
             return -1;
         }
-        LOGI("Starting receive thread...\n");
+        LOGI("Starting receive session on reactor...\n");
         running = true;
-        recv_thread = std::thread([this]() {
-            LOGI("Receive thread started successfully\n");
-            std::vector<uint8_t> tmp(64 * 1024);
-            int consecutive_errors = 0;  // 连续错误计数
-            const int max_consecutive_errors = 3;  // 连续3次错误才认为断开
-            
-            while (running) {
-                // ========== 检查 RegistrationAck 30 秒超时 ==========
-                {
-                    std::lock_guard<std::mutex> lock(registration_mutex_);
-                    if (waiting_for_registration_ack_) {
-                        auto now = std::chrono::steady_clock::now();
-                        auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(
-                            now - registration_sent_time_).count();
-                        
-                        // 根据 Sapient 规范：30 秒内未收到 RegistrationAck，必须重连并重发
-                        if (elapsed >= 30) {
-                            LOGE("RegistrationAck timeout (%ld seconds), triggering reconnect per Sapient spec\n", 
-                                 elapsed);
-                            waiting_for_registration_ack_ = false;
-                            is_connected = false;  // 标记连接断开
-                            
-                            // 强制重连并重发 Registration
-                            std::lock_guard<std::mutex> rlock(reconnect_mutex);
-                            LOGI("Reconnecting due to RegistrationAck timeout...\n");
-                            if (reconnect_with_backoff(true) == 0) {  // true = 强制发送 registration
-                                LOGI("Reconnected successfully after RegistrationAck timeout\n");
-                                consecutive_errors = 0;
-                            } else {
-                                LOGE("Reconnect failed after RegistrationAck timeout\n");
-                                std::this_thread::sleep_for(std::chrono::seconds(5));
-                            }
-                            continue;  // 跳过本次接收，直接进入下一轮循环
-                        }
-                    }
-                }
-                // ===================================================
-                
-                int ret = this->receive_once(tmp.data(), tmp.size(), 1);
-                if (ret < 0) {
-                    consecutive_errors++;
-                    // 连续多次错误才认为连接真正断开（避免网络抖动误判）
-                    if (consecutive_errors >= max_consecutive_errors) {
-                        is_connected = false;  // 标记连接已断开
-                        // 记录断线时间（在 close_socket() 中也会记录，但这里提前记录更准确）
-                        if (!disconnect_time_valid_) {
-                            disconnect_time_ = std::chrono::steady_clock::now();
-                            disconnect_time_valid_ = true;
-                        }
-                        LOGI("Connection lost detected, attempting reconnect\n");
-                        std::lock_guard<std::mutex> lock(reconnect_mutex);
-                        LOGI("Calling reconnect_with_backoff() from receive thread\n");
-                        if (reconnect_with_backoff() == 0) {
-                            LOGI("Reconnected successfully\n");
-                            consecutive_errors = 0;  // 重置错误计数
-                            // 重连成功，是否发送注册报文由 reconnect_with_backoff() 根据断线时间决定
-                        } else {
-                            LOGE("Reconnect failed in receive thread\n");
-                            // 重连失败，等待后继续尝试
-                            std::this_thread::sleep_for(std::chrono::seconds(5));
-                        }
-                    } else {
-                        // 可能是临时错误，短暂等待后继续
-                        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-                    }
-                } else if (ret == 0) {
-                    // 超时是正常情况，重置错误计数
-                    consecutive_errors = 0;
-                    continue;
-                } else {
-                    // 成功接收，重置错误计数
-                    consecutive_errors = 0;
-                    // 回调已在 receive_once 内部触发
-                }
-            }
+        reactor_.post([this]() {
+            if (state_ == kStateDisconnected) schedule_reconnect(0);
+            else if (state_ == kStateConnected) update_interest();
         });
         return 0;
     }
 
-    // 停止后台接收线程
+    // 停止接收会话：停止读取与自动重连（连接本身由 close_connection() 关闭）
     void stop_receive_thread() {
         if (!running) return;
         running = false;
-        if (recv_thread.joinable()) recv_thread.join();
-    }
-
-    // 自动重连机制：尝试重新建立连接，并在重连成功后根据断线时间决定是否发送注册报文
-    // 根据 Sapient 规范：每 10 秒尝试连接一次，直到成功
-    // 根据 Sapient 规范：如果重连发生在断线后2分钟内，不需要重新发送 registration message
-    // 参数 send_registration: 是否强制发送注册报文（默认false，由断线时间自动决定）
-    int reconnect_with_backoff(bool force_send_registration = false) {
-        const int reconnect_interval_seconds = 10;  // Sapient 规范要求：每 10 秒尝试一次
-        
-        close_socket();  // 先关闭旧socket，释放资源
-        
-        int attempt = 0;
-        while (running) {
-            attempt++;
-            LOGI("Reconnecting attempt %d (interval: %d seconds, per Sapient spec)\n", 
-                 attempt, reconnect_interval_seconds);
-            
-            // 尝试连接（超时5秒）
-            int ret = connect_with_timeout(5);
-            if (ret == 0) {
-                LOGI("Reconnection successful after %d attempts\n", attempt);
-                is_connected = true;  // 重连成功，标记为已连接
-                
-                // 根据 Sapient 规范判断是否需要发送 registration message：
-                // 如果重连发生在断线后2分钟内，不需要重新发送 registration message
-                bool need_send_registration = force_send_registration;
-                if (!need_send_registration && disconnect_time_valid_) {
-                    auto now = std::chrono::steady_clock::now();
-                    auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - disconnect_time_).count();
-                    const int64_t registration_timeout_seconds = 120;  // 2分钟 = 120秒
-                    
-                    if (elapsed >= registration_timeout_seconds) {
-                        need_send_registration = true;
-                        LOGI("Disconnection time exceeded %ld seconds (%ld seconds elapsed), registration required\n",
-                             registration_timeout_seconds, elapsed);
-                    } else {
-                        LOGI("Reconnection within %ld seconds (%ld seconds elapsed), registration not required\n",
-                             registration_timeout_seconds, elapsed);
-                    }
-                } else if (!disconnect_time_valid_) {
-                    // 首次连接或断线时间戳无效，需要发送 registration
-                    need_send_registration = true;
-                    LOGI("First connection or invalid disconnect time, registration required\n");
-                }
-                
-                // 重连成功后根据判断结果决定是否发送注册报文
-                LOGI("Reconnect successful, need_send_registration=%d\n", need_send_registration);
-                if (need_send_registration) {
-                    LOGI("Sending registration after reconnection\n");
-                    std::string bin, json;
-                    if (sapient_build_registration(bin, json) == 0) {
-                        // 注意：这里不锁 send_mutex_，因为 reconnect_with_backoff() 可能从
-                        // send_all_impl() 调用，而 send_all_impl() 的调用者 send_pb_impl()
-                        // 已经持有 send_mutex_，加锁会死锁。
-                        // 此处安全性保证：新 socket 刚创建，其他线程被 reconnect_mutex 阻塞，
-                        // 不可能同时在新 socket 上发送。
-                        
-                        // 先发送4字节长度前缀
-                        uint32_t body_len = (uint32_t)bin.size();
-                        uint8_t len_buf[4];
-                        len_buf[0] = (uint8_t)(body_len & 0xFF);
-                        len_buf[1] = (uint8_t)((body_len >> 8) & 0xFF);
-                        len_buf[2] = (uint8_t)((body_len >> 16) & 0xFF);
-                        len_buf[3] = (uint8_t)((body_len >> 24) & 0xFF);
-                        
-                        // 完整发送长度前缀（循环发送确保完整）
-                        size_t sent = 0;
-                        while (sent < sizeof(len_buf)) {
-                            ssize_t n = ::send(sockfd, len_buf + sent, sizeof(len_buf) - sent, 0);
-                            if (n <= 0) {
-                                LOGE("Failed to send registration length prefix: %s\n", strerror(errno));
-                                break;
-                            }
-                            sent += n;
-                        }
-                        
-                        // 完整发送消息体（循环发送确保完整）
-                        if (sent == sizeof(len_buf)) {
-                            sent = 0;
-                            while (sent < bin.size()) {
-                                ssize_t n = ::send(sockfd, bin.data() + sent, bin.size() - sent, 0);
-                                if (n <= 0) {
-                                    LOGE("Failed to send registration body: %s\n", strerror(errno));
-                                    break;
-                                }
-                                sent += n;
-                            }
-                            if (sent == bin.size()) {
-                                LOGI("Registration sent successfully (%zu bytes)\n", bin.size());
-                            }
-                        }
-                    } else {
-                        LOGE("Failed to build registration message\n");
-                    }
-                }
-                
-                // 注意：这里也不要清除 disconnect_time_valid_。
-                // 断线时间戳需要保留给“断网后 2 分钟规则”的上层逻辑使用。
-                
-                return 0;  // 重连成功
-            }
-            
-            // 根据 Sapient 规范：每 10 秒尝试一次，直到成功
-            // 等待 10 秒后继续下一次尝试
-            std::this_thread::sleep_for(std::chrono::seconds(reconnect_interval_seconds));
-        }
-        
-        // 如果 running 变为 false，说明程序正在退出
-        LOGI("Reconnection stopped (running flag set to false)\n");
-        return -1;
-    }
-
-    // 检查socket是否有效（通过发送0字节数据检测）
-    bool is_socket_alive() {
-        if (sockfd < 0) return false;
-        
-        // 使用MSG_DONTWAIT和MSG_NOSIGNAL标志，避免阻塞和信号
-        char buf;
-        ssize_t n = recv(sockfd, &buf, 1, MSG_PEEK | MSG_DONTWAIT);
-        
-        if (n == 0) {
-            // 对端关闭连接
-            return false;
-        } else if (n < 0) {
-            // 检查是否是"暂时无数据"错误（正常情况）
-            if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                return true;  // socket正常，只是暂时没数据
-            }
-            // 其他错误表示连接已断开
-            return false;
-        }
-        return true;  // 有数据可读，socket正常
+        reactor_.run_sync([this]() {
+            cancel_timer(reconnect_timer_);
+            if (state_ == kStateConnected) update_interest();
+        });
     }
 
     // 获取断网时间（从断网到现在的秒数）
     int get_disconnect_elapsed_seconds() {
+        std::lock_guard<std::mutex> lock(disconnect_mutex_);
         if (!disconnect_time_valid_) return -1;
         auto now = std::chrono::steady_clock::now();
         auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - disconnect_time_).count();
         return (int)elapsed;
     }
 
-    void clear_disconnect_time() { disconnect_time_valid_ = false; }
+    void clear_disconnect_time() {
+        std::lock_guard<std::mutex> lock(disconnect_mutex_);
+        disconnect_time_valid_ = false;
+    }
 
     // 检查是否在线（连接状态）
     bool is_online() const {
@@ -584,42 +487,752 @@ public:
 
     // 标记收到 RegistrationAck（由外部消息解析器调用）
     void mark_registration_ack_received() {
-        std::lock_guard<std::mutex> lock(registration_mutex_);
-        if (waiting_for_registration_ack_) {
+        {
+            std::lock_guard<std::mutex> lock(registration_mutex_);
+            if (!waiting_for_registration_ack_) return;
             registration_ack_received_ = true;
             waiting_for_registration_ack_ = false;
-            
+
             auto now = std::chrono::steady_clock::now();
             auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
                 now - registration_sent_time_).count();
             LOGI("RegistrationAck received after %ld ms\n", elapsed);
         }
+        run_in_loop([this]() {
+            cancel_timer(ack_timer_);
+            start_outbox_replay();   // 注册完成：重放断线期间保存的帧
+        });
     }
 
 private:
+    enum { kStateDisconnected = 0, kStateConnecting = 1, kStateConnected = 2 };
+    enum { kConnectIdle = 2, kConnectPending = 1 };   // 其余取值：0 成功，-1 失败
+
+    static const int kReconnectIntervalMs = 10 * 1000;        // Sapient 规范要求：每 10 秒尝试一次
+    static const int kReconnectConnectTimeoutMs = 5 * 1000;   // 单次重连的连接超时
+    static const int kRegistrationAckTimeoutMs = 30 * 1000;   // Sapient 规范：30 秒内必须收到 RegistrationAck
+    static const int64_t kRegistrationTimeoutSeconds = 120;   // 断线超过 2 分钟需要重新注册
+    static const size_t kMaxTxIov = 64;                       // 单次 sendmsg() 聚合的最大帧数
+    static const int kOutboxReplayTickMs = 100;               // 发件箱重放节拍
+    static const size_t kOutboxReplayMaxQueued = 64;          // 发送队列积压超过该值时暂停重放
+    static const unsigned int kDefaultOutboxReplayRate = 50;  // 默认重放速率（帧/秒）
+    static const unsigned int kDefaultOutboxDetectionMaxAgeMs = 10 * 1000;   // 检测报告重放时限
+    static const int64_t kRateBudgetCheckMs = 1000;           // 网络速度状态位的检查间隔
+    static const unsigned int kMaxDetectionBacklogMs = 1000;  // 检测通道最多积压的发送时长
+    static const unsigned int kDefaultDetectionFrameBytes = 256;   // 检测报告帧长的初始估计
+    static const size_t kShaperWaitBytes = 1024;              // 字节令牌不足时，至少攒够这么多再写
+
+    // 在反应器线程中执行（当前已在反应器线程时直接执行）
+    void run_in_loop(SapientReactor::Task task) {
+        if (reactor_.in_loop_thread()) task();
+        else reactor_.post(std::move(task));
+    }
+
+    void run_in_loop_sync(SapientReactor::Task task) {
+        reactor_.run_sync(std::move(task));
+    }
+
+    void cancel_timer(SapientReactor::TimerId &id) {
+        if (id) {
+            reactor_.cancel_timer(id);
+            id = 0;
+        }
+    }
+
+    void finish_connect_request(int result) {
+        std::lock_guard<std::mutex> lock(connect_mutex_);
+        if (connect_result_ == kConnectPending) {
+            connect_result_ = result;
+            connect_cv_.notify_all();
+        }
+    }
+
+    // 断线期间按策略把帧写入发件箱（任意线程）；返回 true 表示已保存，调用方不再入队。
+    // 控制帧（注册、TaskAck）不保存：重连后注册报文重新生成，过时的 TaskAck 没有意义
+    bool store_offline(const SapientFramePtr &frame) {
+        if (!outbox_enabled_ || !running || is_connected) return false;
+        int lane = frame->lane;
+        if (lane == SAPIENT_LANE_CONTROL) return false;
+        if (outbox_policy_ == SAPIENT_OUTBOX_ALERT_STATUS && lane == SAPIENT_LANE_DETECTION) return false;
+        return outbox_.append(*frame, lane, SapientTime::now().unix_ms()) == 0;
+    }
+
+    // 开始重放发件箱（反应器线程，连接并完成注册后调用）
+    void start_outbox_replay() {
+        if (!outbox_enabled_ || replay_timer_ || outbox_.size() == 0) return;
+        LOGI("Replaying %zu frames from outbox at %u frames/s\n", outbox_.size(), outbox_rate_.load());
+        replay_timer_ = reactor_.add_timer(0, kOutboxReplayTickMs, [this]() { replay_outbox_tick(); });
+    }
+
+    // 每个节拍最多重放 rate * tick 帧；过期的检测报告直接丢弃（立即确认），不占用速率。
+    // 重放帧整帧写出后才在发件箱中确认（consume_tx），崩溃后未确认的帧会再次重放
+    void replay_outbox_tick() {
+        if (state_ != kStateConnected || !outbox_enabled_) {
+            cancel_timer(replay_timer_);   // 再次断线：剩余帧留在发件箱，下次注册后继续
+            return;
+        }
+        if (send_queue_.size() >= kOutboxReplayMaxQueued) return;   // 链路跟不上，等下一拍
+
+        size_t budget = (size_t)outbox_rate_ * kOutboxReplayTickMs / 1000;
+        if (budget == 0) budget = 1;
+        int64_t now_ms = SapientTime::now().unix_ms();
+        size_t sent = 0;
+        SapientFramePtr frame;
+        int lane = 0;
+        int64_t created_ms = 0;
+        while (sent < budget && outbox_.peek(frame, &lane, &created_ms)) {
+            unsigned int max_age = outbox_max_detection_age_ms_;
+            if (lane == SAPIENT_LANE_DETECTION && max_age > 0 && now_ms - created_ms > (int64_t)max_age) {
+                outbox_.commit((uint64_t)frame->outbox_seq);
+                outbox_expired_++;
+                continue;
+            }
+            enqueue_frame(std::move(frame), lane);
+            outbox_replayed_++;
+            sent++;
+        }
+        if (outbox_.size() == 0) {
+            cancel_timer(replay_timer_);
+            LOGI("Outbox replay finished (replayed=%llu, expired=%llu)\n",
+                 (unsigned long long)outbox_replayed_.load(), (unsigned long long)outbox_expired_.load());
+        }
+    }
+
+    static int64_t steady_us() {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // 生效整形速率（任意线程）：令牌桶只在反应器线程中修改；桶容量为 1 秒的令牌
+    void apply_rate_limit(unsigned int bytes_per_sec, unsigned int msgs_per_sec) {
+        rate_bytes_ = bytes_per_sec;
+        rate_msgs_ = msgs_per_sec;
+        LOGI("sapient tx shaper: %u bytes/s, %u msgs/s (0 = unlimited)\n", bytes_per_sec, msgs_per_sec);
+        run_in_loop([this, bytes_per_sec, msgs_per_sec]() {
+            byte_bucket_.configure((double)bytes_per_sec, 0);
+            msg_bucket_.configure((double)msgs_per_sec, 0);
+            cancel_timer(shaper_timer_);   // 速率变化：按新速率重新计算等待时间
+            flush();
+        });
+    }
+
+    // 按 RadarState 的网络速度（B12B11）与功耗模式（B14B13）自动设置整形速率，
+    // 每秒最多检查一次，状态位不变时不重复设置
+    void refresh_rate_budget() {
+        // 网络速度等级对应的链路预算（0 为默认/高速链路，不限速）
+        static const struct { unsigned int bytes; unsigned int msgs; } kNetworkSpeedBudget[4] = {
+            { 0, 0 }, { 32 * 1024, 200 }, { 8 * 1024, 50 }, { 2 * 1024, 10 },
+        };
+        if (!rate_auto_) return;
+        int64_t now_ms = steady_us() / 1000;
+        if (now_ms - rate_checked_ms_.load() < kRateBudgetCheckMs) return;
+        rate_checked_ms_ = now_ms;
+
+        unsigned int status = 0;
+        if (get_radar_status_bits(&status) != 0) return;
+        int speed = (int)((status >> 11) & 0x03);
+        int power = (int)((status >> 13) & 0x03);
+        int rate_class = speed | (power << 2);
+        if (rate_class_.exchange(rate_class) == rate_class) return;
+
+        unsigned int bytes = kNetworkSpeedBudget[speed].bytes;
+        unsigned int msgs = kNetworkSpeedBudget[speed].msgs;
+        if (power == 1) {   // 低功耗模式：链路预算减半
+            bytes /= 2;
+            msgs /= 2;
+        }
+        LOGI("RadarState network_speed=%d power_mode=%d\n", speed, power);
+        apply_rate_limit(bytes, msgs);
+    }
+
+    // 按整形速率估算本帧雷达数据最多可构建的检测报告数（任意线程）：
+    // 检测通道积压不超过 kMaxDetectionBacklogMs 的发送量，超出部分在构建前稀疏
+    size_t detection_allowance(size_t count) {
+        refresh_rate_budget();
+        unsigned int bytes = rate_bytes_;
+        unsigned int msgs = rate_msgs_;
+        if (bytes == 0 && msgs == 0) return count;
+
+        double rate = (msgs > 0) ? (double)msgs : 1e18;
+        if (bytes > 0) {
+            rate = std::min(rate, (double)bytes / (double)avg_detection_bytes_.load());
+        }
+        size_t cap = (size_t)(rate * kMaxDetectionBacklogMs / 1000);
+        if (cap == 0) cap = 1;
+        size_t queued = 0;
+        send_queue_.lane_stats(SAPIENT_LANE_DETECTION, &queued, NULL);
+        size_t allowance = (cap > queued) ? cap - queued : 0;
+        return std::min(allowance, count);
+    }
+
+    // 检测报告帧长的滑动平均（1/8 权重），用于把字节速率换算为报告数
+    void update_detection_frame_size(const std::vector<SapientFramePtr> &frames) {
+        if (frames.empty()) return;
+        size_t total = 0;
+        for (size_t i = 0; i < frames.size(); i++) {
+            total += frames[i]->size();
+        }
+        unsigned int sample = (unsigned int)(total / frames.size());
+        unsigned int avg = avg_detection_bytes_.load();
+        avg_detection_bytes_ = (avg * 7 + sample) / 8 + 1;
+    }
+
+    // 令牌不足：停止关注可写事件，等补足所需令牌后由定时器恢复写出（反应器线程）
+    void wait_for_tokens() {
+        int64_t wait = 0;
+        if (tx_frames_.empty()) {
+            wait = msg_bucket_.wait_us(1.0);
+        } else {
+            size_t remain = tx_frames_.front()->size() - tx_offset_;
+            wait = byte_bucket_.wait_us((double)std::min(remain, (size_t)kShaperWaitBytes));
+        }
+        set_want_write(false);
+        shaper_timer_ = reactor_.add_timer((int)(wait / 1000) + 1, 0, [this]() {
+            shaper_timer_ = 0;
+            flush();
+        });
+    }
+
+    // 合并唤醒：多个生产者连续入队时只投递一次 flush
+    void schedule_flush() {
+        if (flush_pending_.exchange(true)) return;
+        reactor_.post([this]() {
+            flush_pending_ = false;
+            flush();
+        });
+    }
+
+    // 发起非阻塞连接（反应器线程）
+    // auto_registration: 连接成功后是否按断线时间规则自动发送 registration（自动重连时为 true）
+    void start_connect(int timeout_ms, bool auto_registration) {
+        if (state_ == kStateConnected) {
+            finish_connect_request(0);
+            return;
+        }
+        if (state_ == kStateConnecting) {
+            return;   // 连接进行中，结果由 on_connected()/connect_failed() 通知
+        }
+
+        const char *use_host = host.empty() ? getenv("SAPIENT_HOST") : host.c_str();
+        int use_port = (port <= 0) ? (getenv("SAPIENT_PORT") ? atoi(getenv("SAPIENT_PORT")) : 0) : port;
+        if (!use_host || use_port <= 0) {
+            LOGE("sapient client: invalid host/port\n");
+            connect_failed();
+            return;
+        }
+
+        struct sockaddr_in srv;
+        memset(&srv, 0, sizeof(srv));
+        srv.sin_family = AF_INET;
+        srv.sin_port = htons(use_port);
+        if (inet_pton(AF_INET, use_host, &srv.sin_addr) <= 0) {
+            LOGE("inet_pton failed for host %s\n", use_host);
+            connect_failed();
+            return;
+        }
+
+        int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0) {
+            LOGE("socket() failed: %s\n", strerror(errno));
+            connect_failed();
+            return;
+        }
+
+        int rc = ::connect(fd, (struct sockaddr*)&srv, sizeof(srv));
+        if (rc < 0 && errno != EINPROGRESS) {
+            LOGE("connect() failed: %s\n", strerror(errno));
+            close(fd);
+            connect_failed();
+            return;
+        }
+
+        // 连接进行中只关心可写（连接完成）事件
+        if (reactor_.add_fd(fd, EPOLLOUT, [this](uint32_t events) { handle_io(events); }) != 0) {
+            close(fd);
+            connect_failed();
+            return;
+        }
+        sockfd = fd;
+        state_ = kStateConnecting;
+        auto_registration_ = auto_registration;
+
+        if (rc == 0) {
+            on_connected();
+            return;
+        }
+        connect_timer_ = reactor_.add_timer(timeout_ms, 0, [this]() {
+            connect_timer_ = 0;
+            LOGE("connect timeout\n");
+            close_fd();
+            connect_failed();
+        });
+    }
+
+    void connect_failed() {
+        finish_connect_request(-1);
+        if (running) {
+            LOGI("Reconnect attempt %d failed, will retry in %d seconds\n",
+                 reconnect_attempt_, kReconnectIntervalMs / 1000);
+            schedule_reconnect(kReconnectIntervalMs);
+        }
+    }
+
+    static void apply_socket_options(int fd) {
+        // 设置 TCP_NODELAY（禁用 Nagle 算法，降低延迟）
+        int nodelay = 1;
+        if (setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay)) < 0) {
+            std::cerr << "setsockopt(TCP_NODELAY) failed: " << strerror(errno) << std::endl;
+        }
+
+        // 设置 SO_KEEPALIVE（启用 TCP keepalive，快速检测断开）
+        int keepalive = 1;
+        if (setsockopt(fd, SOL_SOCKET, SO_KEEPALIVE, &keepalive, sizeof(keepalive)) < 0) {
+            std::cerr << "setsockopt(SO_KEEPALIVE) failed: " << strerror(errno) << std::endl;
+        }
+
+        // 设置 keepalive 参数：10秒开始探测，5秒间隔，3次失败即断开（总共约20秒）
+        int keepidle = 10;   // 10秒空闲后开始探测
+        int keepintvl = 5;   // 每5秒探测一次
+        int keepcnt = 3;     // 3次失败即认为断开
+        setsockopt(fd, IPPROTO_TCP, TCP_KEEPIDLE, &keepidle, sizeof(keepidle));
+        setsockopt(fd, IPPROTO_TCP, TCP_KEEPINTVL, &keepintvl, sizeof(keepintvl));
+        setsockopt(fd, IPPROTO_TCP, TCP_KEEPCNT, &keepcnt, sizeof(keepcnt));
+    }
+
+    // 连接建立（反应器线程）
+    void on_connected() {
+        cancel_timer(connect_timer_);
+        apply_socket_options(sockfd);
+
+        state_ = kStateConnected;
+        is_connected = true;  // 连接成功，标记为已连接
+        decoder_.reset();
+        want_write_ = false;
+        update_interest();
+        send_queue_.reopen();
+        // 注意：不要在这里清除断线时间戳。
+        // 断线时间戳用于“断网后 2 分钟规则”（registration / status 发送策略），
+        // 应由上层在满足条件并完成一次动作后主动清除。
+
+        if (auto_registration_) {
+            LOGI("Reconnection successful after %d attempts\n", reconnect_attempt_);
+            send_registration_if_required();
+        }
+        reconnect_attempt_ = 0;
+        finish_connect_request(0);
+        flush();
+    }
+
+    // 根据 Sapient 规范判断重连后是否需要发送 registration message：
+    // 如果重连发生在断线后2分钟内，不需要重新发送 registration message
+    void send_registration_if_required() {
+        bool need_send_registration = force_registration_.exchange(false);
+        if (!need_send_registration) {
+            int elapsed = get_disconnect_elapsed_seconds();
+            if (elapsed < 0) {
+                // 首次连接或断线时间戳无效，需要发送 registration
+                need_send_registration = true;
+                LOGI("First connection or invalid disconnect time, registration required\n");
+            } else if (elapsed >= kRegistrationTimeoutSeconds) {
+                need_send_registration = true;
+                LOGI("Disconnection time exceeded %ld seconds (%d seconds elapsed), registration required\n",
+                     (long)kRegistrationTimeoutSeconds, elapsed);
+            } else {
+                LOGI("Reconnection within %ld seconds (%d seconds elapsed), registration not required\n",
+                     (long)kRegistrationTimeoutSeconds, elapsed);
+            }
+        }
+
+        LOGI("Reconnect successful, need_send_registration=%d\n", need_send_registration);
+        if (!need_send_registration) {
+            start_outbox_replay();   // 2 分钟内重连无需注册，直接重放
+            return;
+        }
+
+        SapientFramePtr frame;
+        if (sapient_build_registration_frame(frame) != 0) {
+            LOGE("Failed to build registration message\n");
+            return;
+        }
+        // 注册报文排在队列中其它帧之前发送（断线时未发完的帧已放回队首）
+        size_t frame_len = frame->body_len;
+        tx_frames_.push_front(std::move(frame));
+        tx_offset_ = 0;
+        arm_registration_ack_timer();
+        LOGI("Registration queued after reconnection (%zu bytes)\n", frame_len);
+    }
+
+    // 安排一次重连（反应器线程）；已有待执行的重连或连接未断开时忽略
+    void schedule_reconnect(int delay_ms) {
+        if (reconnect_timer_ || state_ != kStateDisconnected) return;
+        reconnect_timer_ = reactor_.add_timer(delay_ms, 0, [this]() {
+            reconnect_timer_ = 0;
+            if (!running || state_ != kStateDisconnected) return;
+            reconnect_attempt_++;
+            LOGI("Reconnecting attempt %d (interval: %d seconds, per Sapient spec)\n",
+                 reconnect_attempt_, kReconnectIntervalMs / 1000);
+            start_connect(kReconnectConnectTimeoutMs, true);
+        });
+    }
+
+    // socket 事件分发（反应器线程）
+    void handle_io(uint32_t events) {
+        if (state_ == kStateConnecting) {
+            int so_error = 0;
+            socklen_t len = sizeof(so_error);
+            getsockopt(sockfd, SOL_SOCKET, SO_ERROR, &so_error, &len);
+            if (so_error != 0) {
+                LOGE("socket error after connect: %s\n", strerror(so_error));
+                close_fd();
+                connect_failed();
+                return;
+            }
+            on_connected();
+            return;
+        }
+        if (state_ != kStateConnected) return;
+
+        if ((events & EPOLLIN) && !handle_readable()) return;
+        if (events & (EPOLLERR | EPOLLHUP)) {
+            handle_disconnect("socket error or hangup");
+            return;
+        }
+        if (events & EPOLLOUT) flush();
+    }
+
+    // 读取直到 EAGAIN（内核中的数据全部取走），每次 recv() 后就地分发所有完整帧；
+    // 连接断开时返回 false
+    bool handle_readable() {
+        for (;;) {
+            size_t space = 0;
+            uint8_t *dst = decoder_.write_ptr(&space);
+            ssize_t n = recv(sockfd, dst, space, 0);
+            if (n > 0) {
+                decoder_.commit((size_t)n);
+                if (!dispatch_frames()) return false;
+                if ((size_t)n < space) return true;   // 未填满：内核缓冲区已读空，省一次 EAGAIN
+                continue;
+            }
+            if (n == 0) {
+                handle_disconnect("peer closed connection");
+                return false;
+            }
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return true;
+            LOGE("recv() failed: %s\n", strerror(errno));
+            handle_disconnect("recv error");
+            return false;
+        }
+    }
+
+    // 把解码器中的完整帧（指向接收缓冲区，不拷贝）交给回调
+    bool dispatch_frames() {
+        int ret = decoder_.drain([this](const char *body, size_t len) -> bool {
+            if (sync_rx_waiters_.load() > 0) {
+                std::lock_guard<std::mutex> lock(sync_rx_mutex_);
+                sync_rx_body_.assign(body, len);
+                sync_rx_seq_++;
+                sync_rx_cv_.notify_all();
+            }
+            // 回调传入完整消息体（不含前缀）
+            if (on_msg) on_msg(body, len, user);
+            return state_ == kStateConnected;   // 回调中连接被关闭时停止解析
+        });
+        if (ret < 0) {
+            LOGE("sapient frame exceeds limit (%u bytes)\n", decoder_.max_frame_len());
+            handle_disconnect("oversized frame");
+            return false;
+        }
+        return ret == 0;
+    }
+
+    // 出队并写 socket，直到队列为空、内核缓冲区已满或整形令牌用尽（反应器线程）
+    // 每次最多聚合 kMaxTxIov 帧，用一次 sendmsg() 发出（一帧雷达数据的所有检测报告通常一次写完）
+    void flush() {
+        if (state_ != kStateConnected) return;   // 未连接：帧留在队列中，重连后发送
+        if (shaper_timer_) return;               // 正在等待整形令牌，由定时器恢复
+        int64_t now_us = steady_us();
+        byte_bucket_.refill(now_us);
+        msg_bucket_.refill(now_us);
+        for (;;) {
+            // 消息令牌在整帧写完时扣除（consume_tx）：出队数不超过扣除已在发送中的帧之后剩余的令牌，
+            // 断线时放回队列的帧未被扣除，重连重发时不会重复计费
+            if (tx_frames_.size() < kMaxTxIov) {
+                size_t room = kMaxTxIov - tx_frames_.size();
+                double msg_tokens = msg_bucket_.available() - (double)tx_frames_.size();
+                if (msg_tokens < (double)room) room = (msg_tokens >= 1.0) ? (size_t)msg_tokens : 0;
+                if (room > 0) {
+                    send_queue_.try_pop_batch(tx_frames_, room);
+                }
+            }
+            if (tx_frames_.empty()) {
+                if (send_queue_.size() > 0 && msg_bucket_.available() < 1.0) {
+                    wait_for_tokens();
+                    return;
+                }
+                break;
+            }
+            double byte_tokens = byte_bucket_.available();
+            if (byte_tokens < 1.0) {
+                wait_for_tokens();
+                return;
+            }
+
+            // 长度前缀与消息体连续存放，每帧一个 iovec；首帧可能已发送了一部分
+            // 本次写出的字节数不超过字节令牌（末帧可只写一部分，剩余部分下次续写）
+            size_t byte_budget = (byte_tokens >= (double)SIZE_MAX) ? SIZE_MAX : (size_t)byte_tokens;
+            struct iovec iov[kMaxTxIov];
+            size_t iov_cnt = 0;
+            size_t iov_bytes = 0;
+            for (; iov_cnt < tx_frames_.size() && iov_cnt < kMaxTxIov && iov_bytes < byte_budget; iov_cnt++) {
+                const SapientFramePtr &frame = tx_frames_[iov_cnt];
+                size_t skip = (iov_cnt == 0) ? tx_offset_ : 0;
+                size_t len = std::min(frame->size() - skip, byte_budget - iov_bytes);
+                iov[iov_cnt].iov_base = (void *)(frame->data() + skip);
+                iov[iov_cnt].iov_len = len;
+                iov_bytes += len;
+            }
+            struct msghdr msg;
+            memset(&msg, 0, sizeof(msg));
+            msg.msg_iov = iov;
+            msg.msg_iovlen = iov_cnt;
+            ssize_t n = ::sendmsg(sockfd, &msg, MSG_NOSIGNAL);
+            if (n > 0) {
+                byte_bucket_.consume((double)n);
+                consume_tx((size_t)n);
+                continue;
+            }
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                set_want_write(true);   // 内核缓冲区已满，等待可写事件
+                return;
+            }
+            LOGE("send() failed: %s\n", strerror(errno));
+            handle_disconnect("send error");
+            return;
+        }
+        set_want_write(false);
+    }
+
+    // 记录已写出的字节数，整帧写完的帧扣除一个消息令牌并归还到池中；发件箱重放帧同时确认
+    void consume_tx(size_t n) {
+        while (n > 0 && !tx_frames_.empty()) {
+            size_t remain = tx_frames_.front()->size() - tx_offset_;
+            if (n < remain) {
+                tx_offset_ += n;
+                return;
+            }
+            n -= remain;
+            if (tx_frames_.front()->outbox_seq >= 0) {
+                outbox_.commit((uint64_t)tx_frames_.front()->outbox_seq);
+            }
+            tx_frames_.pop_front();
+            tx_offset_ = 0;
+            msg_bucket_.consume(1.0);
+        }
+    }
+
+    void set_want_write(bool want) {
+        if (want_write_ == want || sockfd < 0) return;
+        want_write_ = want;
+        update_interest();
+    }
+
+    // 接收会话启动后才读取 socket（与原接收线程的语义一致：未设置回调前数据留在内核缓冲区）
+    void update_interest() {
+        uint32_t events = 0;
+        if (running) events |= EPOLLIN;
+        if (want_write_) events |= EPOLLOUT;
+        reactor_.modify_fd(sockfd, events);
+    }
+
+    // 关闭 socket 并复位连接状态（反应器线程）
+    void close_fd() {
+        cancel_timer(connect_timer_);
+        cancel_timer(shaper_timer_);
+        if (sockfd >= 0) {
+            reactor_.remove_fd(sockfd);
+            close(sockfd);
+            sockfd = -1;
+        }
+        state_ = kStateDisconnected;
+        is_connected = false;  // 标记连接已断开
+        want_write_ = false;
+        decoder_.reset();
+        // 未发完的帧整帧放回队首，重连后从头重发（不能在新连接上续发半帧，否则对端解析失步）
+        if (!tx_frames_.empty()) {
+            send_queue_.push_front_batch(tx_frames_);
+        }
+        tx_offset_ = 0;
+        // 唤醒等待同步接收的调用方
+        std::lock_guard<std::mutex> lock(sync_rx_mutex_);
+        sync_rx_cv_.notify_all();
+    }
+
+    // 检测到断线（反应器线程）：记录断线时间，立即尝试重连一次，之后每 10 秒重试
+    void handle_disconnect(const char *reason) {
+        LOGI("Connection lost (%s), fd=%d\n", reason, sockfd);
+        close_fd();
+        mark_disconnect_time();
+        if (running) {
+            schedule_reconnect(0);
+        }
+    }
+
+    // RegistrationAck 30 秒超时（反应器线程）
+    void on_registration_ack_timeout() {
+        {
+            std::lock_guard<std::mutex> lock(registration_mutex_);
+            if (!waiting_for_registration_ack_) return;
+            waiting_for_registration_ack_ = false;
+        }
+        // 根据 Sapient 规范：30 秒内未收到 RegistrationAck，必须重连并重发
+        LOGE("RegistrationAck timeout (%d seconds), triggering reconnect per Sapient spec\n",
+             kRegistrationAckTimeoutMs / 1000);
+        force_registration_ = true;   // 下一次重连强制发送 registration
+        if (state_ == kStateConnected) {
+            handle_disconnect("RegistrationAck timeout");
+        }
+    }
+
     std::string host;
     int port;
-    int sockfd;
+    int sockfd;                       // 仅反应器线程修改
     sapient_tcp_on_message_cb on_msg;
     void *user;
-    std::thread recv_thread;
-    std::atomic<bool> running;
-    std::atomic<bool> is_connected;  // 连接状态标志（避免频繁调用 is_socket_alive()）
-    std::mutex reconnect_mutex;  // 保护重连过程，避免并发重连
-    std::mutex send_mutex_;  // 保护 TCP 发送操作，确保 length-prefix + body 原子写入
+
+    SapientReactor &reactor_;
+    int state_;                       // kState*，仅反应器线程访问
+    std::atomic<bool> running;        // 接收会话是否启动（启动后断线自动重连）
+    std::atomic<bool> is_connected;   // 连接状态标志（供其它线程查询）
+    std::atomic<bool> force_registration_;   // 下一次重连是否强制发送 registration
+    std::atomic<bool> flush_pending_;        // 是否已有待执行的 flush 投递
+
+    // 以下成员仅反应器线程访问
+    bool auto_registration_;
+    bool want_write_;                 // 是否已注册 EPOLLOUT
+    std::deque<SapientFramePtr> tx_frames_;   // 已出队、正在发送的帧（按发送顺序）
+    size_t tx_offset_;                // 首帧已发送字节数
+    SapientFrameDecoder decoder_;     // 入站流式解码器（复用接收缓冲区）
+    SapientReactor::TimerId connect_timer_;
+    SapientReactor::TimerId reconnect_timer_;
+    SapientReactor::TimerId ack_timer_;
+    int reconnect_attempt_;
+
+    // 出站发送队列（所有 socket 写操作都在反应器线程中完成）
+    SapientSendQueue send_queue_;
+
+    // 同步连接结果
+    std::mutex connect_mutex_;
+    std::condition_variable connect_cv_;
+    int connect_result_;
+
+    // 同步接收（receive_once）：反应器在有等待者时拷贝最新一条消息
+    std::mutex sync_rx_mutex_;
+    std::condition_variable sync_rx_cv_;
+    std::atomic<int> sync_rx_waiters_;
+    uint64_t sync_rx_seq_;
+    std::string sync_rx_body_;
+
+    std::mutex disconnect_mutex_;     // 保护断线时间戳
     std::chrono::steady_clock::time_point disconnect_time_;  // 记录断线时间戳
     bool disconnect_time_valid_;  // 断线时间戳是否有效
-    
+
     // RegistrationAck 超时检测机制（30秒超时，根据 Sapient 规范）
     std::chrono::steady_clock::time_point registration_sent_time_;  // Registration 发送时间
     std::atomic<bool> registration_ack_received_;  // 是否收到 RegistrationAck
     std::atomic<bool> waiting_for_registration_ack_;  // 是否正在等待 RegistrationAck
     std::mutex registration_mutex_;  // 保护 registration 相关状态
+
+    // 断线存储转发发件箱（sapient_outbox.h）
+    SapientOutbox outbox_;
+    std::atomic<bool> outbox_enabled_;
+    std::atomic<int> outbox_policy_;                    // sapient_outbox_policy_t
+    std::atomic<unsigned int> outbox_rate_;             // 重放速率（帧/秒）
+    std::atomic<unsigned int> outbox_max_detection_age_ms_;
+    SapientReactor::TimerId replay_timer_;              // 仅反应器线程访问
+    std::atomic<uint64_t> outbox_replayed_;
+    std::atomic<uint64_t> outbox_expired_;
+
+    // 出站整形（sapient_rate_limiter.h）：令牌桶与等待定时器仅反应器线程访问
+    SapientTokenBucket byte_bucket_;
+    SapientTokenBucket msg_bucket_;
+    SapientReactor::TimerId shaper_timer_;
+    std::atomic<bool> rate_auto_;                       // 是否按 network_speed 自动设置速率
+    std::atomic<unsigned int> rate_bytes_;              // 生效的字节/秒（0 不限）
+    std::atomic<unsigned int> rate_msgs_;               // 生效的消息/秒（0 不限）
+    std::atomic<int> rate_class_;                       // 上次生效的 network_speed | power_mode << 2
+    std::atomic<int64_t> rate_checked_ms_;
+    std::atomic<uint64_t> thinned_;                     // 被稀疏的检测报告数
+    std::atomic<unsigned int> avg_detection_bytes_;     // 检测报告平均帧长
 };
 
 // C 包装器结构
 struct sapient_tcp_client_t { SapientTcpClientImpl *impl; };
 
+static int sapient_dispatch_message(const sapient_msg::bsi_flex_335_v2_0::SapientMessage &msg,
+                                    sapient_tcp_client_t *client);
+
+// 入站消息 arena 的栈上初始块大小（覆盖常见的 Task / RegistrationAck）
+static const size_t kInboundArenaBlockSize = 4096;
+
+// Task：按引用交给任务处理器，发送 TaskAck 并执行请求的动作
+static int handle_task_message(const sapient_msg::bsi_flex_335_v2_0::Task &task, sapient_tcp_client_t *client)
+{
+    LOGI("Received Sapient Task message\n");
+    SapientFramePtr ack_frame;
+    std::string ack_json;
+    int action = TASK_ACTION_NONE;
+    if (sapient_handle_task(task, ack_frame, ack_json, action) != 0) {
+        LOGE("sapient_handle_task failed\n");
+        return -1;
+    }
+    // Send TaskAck back（JSON 已按渲染策略输出到调试 sink，这里只记录长度）
+    LOGI("Sending TaskAck (%zu bytes)\n", ack_frame->size());
+    if (client && client->impl) {
+        client->impl->enqueue_frame(std::move(ack_frame));
+        
+        // 根据 action 类型执行相应动作
+        if (action == TASK_ACTION_SEND_REGISTRATION) {
+            LOGI("Task requested Registration, sending Registration report\n");
+            sapient_tcp_client_send_register(client);
+            // 一次性任务执行完成，清除任务ID
+            sapient_clear_current_task_id();
+        } else if (action == TASK_ACTION_SEND_STATUS) {
+            LOGI("Task requested Status, sending full Status report\n");
+            client->impl->send_status_report(true);
+            // 一次性任务执行完成，清除任务ID
+            sapient_clear_current_task_id();
+        }
+    }
+    return 0;
+}
+
+// RegistrationAck：停止 30 秒超时计时器并发送初始状态报告
+static int handle_registration_ack_message(const sapient_msg::bsi_flex_335_v2_0::RegistrationAck &ack,
+                                           sapient_tcp_client_t *client)
+{
+    (void)ack;
+    LOGI("Received Sapient RegistrationAck\n");
+    // 标记收到 RegistrationAck，停止 30 秒超时计时器
+    if (client && client->impl) {
+        client->impl->mark_registration_ack_received();
+        
+        // 根据 SAPIENT 规范：收到 RegistrationAck 后，必须发送初始状态报告
+        // "As part of system initialization, an initial status report message shall be 
+        //  sent after the registration acknowledgement message has been received. 
+        //  This shall indicate the initial state."
+        LOGI("Sending initial status report after RegistrationAck (per SAPIENT spec)\n");
+        int status_ret = client->impl->send_status_report(true);
+        if (status_ret != 0) {
+            LOGE("Failed to send initial status report after RegistrationAck: %d\n", status_ret);
+        } else {
+            LOGI("Initial status report sent successfully after RegistrationAck\n");
+        }
+    }
+    return 0;
+}
+
 extern "C" {
 
 sapient_tcp_client_t *sapient_tcp_client_create(const char *host, int port) {
@@ -649,6 +1262,128 @@ int sapient_tcp_client_send_pb(sapient_tcp_client_t *c, const void *data, size_t
     return c->impl->send_pb(data, len);
 }
 
+sapient_frame_t *sapient_frame_acquire(size_t body_len) {
+    return SapientFramePool::instance().acquire(body_len).release();
+}
+
+void *sapient_frame_body(sapient_frame_t *f) {
+    return f ? f->body() : NULL;
+}
+
+size_t sapient_frame_body_capacity(const sapient_frame_t *f) {
+    return f ? f->body_capacity() : 0;
+}
+
+void sapient_frame_release(sapient_frame_t *f) {
+    if (f) SapientFramePool::instance().recycle(f);
+}
+
+int sapient_tcp_client_send_frame(sapient_tcp_client_t *c, sapient_frame_t *f, size_t body_len) {
+    SapientFramePtr frame(f);  // 无论成功与否，帧的所有权都转移到这里
+    if (!c || !c->impl || !frame || body_len > frame->body_capacity()) return -1;
+    frame->commit(body_len);
+    return c->impl->enqueue_frame(std::move(frame));
+}
+
+int sapient_tcp_client_set_send_queue(sapient_tcp_client_t *c, size_t capacity,
+                                      sapient_queue_overflow_policy_t policy, int block_timeout_ms) {
+    if (!c || !c->impl) return -1;
+    c->impl->configure_send_queue(capacity, (int)policy, block_timeout_ms);
+    return 0;
+}
+
+void sapient_tcp_client_get_send_queue_stats(sapient_tcp_client_t *c, size_t *queued, unsigned long long *dropped) {
+    if (queued) *queued = 0;
+    if (dropped) *dropped = 0;
+    if (!c || !c->impl) return;
+    c->impl->get_send_queue_stats(queued, dropped);
+}
+
+unsigned long long sapient_tcp_client_get_conflated_count(sapient_tcp_client_t *c) {
+    if (!c || !c->impl) return 0;
+    return c->impl->get_conflated_count();
+}
+
+int sapient_tcp_client_enable_outbox(sapient_tcp_client_t *c, const char *path, size_t slot_size,
+                                     size_t slot_count, sapient_outbox_policy_t policy) {
+    if (!c || !c->impl || !path) return -1;
+    return c->impl->enable_outbox(path, slot_size, slot_count, (int)policy);
+}
+
+void sapient_tcp_client_disable_outbox(sapient_tcp_client_t *c) {
+    if (!c || !c->impl) return;
+    c->impl->disable_outbox();
+}
+
+int sapient_tcp_client_set_outbox_replay(sapient_tcp_client_t *c, unsigned int frames_per_sec,
+                                         unsigned int detection_max_age_ms) {
+    if (!c || !c->impl) return -1;
+    c->impl->configure_outbox_replay(frames_per_sec, detection_max_age_ms);
+    return 0;
+}
+
+void sapient_tcp_client_get_outbox_stats(sapient_tcp_client_t *c, size_t *pending, unsigned long long *replayed,
+                                         unsigned long long *expired, unsigned long long *overwritten) {
+    if (pending) *pending = 0;
+    if (replayed) *replayed = 0;
+    if (expired) *expired = 0;
+    if (overwritten) *overwritten = 0;
+    if (!c || !c->impl) return;
+    c->impl->get_outbox_stats(pending, replayed, expired, overwritten);
+}
+
+int sapient_tcp_client_set_lane_weight(sapient_tcp_client_t *c, sapient_lane_t lane, unsigned int max_wait) {
+    if (!c || !c->impl) return -1;
+    if (lane <= SAPIENT_TX_LANE_CONTROL || lane > SAPIENT_TX_LANE_DETECTION) return -1;
+    c->impl->set_lane_weight((int)lane, max_wait);
+    return 0;
+}
+
+void sapient_tcp_client_get_lane_stats(sapient_tcp_client_t *c, sapient_lane_t lane, size_t *queued,
+                                       unsigned long long *sent) {
+    if (queued) *queued = 0;
+    if (sent) *sent = 0;
+    if (!c || !c->impl) return;
+    c->impl->get_lane_stats((int)lane, queued, sent);
+}
+
+int sapient_tcp_client_set_rate_limit(sapient_tcp_client_t *c, unsigned int bytes_per_sec,
+                                      unsigned int msgs_per_sec) {
+    if (!c || !c->impl) return -1;
+    c->impl->set_rate_limit(bytes_per_sec, msgs_per_sec);
+    return 0;
+}
+
+int sapient_tcp_client_set_rate_limit_auto(sapient_tcp_client_t *c) {
+    if (!c || !c->impl) return -1;
+    c->impl->set_rate_limit_auto();
+    return 0;
+}
+
+void sapient_tcp_client_get_rate_limit_stats(sapient_tcp_client_t *c, unsigned int *bytes_per_sec,
+                                             unsigned int *msgs_per_sec, unsigned long long *thinned) {
+    if (bytes_per_sec) *bytes_per_sec = 0;
+    if (msgs_per_sec) *msgs_per_sec = 0;
+    if (thinned) *thinned = 0;
+    if (!c || !c->impl) return;
+    c->impl->get_rate_limit_stats(bytes_per_sec, msgs_per_sec, thinned);
+}
+
+int sapient_tcp_client_set_rx_limits(sapient_tcp_client_t *c, size_t initial_buffer, size_t max_frame_len,
+                                     sapient_rx_oversize_policy_t policy) {
+    if (!c || !c->impl) return -1;
+    if (max_frame_len > 0xFFFFFFFFu) max_frame_len = 0xFFFFFFFFu;
+    c->impl->configure_rx_limits(initial_buffer, (uint32_t)max_frame_len, (int)policy);
+    return 0;
+}
+
+void sapient_tcp_client_get_rx_stats(sapient_tcp_client_t *c, unsigned long long *frames, unsigned long long *oversized) {
+    if (frames) *frames = 0;
+    if (oversized) *oversized = 0;
+    if (!c || !c->impl) return;
+    c->impl->get_rx_stats(frames, oversized);
+}
+
 int sapient_tcp_client_send_register(sapient_tcp_client_t *c) {
     if (!c || !c->impl) return -1;
     return c->impl->send_register();
@@ -659,6 +1394,16 @@ int sapient_tcp_client_send_detection_report_from_track_item(sapient_tcp_client_
     return c->impl->send_detection_report_from_track_item(track_item);
 }
 
+int sapient_tcp_client_send_detection_reports(sapient_tcp_client_t *c, const RadarTrackItem *items, size_t count) {
+    if (!c || !c->impl) return -1;
+    return c->impl->send_detection_reports(items, count);
+}
+
+int sapient_tcp_client_send_lost_reports(sapient_tcp_client_t *c) {
+    if (!c || !c->impl) return -1;
+    return c->impl->send_lost_reports();
+}
+
 int sapient_tcp_client_send_status_report(sapient_tcp_client_t *c) {
     if (!c || !c->impl) return -1;
     return c->impl->send_status_report();
@@ -666,13 +1411,14 @@ int sapient_tcp_client_send_status_report(sapient_tcp_client_t *c) {
 
 int sapient_tcp_client_send_alert_report(sapient_tcp_client_t *c, const char *description, int type, int status) {
     if (!c || !c->impl) return -1;
-    // 直接构建并发送（最小版本）
-    std::string bin, json;
-    if (sapient_build_alert_report(bin, json, description, type, status) != 0) {
+    // 直接构建到帧缓冲并入队（最小版本）
+    SapientFramePtr frame;
+    std::string json;
+    if (sapient_build_alert_report_frame(frame, json, description, type, status) != 0) {
         LOGE("sapient_build_alert_report failed\n");
         return -1;
     }
-    return c->impl->send_pb(bin.data(), bin.size());
+    return c->impl->enqueue_frame(std::move(frame), SAPIENT_LANE_ALERT);
 }
 
 int sapient_tcp_client_receive_once(sapient_tcp_client_t *c, void *buf, size_t buf_len, int timeout_sec) {
@@ -682,8 +1428,7 @@ int sapient_tcp_client_receive_once(sapient_tcp_client_t *c, void *buf, size_t b
 
 void sapient_tcp_client_close(sapient_tcp_client_t *c) {
     if (!c || !c->impl) return;
-    c->impl->stop_receive_thread();
-    c->impl->close_socket();
+    c->impl->close_connection();
 }
 
 void sapient_tcp_client_destroy(sapient_tcp_client_t *c) {
@@ -692,13 +1437,13 @@ void sapient_tcp_client_destroy(sapient_tcp_client_t *c) {
     delete c;
 }
 
-// 启动后台接收线程（建议在成功连接后调用）
+// 启动接收会话（兼容原接口名，由反应器读取并自动重连）
 int sapient_tcp_client_start_receive_thread(sapient_tcp_client_t *c) {
     if (!c || !c->impl) return -1;
     return c->impl->start_receive_thread();
 }
 
-// 停止后台接收线程
+// 停止接收会话
 void sapient_tcp_client_stop_receive_thread(sapient_tcp_client_t *c) {
     if (!c || !c->impl) return;
     c->impl->stop_receive_thread();
@@ -732,51 +1477,35 @@ int sapient_parse_and_handle_message(const char *data, size_t len, sapient_tcp_c
 {
     using namespace sapient_msg::bsi_flex_335_v2_0;
 
-    SapientMessage msg;
-    if (!msg.ParseFromArray(data, (int)len)) {
+    // 入站消息解析到 arena 上：初始块位于栈上，常见的 Task / RegistrationAck 解析无堆分配，
+    // 各类型处理函数按引用使用解析结果，TaskAck 也在同一 arena 上构建
+    alignas(8) char arena_block[kInboundArenaBlockSize];
+    google::protobuf::ArenaOptions arena_options;
+    arena_options.initial_block = arena_block;
+    arena_options.initial_block_size = sizeof(arena_block);
+    google::protobuf::Arena arena(arena_options);
+
+    SapientMessage *msg = google::protobuf::Arena::CreateMessage<SapientMessage>(&arena);
+    if (!msg->ParseFromArray(data, (int)len)) {
         LOGE("Failed to parse SapientMessage from received bytes\n");
         return -1;
     }
+    return sapient_dispatch_message(*msg, client);
+}
+
+} // extern "C"
+
+// 按消息类型分发已解析的 SapientMessage（各类型处理函数按引用接收子消息）
+static int sapient_dispatch_message(const sapient_msg::bsi_flex_335_v2_0::SapientMessage &msg,
+                                    sapient_tcp_client_t *client)
+{
+    using namespace sapient_msg::bsi_flex_335_v2_0;
 
     // Check message type
     SapientMessage::ContentCase content_type = msg.content_case();
     switch (content_type) {
-        case SapientMessage::kTask: {
-            LOGI("Received Sapient Task message\n");
-            // Extract Task and delegate to handler
-            const Task &task = msg.task();
-            std::string task_bin;
-            if (!task.SerializeToString(&task_bin)) {
-                LOGE("Failed to serialize Task for handler\n");
-                return -1;
-            }
-            std::string ack_bin, ack_json;
-            int action = TASK_ACTION_NONE;
-            int ret = sapient_handle_task(task_bin.data(), task_bin.size(), ack_bin, ack_json, action);
-            if (ret != 0) {
-                LOGE("sapient_handle_task failed\n");
-                return -1;
-            }
-            // Send TaskAck back
-            LOGI("Sending TaskAck:\n%s\n", ack_json.c_str());
-            if (client && client->impl) {
-                client->impl->send_pb(ack_bin.data(), ack_bin.size());
-                
-                // 根据 action 类型执行相应动作
-                if (action == TASK_ACTION_SEND_REGISTRATION) {
-                    LOGI("Task requested Registration, sending Registration report\n");
-                    sapient_tcp_client_send_register(client);
-                    // 一次性任务执行完成，清除任务ID
-                    sapient_clear_current_task_id();
-                } else if (action == TASK_ACTION_SEND_STATUS) {
-                    LOGI("Task requested Status, sending Status report\n");
-                    sapient_tcp_client_send_status_report(client);
-                    // 一次性任务执行完成，清除任务ID
-                    sapient_clear_current_task_id();
-                }
-            }
-            break;
-        }
+        case SapientMessage::kTask:
+            return handle_task_message(msg.task(), client);
         case SapientMessage::kStatusReport:
             LOGI("Received Sapient StatusReport (informational)\n");
             break;
@@ -784,24 +1513,7 @@ int sapient_parse_and_handle_message(const char *data, size_t len, sapient_tcp_c
             LOGI("Received Sapient DetectionReport (informational)\n");
             break;
         case SapientMessage::kRegistrationAck:
-            LOGI("Received Sapient RegistrationAck\n");
-            // 标记收到 RegistrationAck，停止 30 秒超时计时器
-            if (client && client->impl) {
-                client->impl->mark_registration_ack_received();
-                
-                // 根据 SAPIENT 规范：收到 RegistrationAck 后，必须发送初始状态报告
-                // "As part of system initialization, an initial status report message shall be 
-                //  sent after the registration acknowledgement message has been received. 
-                //  This shall indicate the initial state."
-                LOGI("Sending initial status report after RegistrationAck (per SAPIENT spec)\n");
-                int status_ret = client->impl->send_status_report();
-                if (status_ret != 0) {
-                    LOGE("Failed to send initial status report after RegistrationAck: %d\n", status_ret);
-                } else {
-                    LOGI("Initial status report sent successfully after RegistrationAck\n");
-                }
-            }
-            break;
+            return handle_registration_ack_message(msg.registration_ack(), client);
         case SapientMessage::kAlert:
             LOGI("Received Sapient Alert (not implemented)\n");
             break;
@@ -813,4 +1525,3 @@ int sapient_parse_and_handle_message(const char *data, size_t len, sapient_tcp_c
     return 0;
 }
 
-} // extern "C"
@@ -1,6 +1,8 @@
 /* sapient_tcp.h
  * 可扩展的 Sapient TCP 客户端 C API（底层用 C++ 实现，向 C 导出）
  * 目标：降低耦合、支持回调、持久连接与接收功能，兼容原有一次性发送接口。
+ * socket 为非阻塞模式，读、写、连接完成、重连与超时均由共享的 epoll 反应器线程
+ * （见 sapient_reactor.h）处理，一个反应器线程可服务多个客户端连接。
  */
 #ifndef SAPIENT_TCP_H
 #define SAPIENT_TCP_H
@@ -16,7 +18,7 @@ extern "C" {
 /* 不透明的客户端句柄 */
 typedef struct sapient_tcp_client_t sapient_tcp_client_t;
 
-/* 回调原型：当收到数据时由调用者提供的函数将被调用（同步或异步取决于实现）。
+/* 回调原型：当收到数据时由调用者提供的函数将被调用（在反应器线程中执行，回调内不可长时间阻塞）。
  * data/len 指向收到的原始字节（没有长度前缀），user 为用户传入的上下文指针。
  */
 typedef void (*sapient_tcp_on_message_cb)(const char *data, size_t len, void *user);
@@ -29,7 +31,9 @@ sapient_tcp_client_t *sapient_tcp_client_create(const char *host, int port);
 /* 设置收到消息时的回调 */
 void sapient_tcp_client_set_on_message(sapient_tcp_client_t *c, sapient_tcp_on_message_cb cb, void *user);
 
-/* 连接到服务器（带超时，秒），0 表示使用默认超时（5 秒） */
+/* 连接到服务器（带超时，秒），0 表示使用默认超时（5 秒）
+ * 调用线程阻塞等待连接结果，不能在回调（反应器线程）中调用。
+ */
 int sapient_tcp_client_connect(sapient_tcp_client_t *c, int timeout_sec);
 
 /* 发送原始字节（不会添加长度前缀）
@@ -37,16 +41,159 @@ int sapient_tcp_client_connect(sapient_tcp_client_t *c, int timeout_sec);
  */
 int sapient_tcp_client_send_raw(sapient_tcp_client_t *c, const void *data, size_t len);
 
-/* 发送带 length-prefix 的 protobuf 消息（会自动加 4 字节 little-endian 前缀） */
+/* 发送带 length-prefix 的 protobuf 消息（会自动加 4 字节 little-endian 前缀）
+ * 所有发送接口均为异步：组帧后放入出站队列即返回，由反应器线程负责
+ * 写 socket、断线重连与注册重发。返回 0 表示已入队，负值表示按溢出策略被丢弃。
+ */
 int sapient_tcp_client_send_pb(sapient_tcp_client_t *c, const void *data, size_t len);
 
+/* 池化帧缓冲（零拷贝发送）：
+ * 帧缓冲在消息体前预留 4 字节长度前缀空间，调用者直接把序列化结果写入
+ * sapient_frame_body()，再交给 sapient_tcp_client_send_frame() 填写前缀并入队；
+ * 前缀与消息体连续存放，反应器一次系统调用发出整帧，稳态下无堆分配。
+ */
+typedef struct sapient_frame_t sapient_frame_t;
+
+/* 申请一个消息体容量 >= body_len 的帧缓冲（优先复用池中缓冲），失败返回 NULL */
+sapient_frame_t *sapient_frame_acquire(size_t body_len);
+
+/* 获取帧缓冲的消息体写入位置及可用容量 */
+void *sapient_frame_body(sapient_frame_t *f);
+size_t sapient_frame_body_capacity(const sapient_frame_t *f);
+
+/* 归还未发送的帧缓冲（已交给 sapient_tcp_client_send_frame() 的帧不要再归还） */
+void sapient_frame_release(sapient_frame_t *f);
+
+/* 提交帧：写入 body_len 对应的长度前缀并入队。
+ * 无论成功与否，帧的所有权都转移给客户端。返回 0 表示已入队，负值表示失败或被丢弃。
+ */
+int sapient_tcp_client_send_frame(sapient_tcp_client_t *c, sapient_frame_t *f, size_t body_len);
+
+/* 出站队列溢出策略 */
+typedef enum {
+    SAPIENT_QUEUE_DROP_OLDEST = 0,   /* 丢弃最旧的帧，为新帧腾出空间（默认） */
+    SAPIENT_QUEUE_DROP_NEWEST = 1,   /* 丢弃新入队的帧 */
+    SAPIENT_QUEUE_BLOCK = 2,         /* 阻塞等待空位，超过 block_timeout_ms 后丢弃新帧 */
+} sapient_queue_overflow_policy_t;
+
+/* 配置出站队列：capacity 为最大帧数（0 表示保持不变，默认 512），
+ * block_timeout_ms 仅对 SAPIENT_QUEUE_BLOCK 生效（负值表示保持不变，默认 100ms）。
+ */
+int sapient_tcp_client_set_send_queue(sapient_tcp_client_t *c, size_t capacity,
+                                      sapient_queue_overflow_policy_t policy, int block_timeout_ms);
+
+/* 获取出站队列统计：当前排队帧数、累计丢弃帧数（任一指针可为 NULL） */
+void sapient_tcp_client_get_send_queue_stats(sapient_tcp_client_t *c, size_t *queued, unsigned long long *dropped);
+
+/* 获取检测报告合并次数：同一航迹未发送的报告被新报告原位替换的累计次数 */
+unsigned long long sapient_tcp_client_get_conflated_count(sapient_tcp_client_t *c);
+
+/* 出站优先级通道：反应器按 控制 > 告警 > 状态 > 检测 的严格优先级写出，
+ * 检测流量占满链路时 TaskAck、告警、状态报告的排队时延仍然有界。
+ * 队列满时优先淘汰低优先级通道中最旧的帧。
+ */
+typedef enum {
+    SAPIENT_TX_LANE_CONTROL = 0,     /* Registration、TaskAck 及 send_pb/send_frame 发送的帧 */
+    SAPIENT_TX_LANE_ALERT = 1,
+    SAPIENT_TX_LANE_STATUS = 2,
+    SAPIENT_TX_LANE_DETECTION = 3,
+} sapient_lane_t;
+
+/* 设置通道的防饿死权重：该通道有帧等待时，最多让更高优先级通道连续写出 max_wait 帧，
+ * 之后强制写出该通道的一帧（0 表示只按严格优先级）。默认告警 0、状态 8、检测 8；
+ * 控制通道优先级最高，不可设置。
+ */
+int sapient_tcp_client_set_lane_weight(sapient_tcp_client_t *c, sapient_lane_t lane, unsigned int max_wait);
+
+/* 获取单个通道的统计：当前排队帧数、累计写出帧数（任一指针可为 NULL） */
+void sapient_tcp_client_get_lane_stats(sapient_tcp_client_t *c, sapient_lane_t lane, size_t *queued,
+                                       unsigned long long *sent);
+
+/* 断线发件箱保存策略（注册、TaskAck 等控制帧从不保存） */
+typedef enum {
+    SAPIENT_OUTBOX_ALL = 0,            /* 保存告警、状态与检测报告 */
+    SAPIENT_OUTBOX_ALERT_STATUS = 1,   /* 只保存告警与状态报告，检测报告照常进入内存队列 */
+} sapient_outbox_policy_t;
+
+/* 启用断线存储转发发件箱：断线期间（自动重连已启动）的出站帧按策略写入内存映射的环形文件，
+ * 重连并收到 RegistrationAck（或 2 分钟内重连无需注册）后按速率上限重放。
+ * 文件大小固定为 4KB + slot_size * slot_count，写满时覆盖最旧的帧；进程重启后
+ * 上次未重放的帧仍会重放。slot_size/slot_count 为 0 时使用默认值（2048 字节 x 4096）。
+ * 超过槽位容量的帧不保存，照常进入内存队列。返回 0 成功，-1 打开文件失败。
+ */
+int sapient_tcp_client_enable_outbox(sapient_tcp_client_t *c, const char *path, size_t slot_size,
+                                     size_t slot_count, sapient_outbox_policy_t policy);
+
+/* 停用发件箱并关闭文件（未重放的帧保留在文件中） */
+void sapient_tcp_client_disable_outbox(sapient_tcp_client_t *c);
+
+/* 配置重放：frames_per_sec 为重放速率（0 表示保持不变，默认 50 帧/秒）；
+ * 产生时间早于 detection_max_age_ms 的检测报告在重放时丢弃（0 表示不过期，默认 10000ms）。
+ */
+int sapient_tcp_client_set_outbox_replay(sapient_tcp_client_t *c, unsigned int frames_per_sec,
+                                         unsigned int detection_max_age_ms);
+
+/* 获取发件箱统计：待重放帧数、累计重放数、过期丢弃数、写满覆盖数（任一指针可为 NULL） */
+void sapient_tcp_client_get_outbox_stats(sapient_tcp_client_t *c, size_t *pending, unsigned long long *replayed,
+                                         unsigned long long *expired, unsigned long long *overwritten);
+
+/* 设置出站整形速率（字节/秒、消息/秒，0 表示该维度不限），并关闭按 network_speed 自动设置。
+ * 反应器写 socket 前按令牌桶限制出队帧数与写出字节数；检测报告按整形后的链路容量
+ * 在构建前稀疏（各航迹轮流上报），不会在发送队列中积压。两者均为 0 时不限速。
+ */
+int sapient_tcp_client_set_rate_limit(sapient_tcp_client_t *c, unsigned int bytes_per_sec,
+                                      unsigned int msgs_per_sec);
+
+/* 恢复按 RadarState 状态位自动设置整形速率（默认）：
+ * network_speed（B12B11）0 不限、1 32KB/s 200 条/s、2 8KB/s 50 条/s、3 2KB/s 10 条/s；
+ * power_mode（B14B13）为低功耗时速率减半。
+ */
+int sapient_tcp_client_set_rate_limit_auto(sapient_tcp_client_t *c);
+
+/* 获取整形状态：当前生效的字节/秒、消息/秒（0 表示不限）、累计被稀疏的检测报告数（任一指针可为 NULL） */
+void sapient_tcp_client_get_rate_limit_stats(sapient_tcp_client_t *c, unsigned int *bytes_per_sec,
+                                             unsigned int *msgs_per_sec, unsigned long long *thinned);
+
+/* 入站超长帧处理策略 */
+typedef enum {
+    SAPIENT_RX_OVERSIZE_SKIP = 0,        /* 边收边丢弃该帧消息体，继续解析后续帧（默认） */
+    SAPIENT_RX_OVERSIZE_DISCONNECT = 1,  /* 视为协议错误，断开连接并按规则重连 */
+} sapient_rx_oversize_policy_t;
+
+/* 配置入站内存上限：initial_buffer 为常驻接收缓冲区大小（0 表示保持不变，默认 64KB），
+ * max_frame_len 为单帧消息体上限（0 表示保持不变，默认 4MB），接收缓冲区最多增长到单帧上限，
+ * 处理完大帧后收缩回常驻大小。
+ */
+int sapient_tcp_client_set_rx_limits(sapient_tcp_client_t *c, size_t initial_buffer, size_t max_frame_len,
+                                     sapient_rx_oversize_policy_t policy);
+
+/* 获取入站统计：累计解析帧数、超长帧数（任一指针可为 NULL） */
+void sapient_tcp_client_get_rx_stats(sapient_tcp_client_t *c, unsigned long long *frames, unsigned long long *oversized);
+
 /* 发送注册报文（调用内部的 sapient_build_registration） */
 int sapient_tcp_client_send_register(sapient_tcp_client_t *c);
 
 /* 发送基于 RadarTrackItem 的 detection report（应用层数据，0x12 消息） */
 int sapient_tcp_client_send_detection_report_from_track_item(sapient_tcp_client_t *c, const RadarTrackItem *track_item);
 
-/* 发送 status report（调用内部的 sapient_build_status_report） */
+/* 批量发送同一帧雷达数据中所有航迹的 detection report：雷达状态、任务 ID、NodeID、时间戳
+ * 每帧只获取一次，全部报告一次遍历构建、一次入队，由反应器聚合为尽量少的 sendmsg() 写出。
+ * 返回 0 表示全部入队；-1 表示参数错误，或有报告构建失败/按溢出策略被丢弃（其余报告照常发送）。
+ * 启用航位推算抑制时（sapient_track_registry.h），被抑制的报告不发送，视为成功；
+ * 出站整形限速时超出链路容量的报告同样不构建（见 sapient_tcp_client_set_rate_limit）；
+ * 各航迹的上报频率由全局预算按航迹价值分配（sapient_track_scheduler.h）。
+ */
+int sapient_tcp_client_send_detection_reports(sapient_tcp_client_t *c, const RadarTrackItem *items, size_t count);
+
+/* 为超过最大存活时间未再出现的航迹各发送一条 state="lost" 的 detection report
+ * （存活时间见 sapient_track_registry.h），供定时器周期调用。返回 0 表示成功或无丢失航迹。
+ */
+int sapient_tcp_client_send_lost_reports(sapient_tcp_client_t *c);
+
+/* 发送 status report（调用内部的 sapient_build_status_report）
+ * 状态与上次相比无变化时只发送必选字段与 INFO_UNCHANGED（紧凑心跳）；
+ * RegistrationAck 后的初始状态与 DMM 的 "Status" 任务始终发送完整报告。
+ */
 int sapient_tcp_client_send_status_report(sapient_tcp_client_t *c);
 
 /* 发送 alert report（调用内部的 sapient_build_alert_report）
@@ -54,8 +201,8 @@ int sapient_tcp_client_send_status_report(sapient_tcp_client_t *c);
  */
 int sapient_tcp_client_send_alert_report(sapient_tcp_client_t *c, const char *description, int type, int status);
 
-/* 同步接收一次数据（阻塞或带超时），返回实际收到字节数或负值错误。
- * 若实现支持回调，回调也会被触发；此函数用于同步场景。
+/* 同步接收一次数据（带超时，秒）：等待接收会话收到的下一条完整消息，返回拷贝到 buf 的字节数，
+ * 0 表示超时，负值表示错误。回调照常触发；此函数用于同步场景，不能在回调中调用。
  */
 int sapient_tcp_client_receive_once(sapient_tcp_client_t *c, void *buf, size_t buf_len, int timeout_sec);
 
@@ -65,10 +212,12 @@ void sapient_tcp_client_close(sapient_tcp_client_t *c);
 /* 销毁客户端实例（释放内存）。在调用前应先关闭连接。 */
 void sapient_tcp_client_destroy(sapient_tcp_client_t *c);
 
-/* 启动后台接收线程（建议在连接成功后调用）。返回 0 表示启动成功。 */
+/* 启动接收会话（兼容原接口名，不再创建独立线程）：由反应器读取数据并触发回调，
+ * 断线后按 10 秒间隔自动重连；尚未连接时直接进入后台重连。返回 0 表示启动成功。
+ */
 int sapient_tcp_client_start_receive_thread(sapient_tcp_client_t *c);
 
-/* 停止后台接收线程。 */
+/* 停止接收会话：停止读取与自动重连。 */
 void sapient_tcp_client_stop_receive_thread(sapient_tcp_client_t *c);
 
 /* 解析并处理收到的 SapientMessage 原始字节。
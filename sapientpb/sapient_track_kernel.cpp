@@ -0,0 +1,333 @@
+#include "sapient_track_kernel.h"
+#include <math.h>
+
+#if !defined(SAPIENT_TRACK_KERNEL_SCALAR)
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define SAPIENT_KERNEL_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#ifdef __SSE4_1__
+#include <smmintrin.h>
+#endif
+#define SAPIENT_KERNEL_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define SAPIENT_KERNEL_NEON 1
+#endif
+#endif
+
+namespace {
+
+const double kMetersPerDegree = 111000.0;   // 与区域筛选的局部平面近似一致
+const float kPi = 3.14159265358979f;
+const float kDegToRad = kPi / 180.0f;
+const float kRadToDeg = 180.0f / kPi;
+
+// ======================== 向量原语：每个平台一组，内核只用这些 ========================
+#if defined(SAPIENT_KERNEL_AVX2)
+typedef __m256 V;
+typedef __m256 M;
+const size_t kLanes = 8;
+inline V v_set(float x) { return _mm256_set1_ps(x); }
+inline V v_load(const float *p) { return _mm256_loadu_ps(p); }
+inline void v_store(float *p, V a) { _mm256_storeu_ps(p, a); }
+inline V v_add(V a, V b) { return _mm256_add_ps(a, b); }
+inline V v_sub(V a, V b) { return _mm256_sub_ps(a, b); }
+inline V v_mul(V a, V b) { return _mm256_mul_ps(a, b); }
+inline V v_div(V a, V b) { return _mm256_div_ps(a, b); }
+inline V v_min(V a, V b) { return _mm256_min_ps(a, b); }
+inline V v_max(V a, V b) { return _mm256_max_ps(a, b); }
+inline V v_sqrt(V a) { return _mm256_sqrt_ps(a); }
+inline V v_floor(V a) { return _mm256_floor_ps(a); }
+inline V v_abs(V a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+inline V v_neg(V a) { return _mm256_xor_ps(a, _mm256_set1_ps(-0.0f)); }
+inline M v_lt(V a, V b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+inline M v_gt(V a, V b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+inline M m_and(M a, M b) { return _mm256_and_ps(a, b); }
+inline V v_select(M m, V a, V b) { return _mm256_blendv_ps(b, a, m); }
+
+#elif defined(SAPIENT_KERNEL_SSE2)
+typedef __m128 V;
+typedef __m128 M;
+const size_t kLanes = 4;
+inline V v_set(float x) { return _mm_set1_ps(x); }
+inline V v_load(const float *p) { return _mm_loadu_ps(p); }
+inline void v_store(float *p, V a) { _mm_storeu_ps(p, a); }
+inline V v_add(V a, V b) { return _mm_add_ps(a, b); }
+inline V v_sub(V a, V b) { return _mm_sub_ps(a, b); }
+inline V v_mul(V a, V b) { return _mm_mul_ps(a, b); }
+inline V v_div(V a, V b) { return _mm_div_ps(a, b); }
+inline V v_min(V a, V b) { return _mm_min_ps(a, b); }
+inline V v_max(V a, V b) { return _mm_max_ps(a, b); }
+inline V v_sqrt(V a) { return _mm_sqrt_ps(a); }
+inline V v_abs(V a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+inline V v_neg(V a) { return _mm_xor_ps(a, _mm_set1_ps(-0.0f)); }
+inline M v_lt(V a, V b) { return _mm_cmplt_ps(a, b); }
+inline M v_gt(V a, V b) { return _mm_cmpgt_ps(a, b); }
+inline M m_and(M a, M b) { return _mm_and_ps(a, b); }
+#ifdef __SSE4_1__
+inline V v_floor(V a) { return _mm_floor_ps(a); }
+inline V v_select(M m, V a, V b) { return _mm_blendv_ps(b, a, m); }
+#else
+inline V v_select(M m, V a, V b) { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+// 截断取整后，对截断结果大于原值（负数）的通道减 1（输入远小于 2^31）
+inline V v_floor(V a) {
+    V t = _mm_cvtepi32_ps(_mm_cvttps_epi32(a));
+    return _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, a), _mm_set1_ps(1.0f)));
+}
+#endif
+
+#elif defined(SAPIENT_KERNEL_NEON)
+typedef float32x4_t V;
+typedef uint32x4_t M;
+const size_t kLanes = 4;
+inline V v_set(float x) { return vdupq_n_f32(x); }
+inline V v_load(const float *p) { return vld1q_f32(p); }
+inline void v_store(float *p, V a) { vst1q_f32(p, a); }
+inline V v_add(V a, V b) { return vaddq_f32(a, b); }
+inline V v_sub(V a, V b) { return vsubq_f32(a, b); }
+inline V v_mul(V a, V b) { return vmulq_f32(a, b); }
+inline V v_min(V a, V b) { return vminq_f32(a, b); }
+inline V v_max(V a, V b) { return vmaxq_f32(a, b); }
+inline V v_abs(V a) { return vabsq_f32(a); }
+inline V v_neg(V a) { return vnegq_f32(a); }
+inline M v_lt(V a, V b) { return vcltq_f32(a, b); }
+inline M v_gt(V a, V b) { return vcgtq_f32(a, b); }
+inline M m_and(M a, M b) { return vandq_u32(a, b); }
+inline V v_select(M m, V a, V b) { return vbslq_f32(m, a, b); }
+#if defined(__aarch64__)
+inline V v_div(V a, V b) { return vdivq_f32(a, b); }
+inline V v_sqrt(V a) { return vsqrtq_f32(a); }
+inline V v_floor(V a) { return vrndmq_f32(a); }
+#else
+// ARMv7 NEON 没有除法/开方/向下取整指令：倒数与平方根倒数估计各迭代两次牛顿法
+inline V v_div(V a, V b) {
+    V r = vrecpeq_f32(b);
+    r = vmulq_f32(vrecpsq_f32(b, r), r);
+    r = vmulq_f32(vrecpsq_f32(b, r), r);
+    return vmulq_f32(a, r);
+}
+inline V v_sqrt(V a) {
+    V r = vrsqrteq_f32(a);
+    r = vmulq_f32(vrsqrtsq_f32(vmulq_f32(a, r), r), r);
+    r = vmulq_f32(vrsqrtsq_f32(vmulq_f32(a, r), r), r);
+    return vbslq_f32(vcgtq_f32(a, vdupq_n_f32(0.0f)), vmulq_f32(a, r), vdupq_n_f32(0.0f));
+}
+inline V v_floor(V a) {
+    V t = vcvtq_f32_s32(vcvtq_s32_f32(a));
+    return vsubq_f32(t, vbslq_f32(vcgtq_f32(t, a), vdupq_n_f32(1.0f), vdupq_n_f32(0.0f)));
+}
+#endif
+
+#else
+typedef float V;
+typedef bool M;
+const size_t kLanes = 1;
+inline V v_set(float x) { return x; }
+inline V v_load(const float *p) { return *p; }
+inline void v_store(float *p, V a) { *p = a; }
+inline V v_add(V a, V b) { return a + b; }
+inline V v_sub(V a, V b) { return a - b; }
+inline V v_mul(V a, V b) { return a * b; }
+inline V v_div(V a, V b) { return a / b; }
+inline V v_min(V a, V b) { return a < b ? a : b; }
+inline V v_max(V a, V b) { return a > b ? a : b; }
+inline V v_sqrt(V a) { return sqrtf(a); }
+inline V v_floor(V a) { return floorf(a); }
+inline V v_abs(V a) { return fabsf(a); }
+inline V v_neg(V a) { return -a; }
+inline M v_lt(V a, V b) { return a < b; }
+inline M v_gt(V a, V b) { return a > b; }
+inline M m_and(M a, M b) { return a && b; }
+inline V v_select(M m, V a, V b) { return m ? a : b; }
+#endif
+
+// a * b + c
+inline V v_madd(V a, V b, V c) { return v_add(v_mul(a, b), c); }
+
+// 正弦/余弦（弧度）：按 π/2 归约到 [-π/4, π/4] 后用 Cephes 多项式，再按象限交换与取负
+inline void v_sincos(V x, V &s_out, V &c_out)
+{
+    V j = v_floor(v_madd(x, v_set(2.0f / kPi), v_set(0.5f)));
+    // π/2 分两段相减，减小归约误差
+    V y = v_sub(v_sub(x, v_mul(j, v_set(1.5707963705062866f))), v_mul(j, v_set(-4.37113900018624283e-8f)));
+    V q = v_sub(j, v_mul(v_floor(v_mul(j, v_set(0.25f))), v_set(4.0f)));     // 象限 0~3
+
+    V y2 = v_mul(y, y);
+    V s = v_madd(v_mul(y, y2),
+                 v_madd(v_madd(v_set(-1.9515295891e-4f), y2, v_set(8.3321608736e-3f)), y2, v_set(-1.6666654611e-1f)),
+                 y);
+    V c = v_madd(v_mul(y2, y2),
+                 v_madd(v_madd(v_set(2.443315711809948e-5f), y2, v_set(-1.388731625493765e-3f)), y2,
+                        v_set(4.166664568298827e-2f)),
+                 v_sub(v_set(1.0f), v_mul(y2, v_set(0.5f))));
+
+    // 象限 1、3 交换；正弦在象限 2、3 取负，余弦在象限 1、2 取负
+    M odd = v_gt(v_sub(q, v_mul(v_floor(v_mul(q, v_set(0.5f))), v_set(2.0f))), v_set(0.5f));
+    V sin_v = v_select(odd, c, s);
+    V cos_v = v_select(odd, s, c);
+    s_out = v_select(v_gt(q, v_set(1.5f)), v_neg(sin_v), sin_v);
+    c_out = v_select(m_and(v_gt(q, v_set(0.5f)), v_lt(q, v_set(2.5f))), v_neg(cos_v), cos_v);
+}
+
+// atan2（弧度）：先在 [0, 1] 上用 Abramowitz-Stegun 4.4.49 多项式（误差 < 2e-8），再按象限还原
+inline V v_atan2(V y, V x)
+{
+    V ax = v_abs(x);
+    V ay = v_abs(y);
+    V t = v_div(v_min(ax, ay), v_max(v_max(ax, ay), v_set(1e-30f)));
+    V t2 = v_mul(t, t);
+    V p = v_set(0.0028662257f);
+    p = v_madd(p, t2, v_set(-0.0161657367f));
+    p = v_madd(p, t2, v_set(0.0429096138f));
+    p = v_madd(p, t2, v_set(-0.0752896400f));
+    p = v_madd(p, t2, v_set(0.1065626393f));
+    p = v_madd(p, t2, v_set(-0.1420889944f));
+    p = v_madd(p, t2, v_set(0.1999355085f));
+    p = v_madd(p, t2, v_set(-0.3333314528f));
+    V r = v_madd(v_mul(p, t2), t, t);
+    r = v_select(v_gt(ay, ax), v_sub(v_set(kPi / 2.0f), r), r);
+    r = v_select(v_lt(x, v_set(0.0f)), v_sub(v_set(kPi), r), r);
+    return v_select(v_lt(y, v_set(0.0f)), v_neg(r), r);
+}
+
+inline V v_clamp(V x, float limit)
+{
+    return v_min(v_max(x, v_set(-limit)), v_set(limit));
+}
+
+// 接近 0 的速度分量取 0.001（与逐条构建时的处理一致）
+inline V v_nonzero(V x)
+{
+    return v_select(v_lt(v_abs(x), v_set(0.0001f)), v_set(0.001f), x);
+}
+
+} // namespace
+
+size_t SapientTrackBatch::lanes()
+{
+    return kLanes;
+}
+
+void SapientTrackBatch::run_kernel(const FrameTerms &terms, size_t padded,
+                                   const float *az, const float *el, const float *range,
+                                   const float *vx, const float *vy, const float *vz,
+                                   float *bearing, float *elevation, float *d_lon, float *d_lat, float *d_alt,
+                                   float *east, float *north, float *up)
+{
+    const V fwd0 = v_set(terms.fwd[0]), fwd1 = v_set(terms.fwd[1]), fwd2 = v_set(terms.fwd[2]);
+    const V rgt0 = v_set(terms.right[0]), rgt1 = v_set(terms.right[1]), rgt2 = v_set(terms.right[2]);
+    const V up0 = v_set(terms.up[0]), up1 = v_set(terms.up[1]), up2 = v_set(terms.up[2]);
+    const V lat_per_m = v_set(terms.lat_per_m);
+    const V lon_per_m = v_set(terms.lon_per_m);
+    const V deg = v_set(kDegToRad);
+    const V rad = v_set(kRadToDeg);
+
+    for (size_t i = 0; i < padded; i += kLanes) {
+        V sa, ca, se, ce;
+        v_sincos(v_mul(v_load(az + i), deg), sa, ca);
+        v_sincos(v_mul(v_load(el + i), deg), se, ce);
+
+        // 雷达坐标系（前、右、上）单位视线向量 → ENU
+        V f = v_mul(ce, ca);
+        V r = v_mul(ce, sa);
+        V e_u = v_madd(f, fwd0, v_madd(r, rgt0, v_mul(se, up0)));
+        V n_u = v_madd(f, fwd1, v_madd(r, rgt1, v_mul(se, up1)));
+        V u_u = v_madd(f, fwd2, v_madd(r, rgt2, v_mul(se, up2)));
+
+        // 真北方位归一化到 [0, 360)
+        V b = v_mul(v_atan2(e_u, n_u), rad);
+        b = v_sub(b, v_mul(v_floor(v_mul(b, v_set(1.0f / 360.0f))), v_set(360.0f)));
+        b = v_select(v_lt(b, v_set(360.0f)), b, v_sub(b, v_set(360.0f)));
+        v_store(bearing + i, b);
+        v_store(elevation + i, v_mul(v_atan2(u_u, v_sqrt(v_madd(e_u, e_u, v_mul(n_u, n_u)))), rad));
+
+        V rg = v_load(range + i);
+        v_store(d_lon + i, v_mul(v_mul(rg, e_u), lon_per_m));
+        v_store(d_lat + i, v_mul(v_mul(rg, n_u), lat_per_m));
+        v_store(d_alt + i, v_mul(rg, u_u));
+
+        // NWU → ENU：东 = -西，北、天不变
+        v_store(east + i, v_nonzero(v_clamp(v_neg(v_load(vy + i)), kMaxVelocity)));
+        v_store(north + i, v_nonzero(v_clamp(v_load(vx + i), kMaxVelocity)));
+        v_store(up + i, v_clamp(v_load(vz + i), kMaxVelocity));
+    }
+}
+
+void SapientTrackBatch::resize(size_t count)
+{
+    size_t padded = (count + kLanes - 1) / kLanes * kLanes;
+    std::vector<float> *arrays[] = { &az_, &el_, &range_, &vx_, &vy_, &vz_,
+                                     &track_lon_, &track_lat_, &track_alt_,
+                                     &bearing_, &elevation_, &d_lon_, &d_lat_, &d_alt_,
+                                     &east_rate_, &north_rate_, &up_rate_ };
+    for (size_t k = 0; k < sizeof(arrays) / sizeof(arrays[0]); k++) {
+        arrays[k]->resize(padded);
+    }
+    track_pos_.resize(padded);
+    // 补齐部分清零，避免对上一帧残留数据做无意义的计算
+    for (size_t i = count; i < padded; i++) {
+        az_[i] = el_[i] = range_[i] = vx_[i] = vy_[i] = vz_[i] = 0.0f;
+    }
+}
+
+void SapientTrackBatch::convert(const RadarTrackItem *items, size_t count, const SapientPlatformPose &pose)
+{
+    count_ = items ? count : 0;
+    pose_ = pose;
+    resize(count_);
+
+    // 按字段拆成结构数组
+    for (size_t i = 0; i < count_; i++) {
+        const RadarTrackItem &item = items[i];
+        az_[i] = item.azimuth;
+        el_[i] = item.elevation;
+        range_[i] = item.range;
+        vx_[i] = item.vx;
+        vy_[i] = item.vy;
+        vz_[i] = item.vz;
+        track_lon_[i] = item.longitude;
+        track_lat_[i] = item.latitude;
+        track_alt_[i] = item.altitude;
+        track_pos_[i] = (item.longitude != 0.0f || item.latitude != 0.0f);
+    }
+
+    // 平台姿态：水平时雷达前向为航向方向；先绕右轴抬头（俯仰），再绕前向右倾（横滚）
+    FrameTerms terms;
+    double h = pose.heading * M_PI / 180.0;
+    double p = pose.pitch * M_PI / 180.0;
+    double r = pose.roll * M_PI / 180.0;
+    double level_fwd[3] = { sin(h), cos(h), 0.0 };
+    double level_right[3] = { cos(h), -sin(h), 0.0 };
+    for (int k = 0; k < 3; k++) {
+        double level_up = (k == 2) ? 1.0 : 0.0;
+        double fwd = cos(p) * level_fwd[k] + sin(p) * level_up;
+        double up = -sin(p) * level_fwd[k] + cos(p) * level_up;
+        terms.fwd[k] = (float)fwd;
+        terms.right[k] = (float)(cos(r) * level_right[k] - sin(r) * up);
+        terms.up[k] = (float)(sin(r) * level_right[k] + cos(r) * up);
+    }
+    terms.lat_per_m = (float)(1.0 / kMetersPerDegree);
+    terms.lon_per_m = (float)(1.0 / (kMetersPerDegree * cos(pose.latitude * M_PI / 180.0)));
+
+    run_kernel(terms, az_.size(), az_.data(), el_.data(), range_.data(), vx_.data(), vy_.data(), vz_.data(),
+               bearing_.data(), elevation_.data(), d_lon_.data(), d_lat_.data(), d_alt_.data(),
+               east_rate_.data(), north_rate_.data(), up_rate_.data());
+}
+
+bool SapientTrackBatch::position(size_t i, double *longitude, double *latitude, double *altitude) const
+{
+    if (i >= count_) return false;
+    if (track_pos_[i]) {
+        if (longitude) *longitude = track_lon_[i];
+        if (latitude) *latitude = track_lat_[i];
+        if (altitude) *altitude = track_alt_[i];
+        return true;
+    }
+    if (!pose_.has_lla || range_[i] <= 0.0f) return false;
+    if (longitude) *longitude = pose_.longitude + d_lon_[i];
+    if (latitude) *latitude = pose_.latitude + d_lat_[i];
+    if (altitude) *altitude = pose_.altitude + d_alt_[i];
+    return true;
+}
@@ -0,0 +1,101 @@
+/*****************************************************************************
+ * Copyright (c) 2023-2025
+ * Skyfend Technology Co., Ltd
+ *
+ * All rights reserved. Any unauthorized disclosure or publication of the
+ * confidential and proprietary information to any other party will constitute
+ * an infringement of copyright laws.
+ *
+ * @file    sapient_track_kernel.h
+ * @brief   一帧航迹的批量坐标转换（SoA + SIMD）
+ * @details 检测报告构建前，把一帧航迹的方位/仰角/距离与 NWU 速度按字段拷贝为结构数组（SoA），
+ *          一次遍历完成：按平台姿态（航向/俯仰/横滚）旋转到 ENU，得到真北方位与相对水平面的仰角；
+ *          由雷达经纬高与 ENU 偏移推算航迹经纬高（局部平面近似）；NWU → ENU 速度转换与限幅。
+ *          姿态旋转矩阵与经纬度换算系数每帧只计算一次。
+ *          向量宽度按编译目标选择：AVX2 8 路、SSE2/NEON 4 路，其余平台（或定义
+ *          SAPIENT_TRACK_KERNEL_SCALAR 时）逐条标量计算，结果一致（三角函数为 float 精度多项式近似）。
+ *****************************************************************************
+ */
+#ifndef __SAPIENT_TRACK_KERNEL_H_
+#define __SAPIENT_TRACK_KERNEL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include "../../common/nanopb/radar.pb.h"
+
+// 每帧一份的平台位姿
+struct SapientPlatformPose {
+    double heading;     // 航向角（相对于正北，度）
+    double pitch;       // 俯仰角（抬头为正，度）
+    double roll;        // 横滚角（右倾为正，度）
+    bool has_lla;       // 雷达位置是否有效
+    double longitude;
+    double latitude;
+    double altitude;
+};
+
+class SapientTrackBatch {
+public:
+    // 速度限幅（m/s，RadarTrackItem 规范的速度范围）
+    static constexpr float kMaxVelocity = 100.0f;
+
+    /**
+     * @brief 转换一帧航迹（覆盖上一帧的结果，缓冲区复用）
+     * @param items 航迹
+     * @param count 航迹数
+     * @param pose  本帧平台位姿
+     */
+    void convert(const RadarTrackItem *items, size_t count, const SapientPlatformPose &pose);
+
+    size_t size() const { return count_; }
+
+    // 真北方位角 [0, 360)、相对水平面的仰角（度）
+    float bearing(size_t i) const { return bearing_[i]; }
+    float elevation(size_t i) const { return elevation_[i]; }
+
+    /**
+     * @brief 航迹位置：航迹自带经纬度时原样返回，否则由雷达位置与距离/方位推算
+     * @return false 无法得到位置（航迹无经纬度且雷达位置无效或距离无效）
+     */
+    bool position(size_t i, double *longitude, double *latitude, double *altitude) const;
+
+    // ENU 速度（m/s），已限幅到 ±kMaxVelocity；东/北向接近 0 时取 0.001，避免字段为空
+    float east_rate(size_t i) const { return east_rate_[i]; }
+    float north_rate(size_t i) const { return north_rate_[i]; }
+    float up_rate(size_t i) const { return up_rate_[i]; }
+
+    // 本平台的向量宽度（1 表示标量实现）
+    static size_t lanes();
+
+private:
+    // 每帧预计算的转换参数
+    struct FrameTerms {
+        float fwd[3];       // 雷达坐标轴（前、右、上）在 ENU 中的方向
+        float right[3];
+        float up[3];
+        float lat_per_m;    // 北向 1 米对应的纬度差
+        float lon_per_m;    // 东向 1 米对应的经度差
+    };
+
+    void resize(size_t count);
+    static void run_kernel(const FrameTerms &terms, size_t padded,
+                           const float *az, const float *el, const float *range,
+                           const float *vx, const float *vy, const float *vz,
+                           float *bearing, float *elevation, float *d_lon, float *d_lat, float *d_alt,
+                           float *east, float *north, float *up);
+
+    size_t count_ = 0;
+    SapientPlatformPose pose_ = SapientPlatformPose();
+    // 输入（SoA，长度按向量宽度补齐，补齐部分为 0）
+    std::vector<float> az_, el_, range_, vx_, vy_, vz_;
+    // 航迹自带的经纬高（track_pos_ 为 0 时无效）
+    std::vector<float> track_lon_, track_lat_, track_alt_;
+    std::vector<uint8_t> track_pos_;
+    // 输出
+    std::vector<float> bearing_, elevation_;
+    std::vector<float> d_lon_, d_lat_, d_alt_;    // 相对雷达位置的偏移（度、度、米）
+    std::vector<float> east_rate_, north_rate_, up_rate_;
+};
+
+#endif /* __SAPIENT_TRACK_KERNEL_H_ */
@@ -0,0 +1,257 @@
+#include "sapient_track_registry.h"
+#include <string.h>
+#include <math.h>
+
+// 日志模块
+#define LOG_TAG "sapient_track"
+
+extern "C" {
+    #include "../../common/zlog/skyfend_log.h"
+}
+
+#define LOGI(format, ...) radar_log_info(format, ##__VA_ARGS__)
+#define LOGE(format, ...) radar_log_error(format, ##__VA_ARGS__)
+
+#include "sapient_ulid.h"
+
+SapientTrackRegistry &SapientTrackRegistry::instance()
+{
+    static SapientTrackRegistry *registry = new SapientTrackRegistry();
+    return *registry;
+}
+
+SapientTrackRegistry::SapientTrackRegistry()
+    : size_(0), max_age_ms_(kDefaultMaxAgeMs), evicted_(0),
+      dr_enabled_(false), dr_max_error_m_(10.0), dr_max_silence_ms_(kDefaultMaxSilenceMs),
+      emitted_(0), suppressed_(0)
+{
+    memset(slots_, 0, sizeof(slots_));
+    pending_lost_.reserve(16);
+}
+
+size_t SapientTrackRegistry::hash_slot(uint32_t track_id)
+{
+    // Fibonacci 哈希：雷达航迹 ID 通常连续递增，乘法散列后分布均匀
+    return (size_t)((track_id * 2654435769u) >> 22) & (kCapacity - 1);
+}
+
+// 航位推算判定（持锁调用）：需要上报时以本次数据更新推算基准
+bool SapientTrackRegistry::should_report_locked(Slot &slot, const RadarTrackItem &item,
+                                                int64_t now_ms, bool is_new)
+{
+    const bool has_location = (item.longitude != 0.0f || item.latitude != 0.0f);
+    ReportedState &ref = slot.reported;
+
+    bool report = is_new || !dr_enabled_ || !has_location ||
+                  (ref.lon == 0.0 && ref.lat == 0.0) ||
+                  now_ms - ref.report_ms >= dr_max_silence_ms_;
+    if (!report) {
+        // 以上次上报位置为原点的局部平面近似（航迹间隔内位移很小，误差可忽略）
+        const double METERS_PER_DEGREE = 111000.0;
+        const double dt = (double)(now_ms - ref.report_ms) / 1000.0;
+        const double de = (item.longitude - ref.lon) * METERS_PER_DEGREE * cos(ref.lat * M_PI / 180.0);
+        const double dn = (item.latitude - ref.lat) * METERS_PER_DEGREE;
+        const double du = item.altitude - ref.alt;
+        const double ee = de - ref.east * dt;
+        const double en = dn - ref.north * dt;
+        const double eu = du - ref.up * dt;
+        report = ee * ee + en * en + eu * eu > dr_max_error_m_ * dr_max_error_m_;
+    }
+
+    if (!report) {
+        suppressed_++;
+        return false;
+    }
+
+    // 与 DetectionReport 中的 ENU 速度一致：RadarTrackItem 为北西天（vx 北、vy 西、vz 天）
+    ref.report_ms = now_ms;
+    ref.lon = item.longitude;
+    ref.lat = item.latitude;
+    ref.alt = item.altitude;
+    ref.east = -item.vy;
+    ref.north = item.vx;
+    ref.up = item.vz;
+    emitted_++;
+    return true;
+}
+
+bool SapientTrackRegistry::acquire(const RadarTrackItem &item, int64_t now_ms, char object_id[27])
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    size_t idx = hash_slot(item.id);
+    while (slots_[idx].used) {
+        if (slots_[idx].track_id == item.id) {
+            Slot &slot = slots_[idx];
+            slot.last_seen_ms = now_ms;
+            slot.last_item = item;
+            memcpy(object_id, slot.object_id, sizeof(slot.object_id));
+            return should_report_locked(slot, item, now_ms, false);
+        }
+        idx = (idx + 1) & (kCapacity - 1);
+    }
+
+    // 新航迹：表满时先淘汰最久未出现的航迹（淘汰会移动槽位，需重新探测空位）
+    if (size_ >= kMaxTracks) {
+        evict_oldest_locked();
+        idx = hash_slot(item.id);
+        while (slots_[idx].used) {
+            idx = (idx + 1) & (kCapacity - 1);
+        }
+    }
+
+    Slot &slot = slots_[idx];
+    slot.used = true;
+    slot.track_id = item.id;
+    slot.last_seen_ms = now_ms;
+    slot.last_item = item;
+    sapient_ulid_generate(slot.object_id);
+    size_++;
+    memcpy(object_id, slot.object_id, sizeof(slot.object_id));
+    return should_report_locked(slot, item, now_ms, true);
+}
+
+bool SapientTrackRegistry::touch(const RadarTrackItem &item, int64_t now_ms)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    size_t idx = hash_slot(item.id);
+    while (slots_[idx].used) {
+        if (slots_[idx].track_id == item.id) {
+            slots_[idx].last_seen_ms = now_ms;
+            slots_[idx].last_item = item;
+            return true;
+        }
+        idx = (idx + 1) & (kCapacity - 1);
+    }
+    return false;
+}
+
+// 后移删除：把后续同一探测链上的元素前移，保证线性探测查找不断链
+void SapientTrackRegistry::erase_slot_locked(size_t idx)
+{
+    slots_[idx].used = false;
+    size_--;
+    size_t hole = idx;
+    size_t next = (idx + 1) & (kCapacity - 1);
+    while (slots_[next].used) {
+        size_t home = hash_slot(slots_[next].track_id);
+        // home 不在 (hole, next] 区间内时，该元素可以前移到空洞处
+        bool movable = (hole <= next) ? (home <= hole || home > next)
+                                      : (home <= hole && home > next);
+        if (movable) {
+            slots_[hole] = slots_[next];
+            slots_[next].used = false;
+            hole = next;
+        }
+        next = (next + 1) & (kCapacity - 1);
+    }
+}
+
+size_t SapientTrackRegistry::evict_oldest_locked()
+{
+    size_t oldest = kCapacity;
+    for (size_t i = 0; i < kCapacity; i++) {
+        if (slots_[i].used && (oldest == kCapacity || slots_[i].last_seen_ms < slots_[oldest].last_seen_ms)) {
+            oldest = i;
+        }
+    }
+    if (oldest == kCapacity) return 0;
+
+    // 积压的 lost 报告同样有上限（定时器停止时不让内存增长）
+    if (pending_lost_.size() < kMaxTracks) {
+        SapientLostTrack lost;
+        memcpy(lost.object_id, slots_[oldest].object_id, sizeof(lost.object_id));
+        lost.last_item = slots_[oldest].last_item;
+        pending_lost_.push_back(lost);
+    }
+    LOGI("track registry full, evicting track %u\n", slots_[oldest].track_id);
+    erase_slot_locked(oldest);
+    evicted_++;
+    return 1;
+}
+
+size_t SapientTrackRegistry::collect_lost(int64_t now_ms, std::vector<SapientLostTrack> &out)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t n = pending_lost_.size();
+    out.insert(out.end(), pending_lost_.begin(), pending_lost_.end());
+    pending_lost_.clear();
+
+    if (size_ == 0) return n;
+    for (size_t i = 0; i < kCapacity; ) {
+        Slot &slot = slots_[i];
+        if (slot.used && now_ms - slot.last_seen_ms > max_age_ms_) {
+            SapientLostTrack lost;
+            memcpy(lost.object_id, slot.object_id, sizeof(lost.object_id));
+            lost.last_item = slot.last_item;
+            out.push_back(lost);
+            erase_slot_locked(i);
+            evicted_++;
+            n++;
+            continue;   // 后移删除可能把后面的元素移到了 i，重新检查当前槽位
+        }
+        i++;
+    }
+    return n;
+}
+
+void SapientTrackRegistry::set_max_age(unsigned int max_age_ms)
+{
+    if (max_age_ms == 0) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    max_age_ms_ = max_age_ms;
+}
+
+void SapientTrackRegistry::get_stats(size_t *active, uint64_t *evicted)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (active) *active = size_;
+    if (evicted) *evicted = evicted_;
+}
+
+void SapientTrackRegistry::set_dead_reckoning(bool enable, double max_error_m, unsigned int max_silence_ms)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    dr_enabled_ = enable;
+    if (max_error_m > 0.0) dr_max_error_m_ = max_error_m;
+    if (max_silence_ms > 0) dr_max_silence_ms_ = max_silence_ms;
+    LOGI("dead reckoning %s: max error %.1fm, max silence %lldms\n",
+         dr_enabled_ ? "enabled" : "disabled", dr_max_error_m_, (long long)dr_max_silence_ms_);
+}
+
+void SapientTrackRegistry::get_report_stats(uint64_t *emitted, uint64_t *suppressed)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (emitted) *emitted = emitted_;
+    if (suppressed) *suppressed = suppressed_;
+}
+
+extern "C" {
+
+void sapient_track_registry_set_max_age(unsigned int max_age_ms)
+{
+    SapientTrackRegistry::instance().set_max_age(max_age_ms);
+}
+
+void sapient_track_registry_get_stats(size_t *active, unsigned long long *evicted)
+{
+    uint64_t n = 0;
+    SapientTrackRegistry::instance().get_stats(active, &n);
+    if (evicted) *evicted = (unsigned long long)n;
+}
+
+void sapient_track_registry_set_dead_reckoning(int enable, double max_error_m, unsigned int max_silence_ms)
+{
+    SapientTrackRegistry::instance().set_dead_reckoning(enable != 0, max_error_m, max_silence_ms);
+}
+
+void sapient_track_registry_get_report_stats(unsigned long long *emitted, unsigned long long *suppressed)
+{
+    uint64_t e = 0, s = 0;
+    SapientTrackRegistry::instance().get_report_stats(&e, &s);
+    if (emitted) *emitted = (unsigned long long)e;
+    if (suppressed) *suppressed = (unsigned long long)s;
+}
+
+} // extern "C"
@@ -0,0 +1,135 @@
+/*****************************************************************************
+ * Copyright (c) 2023-2025
+ * Skyfend Technology Co., Ltd
+ *
+ * All rights reserved. Any unauthorized disclosure or publication of the
+ * confidential and proprietary information to any other party will constitute
+ * an infringement of copyright laws.
+ *
+ * @file    sapient_track_registry.h
+ * @brief   雷达航迹 ID → SAPIENT object_id 映射表
+ * @details 固定容量的开放寻址哈希表（线性探测、后移删除，无墓碑），ULID 内联存放在槽位中，
+ *          长时间运行内存恒定。超过最大存活时间未再出现的航迹被淘汰，淘汰时保留最后一次的
+ *          航迹数据，用于发送一条 state="lost" 的 DetectionReport，让 DMM 立即删除该目标。
+ *          可选的航位推算抑制：按上次上报的位置和 ENU 速度外推，外推误差在阈值内的
+ *          报告不发送（DMM 同样按速度外推），超过最长静默时间时强制上报一次。
+ *****************************************************************************
+ */
+#ifndef __SAPIENT_TRACK_REGISTRY_H_
+#define __SAPIENT_TRACK_REGISTRY_H_
+
+#include <stddef.h>
+#include "../../common/nanopb/radar.pb.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 配置航迹最大存活时间（毫秒，0 表示保持不变，默认 3000ms）：超过该时间未出现的航迹视为丢失 */
+void sapient_track_registry_set_max_age(unsigned int max_age_ms);
+
+/* 获取映射表统计：当前航迹数、累计淘汰数（任一指针可为 NULL） */
+void sapient_track_registry_get_stats(size_t *active, unsigned long long *evicted);
+
+/* 配置航位推算抑制（默认关闭）
+ * enable:         非 0 启用
+ * max_error_m:    外推位置与实际位置的最大允许误差（米，<= 0 表示保持不变，默认 10m）
+ * max_silence_ms: 同一航迹最长连续抑制时间（毫秒，0 表示保持不变，默认 1000ms）
+ * 仅对带经纬度的航迹生效；新航迹的第一条报告总是发送
+ */
+void sapient_track_registry_set_dead_reckoning(int enable, double max_error_m, unsigned int max_silence_ms);
+
+/* 获取航位推算统计：累计发送、累计抑制的报告数（任一指针可为 NULL） */
+void sapient_track_registry_get_report_stats(unsigned long long *emitted, unsigned long long *suppressed);
+
+#ifdef __cplusplus
+}
+
+#include <stdint.h>
+#include <mutex>
+#include <vector>
+
+// 被淘汰的航迹：用于构建最后一条 "lost" 报告
+struct SapientLostTrack {
+    char object_id[27];
+    RadarTrackItem last_item;
+};
+
+class SapientTrackRegistry {
+public:
+    static const size_t kCapacity = 1024;        // 槽位数（2 的幂）
+    static const size_t kMaxTracks = 768;        // 负载因子上限 0.75
+    static const unsigned int kDefaultMaxAgeMs = 3000;
+    static const unsigned int kDefaultMaxSilenceMs = 1000;
+
+    static SapientTrackRegistry &instance();
+
+    /**
+     * @brief 查找或登记航迹，返回其 object_id（新航迹生成新的 ULID）
+     * @param item             本次上报的航迹数据（记录为最后一次数据）
+     * @param now_ms           单调时钟毫秒
+     * @param[out] object_id   27 字节缓冲区（含结尾 '\0'）
+     * @return true 需要发送本次报告；false 航位推算外推误差在阈值内，本次报告被抑制
+     * @note 表满时淘汰最久未出现的航迹腾出槽位，该航迹同样会收到 "lost" 报告
+     */
+    bool acquire(const RadarTrackItem &item, int64_t now_ms, char object_id[27]);
+
+    /**
+     * @brief 刷新已登记航迹的存活时间与最后数据，不生成报告（链路容量不足被稀疏的航迹）
+     * @return true 航迹已登记；false 未登记（不新建，留待下次实际上报时登记）
+     */
+    bool touch(const RadarTrackItem &item, int64_t now_ms);
+
+    /**
+     * @brief 淘汰超过最大存活时间未出现的航迹
+     * @param now_ms 单调时钟毫秒
+     * @param[out] out 追加被淘汰的航迹（含容量淘汰积压的航迹）
+     * @return 本次取出的航迹数
+     */
+    size_t collect_lost(int64_t now_ms, std::vector<SapientLostTrack> &out);
+
+    void set_max_age(unsigned int max_age_ms);
+    void get_stats(size_t *active, uint64_t *evicted);
+    void set_dead_reckoning(bool enable, double max_error_m, unsigned int max_silence_ms);
+    void get_report_stats(uint64_t *emitted, uint64_t *suppressed);
+
+private:
+    SapientTrackRegistry();
+
+    // 最后一次实际上报的位置与 ENU 速度（航位推算基准）
+    struct ReportedState {
+        int64_t report_ms;
+        double lon, lat, alt;         // 度、度、米
+        double east, north, up;      // m/s
+    };
+
+    struct Slot {
+        bool used;
+        uint32_t track_id;
+        int64_t last_seen_ms;
+        char object_id[27];
+        RadarTrackItem last_item;
+        ReportedState reported;
+    };
+
+    static size_t hash_slot(uint32_t track_id);
+    bool should_report_locked(Slot &slot, const RadarTrackItem &item, int64_t now_ms, bool is_new);
+    void erase_slot_locked(size_t idx);
+    size_t evict_oldest_locked();
+
+    std::mutex mutex_;
+    Slot slots_[kCapacity];
+    size_t size_;
+    int64_t max_age_ms_;
+    uint64_t evicted_;
+    bool dr_enabled_;
+    double dr_max_error_m_;
+    int64_t dr_max_silence_ms_;
+    uint64_t emitted_;
+    uint64_t suppressed_;
+    std::vector<SapientLostTrack> pending_lost_;   // 容量淘汰的航迹，下次 collect_lost() 时取出
+};
+
+#endif /* __cplusplus */
+
+#endif /* __SAPIENT_TRACK_REGISTRY_H_ */
@@ -0,0 +1,215 @@
+#include "sapient_track_scheduler.h"
+#include <math.h>
+#include <algorithm>
+
+// 日志模块
+#define LOG_TAG "sapient_sched"
+
+extern "C" {
+    #include "../../common/zlog/skyfend_log.h"
+}
+
+#define LOGI(format, ...) radar_log_info(format, ##__VA_ARGS__)
+#define LOGE(format, ...) radar_log_error(format, ##__VA_ARGS__)
+
+// 尚未上报过的航迹的"已等待时间"：保证新航迹排在最前
+static const double kNeverReportedElapsedMs = 1e12;
+// 超过该时间未出现的航迹从调度表中移除（航迹本身的丢失判定见 sapient_track_registry.h）
+static const int64_t kPruneAgeMs = 10 * 1000;
+static const int64_t kPruneIntervalMs = 1000;
+// 额度上限：被推迟的航迹之后最多连续补发一次，不会突发占满预算
+static const double kMaxCredit = 2.0;
+
+SapientTrackScheduler &SapientTrackScheduler::instance()
+{
+    static SapientTrackScheduler *scheduler = new SapientTrackScheduler();
+    return *scheduler;
+}
+
+SapientTrackScheduler::SapientTrackScheduler()
+    : budget_(0), max_interval_ms_(kDefaultMaxIntervalMs),
+      confirmed_weight_(1.0f), tentative_weight_(0.3f),
+      range_ref_m_(1000.0f), closing_ref_mps_(10.0f),
+      last_prune_ms_(0), scheduled_(0), deferred_(0)
+{
+    // 未识别、无人机、单兵、车辆、鸟类、直升机、其它
+    static const float kDefaultClassWeight[kClassCount] = { 0.5f, 2.0f, 1.0f, 1.0f, 0.2f, 1.5f, 0.5f };
+    for (size_t i = 0; i < kClassCount; i++) {
+        class_weight_[i] = kDefaultClassWeight[i];
+    }
+    tracks_.reserve(256);
+}
+
+// 航迹权重（持锁调用）：状态 × 分类 × 距离 × 接近速度
+double SapientTrackScheduler::weight_locked(const RadarTrackItem &item) const
+{
+    double w = (item.state_type == 1) ? confirmed_weight_ : tentative_weight_;
+    w *= class_weight_[item.classification < kClassCount - 1 ? item.classification : kClassCount - 1];
+
+    if (item.range > 0.0f) {
+        w *= 1.0 + range_ref_m_ / (item.range + range_ref_m_);
+    }
+
+    // 径向速度为负表示靠近；雷达已判定运动类型时以其为准（3 靠近、4 远离）
+    double closing = 0.0;
+    if (item.motionType == 3) {
+        closing = fabs(item.velocity);
+    } else if (item.motionType != 4 && item.velocity < 0.0f) {
+        closing = -item.velocity;
+    }
+    w *= std::min(1.0 + closing / closing_ref_mps_, 3.0);
+    return w;
+}
+
+// 移除长时间未出现的航迹（持锁调用）
+void SapientTrackScheduler::prune_locked(int64_t now_ms)
+{
+    if (now_ms - last_prune_ms_ < kPruneIntervalMs) return;
+    last_prune_ms_ = now_ms;
+    for (auto it = tracks_.begin(); it != tracks_.end();) {
+        if (now_ms - it->second.last_seen_ms > kPruneAgeMs) it = tracks_.erase(it);
+        else ++it;
+    }
+}
+
+size_t SapientTrackScheduler::schedule(const RadarTrackItem *items, size_t count, int64_t now_ms,
+                                       size_t max_reports, std::vector<uint8_t> &selected)
+{
+    selected.assign(count, 0);
+    if (!items || count == 0) return 0;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    prune_locked(now_ms);
+
+    weights_.resize(count);
+    double weight_sum = 0.0;
+    for (size_t i = 0; i < count; i++) {
+        weights_[i] = weight_locked(items[i]);
+        weight_sum += weights_[i];
+    }
+
+    // 有预算时各航迹按权重分得上报速率 budget * w / sum(w)，按帧间隔累计额度，额度满 1 即到期；
+    // 不限预算时每帧都到期，紧迫度为加权的已等待时间（链路容量不足时按权重轮转）
+    candidates_.clear();
+    for (size_t i = 0; i < count; i++) {
+        auto ins = tracks_.emplace(items[i].id, Entry{-1, -1, now_ms, 0.0, 0.0});
+        Entry &entry = ins.first->second;
+        int64_t dt = now_ms - entry.last_seen_ms;
+        entry.last_seen_ms = now_ms;
+        double elapsed = (entry.last_report_ms < 0) ? kNeverReportedElapsedMs
+                                                    : (double)(now_ms - entry.last_report_ms);
+        double urgency;
+        if (budget_ > 0) {
+            if (weights_[i] > 0.0) {
+                double interval = 1000.0 * weight_sum / ((double)budget_ * weights_[i]);
+                entry.credit = std::min(entry.credit + (double)dt / interval, kMaxCredit);
+            }
+            bool silent_too_long = elapsed >= (double)max_interval_ms_;
+            if (entry.credit < 1.0 && !silent_too_long) continue;
+            urgency = silent_too_long ? elapsed : entry.credit;
+        } else {
+            urgency = (elapsed + 1.0) * weights_[i];
+        }
+        candidates_.push_back(Candidate{urgency, i});
+    }
+
+    size_t n = candidates_.size();
+    if (n > max_reports) {
+        std::nth_element(candidates_.begin(), candidates_.begin() + max_reports, candidates_.end(),
+                         [](const Candidate &a, const Candidate &b) { return a.urgency > b.urgency; });
+        n = max_reports;
+    }
+    for (size_t k = 0; k < n; k++) {
+        size_t i = candidates_[k].index;
+        selected[i] = 1;
+        Entry &entry = tracks_[items[i].id];
+        entry.prev_report_ms = entry.last_report_ms;
+        entry.prev_credit = entry.credit;
+        entry.last_report_ms = now_ms;
+        entry.credit = std::max(entry.credit - 1.0, 0.0);
+    }
+    scheduled_ += n;
+    deferred_ += count - n;
+    return n;
+}
+
+void SapientTrackScheduler::unschedule(uint32_t track_id)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = tracks_.find(track_id);
+    if (it == tracks_.end() || it->second.last_report_ms == it->second.prev_report_ms) return;
+    Entry &entry = it->second;
+    entry.last_report_ms = entry.prev_report_ms;
+    entry.credit = entry.prev_credit;
+    if (scheduled_ > 0) scheduled_--;
+    deferred_++;
+}
+
+void SapientTrackScheduler::set_budget(unsigned int msgs_per_sec, unsigned int max_interval_ms)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    budget_ = msgs_per_sec;
+    if (max_interval_ms > 0) max_interval_ms_ = max_interval_ms;
+    LOGI("track report budget: %u msgs/s, max interval %lldms\n", budget_, (long long)max_interval_ms_);
+}
+
+void SapientTrackScheduler::set_state_weight(float confirmed, float tentative)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (confirmed > 0.0f) confirmed_weight_ = confirmed;
+    if (tentative > 0.0f) tentative_weight_ = tentative;
+}
+
+bool SapientTrackScheduler::set_class_weight(unsigned int classification, float weight)
+{
+    if (classification >= kClassCount || weight < 0.0f) return false;
+    std::lock_guard<std::mutex> lock(mutex_);
+    class_weight_[classification] = weight;
+    return true;
+}
+
+void SapientTrackScheduler::set_kinematics(float range_ref_m, float closing_ref_mps)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (range_ref_m > 0.0f) range_ref_m_ = range_ref_m;
+    if (closing_ref_mps > 0.0f) closing_ref_mps_ = closing_ref_mps;
+}
+
+void SapientTrackScheduler::get_stats(uint64_t *scheduled, uint64_t *deferred)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (scheduled) *scheduled = scheduled_;
+    if (deferred) *deferred = deferred_;
+}
+
+extern "C" {
+
+void sapient_track_scheduler_set_budget(unsigned int msgs_per_sec, unsigned int max_interval_ms)
+{
+    SapientTrackScheduler::instance().set_budget(msgs_per_sec, max_interval_ms);
+}
+
+void sapient_track_scheduler_set_state_weight(float confirmed, float tentative)
+{
+    SapientTrackScheduler::instance().set_state_weight(confirmed, tentative);
+}
+
+int sapient_track_scheduler_set_class_weight(unsigned int classification, float weight)
+{
+    return SapientTrackScheduler::instance().set_class_weight(classification, weight) ? 0 : -1;
+}
+
+void sapient_track_scheduler_set_kinematics(float range_ref_m, float closing_ref_mps)
+{
+    SapientTrackScheduler::instance().set_kinematics(range_ref_m, closing_ref_mps);
+}
+
+void sapient_track_scheduler_get_stats(unsigned long long *scheduled, unsigned long long *deferred)
+{
+    uint64_t s = 0, d = 0;
+    SapientTrackScheduler::instance().get_stats(&s, &d);
+    if (scheduled) *scheduled = (unsigned long long)s;
+    if (deferred) *deferred = (unsigned long long)d;
+}
+
+} // extern "C"
@@ -0,0 +1,129 @@
+/*****************************************************************************
+ * Copyright (c) 2023-2025
+ * Skyfend Technology Co., Ltd
+ *
+ * All rights reserved. Any unauthorized disclosure or publication of the
+ * confidential and proprietary information to any other party will constitute
+ * an infringement of copyright laws.
+ *
+ * @file    sapient_track_scheduler.h
+ * @brief   按带宽预算分配航迹上报频率的调度器
+ * @details 位于雷达帧输入与检测报告构建之间：每条航迹按确认状态、分类、距离、
+ *          接近速度计算权重，全局消息预算（条/秒）按权重分给各航迹，得到各自的上报间隔；
+ *          各航迹按帧间隔累计上报额度，额度满一次的航迹本帧到期（雷达帧率与上报间隔不成整数倍时
+ *          平均速率仍与分得的预算一致），到期航迹超过链路容量时按额度从高到低取前几条。
+ *          未设置预算时每帧都上报全部航迹；链路容量不足时按权重加权轮转。
+ *          新航迹的第一条报告总是最先上报；任何航迹的上报间隔不超过最长静默时间。
+ *****************************************************************************
+ */
+#ifndef __SAPIENT_TRACK_SCHEDULER_H_
+#define __SAPIENT_TRACK_SCHEDULER_H_
+
+#include <stddef.h>
+#include "../../common/nanopb/radar.pb.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 设置全局检测报告预算
+ * msgs_per_sec:  所有航迹合计的上报条数/秒（0 表示不限，每帧上报全部航迹，默认 0）
+ * max_interval_ms: 单条航迹的最长上报间隔（毫秒，0 表示保持不变，默认 5000ms）
+ */
+void sapient_track_scheduler_set_budget(unsigned int msgs_per_sec, unsigned int max_interval_ms);
+
+/* 设置航迹状态权重（state_type：1 已确认，其余为暂定；<= 0 表示保持不变，默认 1.0 / 0.3） */
+void sapient_track_scheduler_set_state_weight(float confirmed, float tentative);
+
+/* 设置分类权重（classification：0 未识别 1 无人机 2 单兵 3 车辆 4 鸟类 5 直升机，6 表示其它所有取值）
+ * 默认 未识别 0.5、无人机 2.0、单兵 1.0、车辆 1.0、鸟类 0.2、直升机 1.5、其它 0.5
+ * 返回 0 成功，-1 参数无效
+ */
+int sapient_track_scheduler_set_class_weight(unsigned int classification, float weight);
+
+/* 设置运动学权重的参考尺度（<= 0 表示保持不变）
+ * range_ref_m:     距离权重 1 + ref / (range + ref)，越近越高（默认 1000m）
+ * closing_ref_mps: 接近速度权重 1 + closing / ref，上限 3（默认 10m/s）
+ */
+void sapient_track_scheduler_set_kinematics(float range_ref_m, float closing_ref_mps);
+
+/* 获取调度统计：累计排入上报的航迹次数、累计推迟的航迹次数（任一指针可为 NULL） */
+void sapient_track_scheduler_get_stats(unsigned long long *scheduled, unsigned long long *deferred);
+
+#ifdef __cplusplus
+}
+
+#include <stdint.h>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+class SapientTrackScheduler {
+public:
+    static const unsigned int kDefaultMaxIntervalMs = 5000;
+    static const size_t kClassCount = 7;          // 0~5 为雷达分类，6 为其它
+
+    static SapientTrackScheduler &instance();
+
+    /**
+     * @brief 选出本帧需要上报的航迹
+     * @param items        本帧全部航迹
+     * @param count        航迹数
+     * @param now_ms       单调时钟毫秒
+     * @param max_reports  本帧最多上报的条数（链路整形器估算的容量）
+     * @param[out] selected 大小为 count，1 表示本帧上报
+     * @return 选中的航迹数
+     */
+    size_t schedule(const RadarTrackItem *items, size_t count, int64_t now_ms,
+                    size_t max_reports, std::vector<uint8_t> &selected);
+
+    /**
+     * @brief 撤销本帧对该航迹的选中（报告随后被航位推算抑制、并未发送）：退还额度并恢复上次上报时间
+     * @param track_id 航迹 ID（须为最近一次 schedule() 选中的航迹）
+     */
+    void unschedule(uint32_t track_id);
+
+    void set_budget(unsigned int msgs_per_sec, unsigned int max_interval_ms);
+    void set_state_weight(float confirmed, float tentative);
+    bool set_class_weight(unsigned int classification, float weight);
+    void set_kinematics(float range_ref_m, float closing_ref_mps);
+    void get_stats(uint64_t *scheduled, uint64_t *deferred);
+
+private:
+    SapientTrackScheduler();
+
+    struct Entry {
+        int64_t last_report_ms;   // -1 表示尚未上报
+        int64_t prev_report_ms;   // 本帧选中前的 last_report_ms（供 unschedule() 恢复）
+        int64_t last_seen_ms;
+        double credit;            // 累计的上报额度（每帧增加 帧间隔 / 上报间隔，满 1 可上报一次）
+        double prev_credit;       // 本帧选中前的额度（供 unschedule() 恢复）
+    };
+
+    struct Candidate {
+        double urgency;
+        size_t index;
+    };
+
+    double weight_locked(const RadarTrackItem &item) const;
+    void prune_locked(int64_t now_ms);
+
+    std::mutex mutex_;
+    std::unordered_map<uint32_t, Entry> tracks_;
+    std::vector<double> weights_;          // 复用的临时缓冲
+    std::vector<Candidate> candidates_;
+    unsigned int budget_;
+    int64_t max_interval_ms_;
+    float confirmed_weight_;
+    float tentative_weight_;
+    float class_weight_[kClassCount];
+    float range_ref_m_;
+    float closing_ref_mps_;
+    int64_t last_prune_ms_;
+    uint64_t scheduled_;
+    uint64_t deferred_;
+};
+
+#endif
+
+#endif /* __SAPIENT_TRACK_SCHEDULER_H_ */
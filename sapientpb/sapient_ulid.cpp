@@ -0,0 +1,135 @@
+#include "sapient_ulid.h"
+#include "sapient_clock.h"
+#include <stdint.h>
+#include <string.h>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <functional>
+
+namespace {
+
+// Crockford's Base32 字母表
+const char kBase32Chars[] = "0123456789ABCDEFGHJKMNPQRSTVWXYZ";
+
+// 线程级 ULID 状态：上一个 ID 的时间与 80 位随机数（hi 16 位 + lo 64 位）
+struct UlidState {
+    bool seeded;
+    uint64_t s0, s1;          // xorshift128+ 状态
+    uint64_t last_ms;
+    uint16_t rand_hi;
+    uint64_t rand_lo;
+};
+thread_local UlidState t_ulid = { false, 0, 0, 0, 0, 0 };
+
+uint64_t splitmix64(uint64_t &x)
+{
+    uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+void seed_state(UlidState &st)
+{
+    // 每个线程只播种一次：random_device 与时间、线程 ID 混合，random_device 不可用时仍能区分线程
+    uint64_t seed = 0;
+    try {
+        std::random_device rd;
+        seed = ((uint64_t)rd() << 32) ^ rd();
+    } catch (...) {
+    }
+    seed ^= (uint64_t)std::chrono::high_resolution_clock::now().time_since_epoch().count();
+    seed ^= (uint64_t)std::hash<std::thread::id>()(std::this_thread::get_id()) << 1;
+    st.s0 = splitmix64(seed);
+    st.s1 = splitmix64(seed);
+    if ((st.s0 | st.s1) == 0) st.s1 = 1;
+    st.seeded = true;
+}
+
+inline uint64_t next_random(UlidState &st)
+{
+    uint64_t x = st.s0;
+    const uint64_t y = st.s1;
+    st.s0 = y;
+    x ^= x << 23;
+    st.s1 = x ^ y ^ (x >> 17) ^ (y >> 26);
+    return st.s1 + y;
+}
+
+// 推进到下一个 ID：新毫秒重新取随机数，同一毫秒（或时间回拨）随机部分加 1
+inline void advance(UlidState &st, uint64_t unix_ms)
+{
+    if (!st.seeded) seed_state(st);
+    if (unix_ms > st.last_ms) {
+        st.last_ms = unix_ms;
+        st.rand_lo = next_random(st);
+        st.rand_hi = (uint16_t)next_random(st);
+        return;
+    }
+    if (++st.rand_lo == 0 && ++st.rand_hi == 0) {
+        // 80 位随机数溢出（同一毫秒内 2^80 个 ID，实际不会发生）：借用下一毫秒
+        st.last_ms++;
+        st.rand_lo = next_random(st);
+        st.rand_hi = (uint16_t)next_random(st);
+    }
+}
+
+// 48 位时间 → 10 个字符，80 位随机数 → 16 个字符
+inline void encode(const UlidState &st, char *out)
+{
+    uint64_t t = st.last_ms;
+    for (int i = 9; i >= 0; --i) {
+        out[i] = kBase32Chars[t & 31];
+        t >>= 5;
+    }
+    // 80 位 = hi(16) + lo(64)：前 4 个字符取 hi 和 lo 的最高 4 位，后 12 个字符取 lo 的低 60 位
+    uint64_t lo = st.rand_lo;
+    for (int i = 25; i >= 14; --i) {
+        out[i] = kBase32Chars[lo & 31];
+        lo >>= 5;
+    }
+    uint32_t top = ((uint32_t)st.rand_hi << 4) | (uint32_t)lo;   // lo 此时只剩最高 4 位
+    for (int i = 13; i >= 10; --i) {
+        out[i] = kBase32Chars[top & 31];
+        top >>= 5;
+    }
+    out[SAPIENT_ULID_LEN] = '\0';
+}
+
+} // namespace
+
+extern "C" {
+
+void sapient_ulid_generate(char out[SAPIENT_ULID_BUF_SIZE])
+{
+    sapient_ulid_generate_at(out, (unsigned long long)SapientTime::now().unix_ms());
+}
+
+void sapient_ulid_generate_at(char out[SAPIENT_ULID_BUF_SIZE], unsigned long long unix_ms)
+{
+    UlidState &st = t_ulid;
+    advance(st, (uint64_t)unix_ms);
+    encode(st, out);
+}
+
+void sapient_ulid_reserve(char (*out)[SAPIENT_ULID_BUF_SIZE], size_t count, unsigned long long unix_ms)
+{
+    UlidState &st = t_ulid;
+    for (size_t i = 0; i < count; i++) {
+        advance(st, (uint64_t)unix_ms);
+        encode(st, out[i]);
+    }
+}
+
+void generate_ulid(char *ulid)
+{
+    sapient_ulid_generate(ulid);
+}
+
+void generate_ulid_ms(char *ulid, unsigned long long unix_ms)
+{
+    sapient_ulid_generate_at(ulid, unix_ms);
+}
+
+} // extern "C"
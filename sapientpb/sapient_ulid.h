@@ -0,0 +1,48 @@
+/*****************************************************************************
+ * Copyright (c) 2023-2025
+ * Skyfend Technology Co., Ltd
+ *
+ * All rights reserved. Any unauthorized disclosure or publication of the
+ * confidential and proprietary information to any other party will constitute
+ * an infringement of copyright laws.
+ *
+ * @file    sapient_ulid.h
+ * @brief   单调 ULID 生成器
+ * @details 按 ULID 规范的单调规则生成：48 位毫秒时间 + 80 位随机数。每个线程在进入
+ *          新的毫秒时重新生成一次 80 位随机数（线程级 xorshift128+，只在首次使用时播种），
+ *          同一毫秒内（或系统时间回拨时）沿用上一个 ID 的时间部分并将随机部分加 1，
+ *          因此同一线程生成的 ID 严格递增。80 位随机数在同一毫秒内溢出时借用下一毫秒。
+ *          结果直接写入调用方提供的 27 字节缓冲区（26 个字符 + '\0'），不分配内存。
+ *          批量帧可以一次预留 N 个连续 ID。
+ *****************************************************************************
+ */
+#ifndef __SAPIENT_ULID_H_
+#define __SAPIENT_ULID_H_
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SAPIENT_ULID_LEN 26
+#define SAPIENT_ULID_BUF_SIZE 27
+
+/* 以当前时间生成一个 ULID */
+void sapient_ulid_generate(char out[SAPIENT_ULID_BUF_SIZE]);
+
+/* 以调用方给定的 Unix 毫秒时间生成 ULID（与报文 Timestamp 共用同一次时钟采样） */
+void sapient_ulid_generate_at(char out[SAPIENT_ULID_BUF_SIZE], unsigned long long unix_ms);
+
+/* 一次预留 count 个单调递增的 ULID（同一毫秒内随机部分连续递增），写入 out[0..count) */
+void sapient_ulid_reserve(char (*out)[SAPIENT_ULID_BUF_SIZE], size_t count, unsigned long long unix_ms);
+
+/* 兼容接口（原 sky_detection_reportpb.cpp 中的实现），ulid 至少 27 字节 */
+void generate_ulid(char *ulid);
+void generate_ulid_ms(char *ulid, unsigned long long unix_ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SAPIENT_ULID_H_ */
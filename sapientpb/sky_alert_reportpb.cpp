@@ -2,38 +2,32 @@
 #include "../sapient/alert.pb.h"
 #include "../sapient/sapient_message.pb.h"
 #include "sapient_nodeid.h"
-#include <google/protobuf/util/json_util.h>
+#include "sapient_json.h"
+#include "sapient_clock.h"
 #include <google/protobuf/timestamp.pb.h>
 #include <chrono>
 #include <string>
 #include <iostream>
 
 // extern std::string g_nodeId; // Replaced by sapient_nodeid.h
-extern "C" void generate_ulid(char *ulid); // 复用已有 ULID 生成函数
+#include "sapient_ulid.h"  // 单调 ULID 生成函数
 
-// 设置当前 UTC 时间戳 (与其它 builder 保持一致)
-static void set_current_timestamp(::google::protobuf::Timestamp *ts)
-{
-    auto now = std::chrono::system_clock::now();
-    auto seconds = std::chrono::duration_cast<std::chrono::seconds>(now.time_since_epoch()).count();
-    auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count() % 1000000000;
-    ts->set_seconds(seconds);
-    ts->set_nanos((int32_t)nanos);
-}
-
-int sapient_build_alert_report(std::string &out_serialized,
-                               std::string &out_json,
-                               const char *description,
-                               int type,
-                               int status)
+// 构造 Alert，封装进 SapientMessage wrapper
+static void build_alert_wrapper(sapient_msg::bsi_flex_335_v2_0::SapientMessage &wrapper,
+                                const char *description,
+                                int type,
+                                int status)
 {
     using namespace sapient_msg::bsi_flex_335_v2_0;
 
     Alert alert;
 
+    // 报文时间：alert_id 的 ULID 与 wrapper Timestamp 共用一次时钟采样
+    const SapientTime now = SapientTime::now();
+
     // 必需: alert_id ULID
     char ulid[27] = {0};
-    generate_ulid(ulid);
+    generate_ulid_ms(ulid, (unsigned long long)now.unix_ms());
     alert.set_alert_id(ulid);
 
     // alert_type (默认 INFORMATION)
@@ -58,26 +52,48 @@ int sapient_build_alert_report(std::string &out_serialized,
     }
 
     // 封装到 SapientMessage
-    SapientMessage wrapper;
-    set_current_timestamp(wrapper.mutable_timestamp());
+    now.to_timestamp(wrapper.mutable_timestamp());
     std::string node_id = generateNodeID();
     if (!node_id.empty()) {
         wrapper.set_node_id(node_id);
     }
     wrapper.set_allocated_alert(new Alert(alert));
+}
+
+int sapient_build_alert_report(std::string &out_serialized,
+                               std::string &out_json,
+                               const char *description,
+                               int type,
+                               int status)
+{
+    sapient_msg::bsi_flex_335_v2_0::SapientMessage wrapper;
+    build_alert_wrapper(wrapper, description, type, status);
 
     if (!wrapper.SerializeToString(&out_serialized)) {
         std::cerr << "Failed to serialize Alert wrapper" << std::endl;
+        sapient_json_render(wrapper, "Alert", out_json, true, true);
         return -1;
     }
 
-    google::protobuf::util::JsonPrintOptions options;
-    options.add_whitespace = true;
-    options.always_print_primitive_fields = true;
-    if (!google::protobuf::util::MessageToJsonString(wrapper, &out_json, options).ok()) {
-        std::cerr << "Failed to convert Alert wrapper to JSON" << std::endl;
-        return -2;
+    sapient_json_render(wrapper, "Alert", out_json, false, true);
+    return 0;
+}
+
+int sapient_build_alert_report_frame(SapientFramePtr &out_frame,
+                                     std::string &out_json,
+                                     const char *description,
+                                     int type,
+                                     int status)
+{
+    sapient_msg::bsi_flex_335_v2_0::SapientMessage wrapper;
+    build_alert_wrapper(wrapper, description, type, status);
+
+    if (sapient_serialize_to_frame(wrapper, out_frame) != 0) {
+        std::cerr << "Failed to serialize Alert wrapper into frame" << std::endl;
+        sapient_json_render(wrapper, "Alert", out_json, true, true);
+        return -1;
     }
 
+    sapient_json_render(wrapper, "Alert", out_json, false, true);
     return 0;
 }
@@ -8,6 +8,7 @@
 #define __SKY_ALERT_REPORTPB_H_
 
 #include <string>
+#include "sapient_frame.h"
 
 /* 构建并封装 Alert 消息到 SapientMessage
  * 参数:
@@ -16,7 +17,7 @@
  *  status           Alert 状态枚举值(参考 Alert::AlertStatus)，0 或非法则使用 ACTIVE
  * 输出:
  *  out_serialized   SapientMessage 二进制 (带 timestamp/node_id/alert)
- *  out_json         便于调试的 JSON 文本
+ *  out_json         便于调试的 JSON 文本（按 sapient_json.h 的渲染策略生成，默认为空）
  * 返回: 0 成功, 负值失败
  */
 int sapient_build_alert_report(std::string &out_serialized,
@@ -25,4 +26,11 @@ int sapient_build_alert_report(std::string &out_serialized,
                                int type,
                                int status);
 
+/* 帧缓冲版本：参数含义同上，SapientMessage 直接序列化到池化帧（已带长度前缀） */
+int sapient_build_alert_report_frame(SapientFramePtr &out_frame,
+                                     std::string &out_json,
+                                     const char *description,
+                                     int type,
+                                     int status);
+
 #endif /* __SKY_ALERT_REPORTPB_H_ */
@@ -4,14 +4,11 @@
 #include <string>
 #include <chrono>
 #include <cmath>
-#include <random>
 #include <sstream>
 #include <iomanip>
 #include <cstring>
-#include <map>
-#include <google/protobuf/util/json_util.h>
+#include <vector>
 #include <google/protobuf/timestamp.pb.h>
-#include "../sapient/sky_detection_report.pb.h"
 #include "../sapient/sapient_message.pb.h"
 #include "../../inc/invaild_value.h"
 #include "../../common/nanopb/radar.pb.h"
@@ -24,9 +21,17 @@ extern "C" {
 #include "sapient_tcp.h"
 #include "sky_task_handler.h"
 #include "sapient_nodeid.h"
+#include "sapient_frame.h"
+#include "sapient_arena.h"
+#include "sapient_json.h"
+#include "sapient_track_registry.h"
+#include "sapient_track_scheduler.h"
+#include "sapient_task_filter.h"
+#include "sapient_track_kernel.h"
+#include "sapient_clock.h"
+#include "sapient_ulid.h"
 
 extern std::string g_sn;
-extern std::string getCurrentTimeISO8601();
 std::string getUTMZone(void);
 
 // Base64 编码表
@@ -74,134 +79,102 @@ static std::string __attribute__((unused)) base64_encode(const unsigned char* da
     return ret;
 }
 
-extern "C" {
-
-    #include <stdio.h>
-    #include <stdlib.h>
-    #include <time.h>
-    #include <string.h>
-    #include <stdint.h>
-
-
-    // Crockford's Base32 字母表
-    const char* base32_chars = "0123456789ABCDEFGHJKMNPQRSTVWXYZ";
-
-    // 将无符号整数编码为 Base32 表示形式
-    static void encode_base32_u64(uint64_t value, char *dest, int count)
-    {
-        for (int i = count - 1; i >= 0; --i) {
-            dest[i] = base32_chars[value % 32];
-            value /= 32;
-        }
+// 同一帧雷达数据中所有航迹共享的上下文：每帧只读取一次雷达状态、任务 ID、NodeID 和时间戳
+struct DetectionFrameContext {
+    SapientPlatformPose pose;   // 雷达平台姿态与位置（批量坐标转换用）
+    std::string task_id;        // 当前任务 ID（为空表示无活跃任务）
+    std::string node_id;
+    SapientTime time;           // 报文时间：ULID、Timestamp 共用这一次采样
+    int64_t now_ms;             // 单调时钟，用于航迹存活判断
+    std::shared_ptr<const SapientTaskFilter> filter;   // 当前 Task 区域筛选（为空表示不筛选）
+};
+
+static void capture_detection_context(DetectionFrameContext &ctx)
+{
+    // 使用统一的 NodeID 生成接口
+    ctx.node_id = generateNodeID();
+    ctx.task_id = sapient_get_current_task_id();
+
+    // ======================== 获取雷达姿态与位置（用于坐标转换） ========================
+    // 只读取姿态与位置字段，不拷贝整个 RadarState
+    SapientPlatformPose &pose = ctx.pose;
+    if (get_radar_attitude(&pose.heading, &pose.pitch, &pose.roll) != 0) {
+        // 如果获取失败，使用默认值 0（假设雷达朝北且水平）
+        pose.heading = pose.pitch = pose.roll = 0.0;
     }
+    pose.has_lla = get_radar_lla(&pose.longitude, &pose.latitude, &pose.altitude) == 0 &&
+                   (pose.longitude != 0.0 || pose.latitude != 0.0);
+    if (!pose.has_lla) {
+        pose.longitude = pose.latitude = pose.altitude = 0.0;
+    }
+    // ================================================================================
 
-    // 生成 ULID（唯一性、单调递增的标识符）
-    // 修复：使用毫秒级时间戳 + 线程安全的随机数生成器，避免高频上报时 ULID 重复
-    void generate_ulid(char *ulid) 
-    {
-        // 使用 chrono 获取真正的毫秒级时间戳
-        auto now = std::chrono::system_clock::now();
-        auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(
-            now.time_since_epoch()).count();
-        uint64_t timestamp_ms = static_cast<uint64_t>(millis);
-
-        // 编码时间戳（占用前10个字符）
-        encode_base32_u64(timestamp_ms, ulid, 10);
-
-        // 添加随机部分（占用后16个字符）
-        // 使用 thread_local 随机数生成器，每个线程只初始化一次，避免同秒重复序列
-        static thread_local std::mt19937 rng([]() {
-            std::random_device rd;
-            auto seed = rd();
-            if (seed == 0) {
-                // 如果 random_device 失败，使用时间作为后备种子
-                seed = static_cast<unsigned int>(
-                    std::chrono::high_resolution_clock::now().time_since_epoch().count());
-            }
-            return seed;
-        }());
-        std::uniform_int_distribution<int> dist(0, 31);
-        
-        for (int i = 10; i < 26; ++i) {
-            ulid[i] = base32_chars[dist(rng)];
-        }
+    ctx.time = SapientTime::now();
+    ctx.now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
 
-        // 字符串以空字符结尾
-        ulid[26] = '\0';
-    }
+    // 区域筛选每帧取一次快照：处理中途收到新 Task 不影响本帧
+    ctx.filter = SapientTaskFilterEngine::instance().snapshot();
 }
 
-// 新实现：基于 RadarTrackItem 构建 DetectionReport（应用层数据源）
-static int sapient_build_detection_report_from_track_item(
-    std::string &out_serialized,
-    std::string &out_json,
-    const RadarTrackItem *track_item)
+// 航迹是否被 Task 区域或筛选器排除（在任何 protobuf 构建之前判定）
+static bool detection_filtered_out(const RadarTrackItem &item, const SapientTrackBatch &batch, size_t index,
+                                   const DetectionFrameContext &ctx)
+{
+    if (!ctx.filter) return false;
+    bool pass = ctx.filter->accept(item, batch, index);
+    SapientTaskFilterEngine::instance().record(pass ? 1 : 0, pass ? 0 : 1);
+    return !pass;
+}
+
+// 新实现：基于 RadarTrackItem 构建 DetectionReport（应用层数据源），直接构建在 SapientMessage wrapper 内
+// wrapper 通常分配在 SapientScopedArena 上，所有子消息与字符串随 arena 一次性释放
+// object_id 由航迹映射表（sapient_track_registry.h）按 track ID 分配；
+// report_id 为 NULL 时按报文时间生成，批量构建时由调用方预留
+// 真北方位、仰角与 ENU 速度取自本帧批量坐标转换结果 batch 的第 index 条（sapient_track_kernel.h）
+static int build_detection_report_wrapper(
+    sapient_msg::bsi_flex_335_v2_0::SapientMessage &wrapper,
+    const RadarTrackItem *track_item,
+    const SapientTrackBatch &batch, size_t index,
+    const char *object_id,
+    const char *report_id,
+    const DetectionFrameContext &ctx)
 {
     if (!track_item) {
         std::cerr << "Error: track_item is null" << std::endl;
         return -1;
     }
 
-    char ulid[27] = {0};
-    sapient_msg::bsi_flex_335_v2_0::SkyDetectionReportMessage detectrepo;
-
-    // 注意：不要在每次构建报文时调用 srand(time(NULL))，否则同一秒内：
-    // 1) 随机数种子相同 → rand() 序列重复 → ULID 的随机部分重复
-    // 2) time(NULL) 秒级精度 → ULID 时间戳部分也相同
-    // 结果：同一秒内生成的所有 ULID 完全重复，导致对端代理去重/丢弃
-    // 现在 generate_ulid() 使用毫秒级时间戳 + thread_local 随机数生成器，无需 srand()
+    // report_id 使用单调 ULID（sapient_ulid.h）：同一毫秒内随机部分递增，不会重复
+    char ulid[SAPIENT_ULID_BUF_SIZE];
+    if (!report_id) {
+        sapient_ulid_generate_at(ulid, (unsigned long long)ctx.time.unix_ms());
+        report_id = ulid;
+    }
 
     // 填充报文头部
-    std::string timestamp = getCurrentTimeISO8601();
-    detectrepo.set_timestamp(timestamp);
-    
-    // 使用统一的 NodeID 生成接口
-    std::string node_id = generateNodeID();
-    detectrepo.set_nodeid(node_id);
-
-    // 填充 detection report 内容
-    auto *detectionreport = detectrepo.mutable_detectionreport();
-    generate_ulid(ulid);
-    detectionreport->set_report_id(ulid);
-
-    // object_id 生成：基于 track ID（持久化）
-    static std::map<uint32_t, std::string> track_id_to_objectid;
-    std::string object_id;
-    auto it = track_id_to_objectid.find(track_item->id);
-    if (it != track_id_to_objectid.end()) {
-            object_id = it->second;
-    } else {
-        generate_ulid(ulid);
-        object_id = ulid;
-        track_id_to_objectid[track_item->id] = object_id;
+    if (!ctx.node_id.empty()) {
+        wrapper.set_node_id(ctx.node_id);
     }
-    detectionreport->set_object_id(object_id);
+
+    // 填充 detection report 内容（直接写入 wrapper，不再经过中间消息和 CopyFrom）
+    auto *detectionreport = wrapper.mutable_detection_report();
+    detectionreport->set_report_id(report_id, SAPIENT_ULID_LEN);
+
+    // object_id：同一航迹在存活期间保持不变
+    detectionreport->set_object_id(object_id, SAPIENT_ULID_LEN);
 
     // task_id：仅在存在有效任务 ID 时设置
-    std::string current_task_id = sapient_get_current_task_id();
-    if (!current_task_id.empty()) {
-        detectionreport->set_task_id(current_task_id);
+    if (!ctx.task_id.empty()) {
+        detectionreport->set_task_id(ctx.task_id);
     }
 
     // 状态：有 RadarTrackItem 数据就设置为 "detected"
     // （类似 STP120 的 "if (pdrone)" 逻辑，能执行到这里说明 track_item 不为空）
         detectionreport->set_state("detected");
 
-    // ======================== 获取雷达状态数据（用于坐标转换） ========================
-    RadarState radar_state;
-    memset(&radar_state, 0, sizeof(RadarState));
-    double radar_heading = 0.0;  // 雷达平台航向角（相对于正北）
-    
-    int ret_state = get_radar_state(&radar_state);
-    if (ret_state == 0 && radar_state.has_attitude && radar_state.attitude.has_heading) {
-        radar_heading = radar_state.attitude.heading;
-    } else {
-        // 如果获取失败，使用默认值 0（假设雷达朝北）
-        radar_heading = 0.0;
-    }
-    // ================================================================================
-
     // 位置：优先使用 GPS 坐标（如果有），否则使用 RangeBearing
+    // （location_oneof 只能二选一；航迹无 GPS 时推算出的经纬度只用于区域筛选）
     if (track_item->longitude != 0.0f || track_item->latitude != 0.0f) {
         // 使用 Location (经纬度)
         auto *lc = detectionreport->mutable_location();
@@ -228,27 +201,15 @@ static int sapient_build_detection_report_from_track_item(
         auto *rb = detectionreport->mutable_range_bearing();
         
         // 方位角（度）：SAPIENT 要求方位角相对于正北
-        // track_item->azimuth 是相对于雷达的角度（-60° ~ 60°）
-        // 需要转换为相对于正北的角度
+        // track_item->azimuth 是相对于雷达的角度（-60° ~ 60°），已按平台姿态转换为真北方位 [0, 360)
         if (track_item->azimuth >= -60.0f && track_item->azimuth <= 60.0f) {
-            // 转换公式：相对于正北的方位角 = 相对于雷达的方位角 + 雷达航向角
-            double azimuth_relative_to_north = track_item->azimuth + radar_heading;
-            
-            // 归一化到 [0, 360) 范围
-            while (azimuth_relative_to_north < 0.0) {
-                azimuth_relative_to_north += 360.0;
-            }
-            while (azimuth_relative_to_north >= 360.0) {
-                azimuth_relative_to_north -= 360.0;
-            }
-            
-            rb->set_azimuth(azimuth_relative_to_north);
+            rb->set_azimuth(batch.bearing(index));
             rb->set_azimuth_error(1.0);  // 方位角误差 1°
         }
         
-        // 仰角（度）：有效范围 -40° ~ 40°
+        // 仰角（度）：有效范围 -40° ~ 40°（上报相对水平面的仰角）
         if (track_item->elevation >= -40.0f && track_item->elevation <= 40.0f) {
-            rb->set_elevation(track_item->elevation);
+            rb->set_elevation(batch.elevation(index));
             rb->set_elevation_error(1.0);  // 仰角误差 1°
         }
         
@@ -445,37 +406,8 @@ static int sapient_build_detection_report_from_track_item(
     auto *behaviour = detectionreport->add_behaviour();
 
     // motionType 在部分“假数据/未初始化数据”场景可能一直为 0（未知），
-    // 这里增加兜底：用速度信息推断 Active/Passive，避免对端全部显示 other。
-    switch (track_item->motionType) {
-        case 1: // 静止 -> Passive
-            behaviour->set_type("Passive");
-            break;
-
-        case 2: // 悬停
-        case 3: // 靠近
-        case 4: // 远离
-            behaviour->set_type("Active");
-            break;
-
-        default: {
-            // 兜底：优先用 absVel，其次用径向速度/ENU 速度分量判断是否“有运动”
-            const float abs_speed = fabsf(track_item->absVel);
-            const float radial_speed = fabsf(track_item->velocity);
-            const float enu_speed_hint = fabsf(track_item->vx) + fabsf(track_item->vy) + fabsf(track_item->vz);
-
-            // 经验阈值：>0.5m/s 视为“有运动”
-            const float ACTIVE_SPEED_THRESHOLD = 0.5f;
-            if (abs_speed > ACTIVE_SPEED_THRESHOLD ||
-                radial_speed > ACTIVE_SPEED_THRESHOLD ||
-                enu_speed_hint > ACTIVE_SPEED_THRESHOLD) {
-                behaviour->set_type("Active");
-            } else {
-                // 无法判断/几乎静止：用 Passive 比 Other 更有信息量
-                behaviour->set_type("Passive");
-            }
-            break;
-        }
-    }
+    // 此时按速度信息推断 Active/Passive（与区域行为筛选共用同一判定，见 sapient_task_filter.h）
+    behaviour->set_type(sapient_track_behaviour(*track_item) == SAPIENT_BEHAVIOUR_ACTIVE ? "Active" : "Passive");
 
     // 速度：使用 ENU 速度（东-北-天）
     if (track_item->vx != 0.0f || track_item->vy != 0.0f || track_item->vz != 0.0f) {
@@ -493,42 +425,10 @@ static int sapient_build_detection_report_from_track_item(
         //   East = -West （东向 = -西向）
         //   North = North （北向保持不变）
         //   Up = Up （天向保持不变）
-        
-        double east_rate = -track_item->vy;   // 东向 = -西向
-        double north_rate = track_item->vx;   // 北向（不变）
-        double up_rate = track_item->vz;      // 天向（不变）
-        
-        // 速度值范围检查：根据 RadarTrackItem 规范，速度范围为 -100~100 m/s
-        const double MIN_VELOCITY = -100.0;
-        const double MAX_VELOCITY = 100.0;
-        
-        // 限制速度值在有效范围内（先进行范围检查）
-        if (east_rate < MIN_VELOCITY) {
-            east_rate = MIN_VELOCITY;
-        } else if (east_rate > MAX_VELOCITY) {
-            east_rate = MAX_VELOCITY;
-        }
-        
-        if (north_rate < MIN_VELOCITY) {
-            north_rate = MIN_VELOCITY;
-        } else if (north_rate > MAX_VELOCITY) {
-            north_rate = MAX_VELOCITY;
-        }
-        
-        if (up_rate < MIN_VELOCITY) {
-            up_rate = MIN_VELOCITY;
-        } else if (up_rate > MAX_VELOCITY) {
-            up_rate = MAX_VELOCITY;
-        }
-        
-        // 如果速度接近 0，使用最小值避免字段为空（在范围检查之后处理）
-        const double MIN_SPEED = 0.001;
-        if (fabs(east_rate) < 0.0001) east_rate = MIN_SPEED;
-        if (fabs(north_rate) < 0.0001) north_rate = MIN_SPEED;
-        
-        velocity->set_east_rate(east_rate);
-        velocity->set_north_rate(north_rate);
-        velocity->set_up_rate(up_rate);
+        // 转换、限幅到 -100~100 m/s 与接近 0 时的替换已在批量坐标转换中完成
+        velocity->set_east_rate(batch.east_rate(index));
+        velocity->set_north_rate(batch.north_rate(index));
+        velocity->set_up_rate(batch.up_rate(index));
         
         // 误差根据速度方差估算（vx 和 vy 方差应该相同，用于东向和北向）
         double v_error = sqrt(track_item->vx_variance);
@@ -543,43 +443,272 @@ static int sapient_build_detection_report_from_track_item(
     snprintf(track_id_str, sizeof(track_id_str), "track_%u", track_item->id);
     detectionreport->set_id(track_id_str);
 
-    // 构造 SapientMessage wrapper
-    sapient_msg::bsi_flex_335_v2_0::SapientMessage wrapper;
-    if (detectrepo.nodeid().size() > 0) {
-        wrapper.set_node_id(detectrepo.nodeid());
+    // 顶层 timestamp（同一帧内的航迹共用）
+    ctx.time.to_timestamp(wrapper.mutable_timestamp());
+
+    return 0;
+}
+
+
+// 在线航迹：从映射表取得（或新分配）object_id 后构建
+// 返回 0 构建成功；1 被航位推算抑制（不构建，见 sapient_track_registry.h）；-1 失败
+// 被抑制时退还调度器本帧为该航迹扣除的额度，避免为未发送的报告计费
+static int build_track_report(sapient_msg::bsi_flex_335_v2_0::SapientMessage &wrapper,
+                              const RadarTrackItem *track_item,
+                              const SapientTrackBatch &batch, size_t index,
+                              const char *report_id,
+                              const DetectionFrameContext &ctx)
+{
+    if (!track_item) {
+        std::cerr << "Error: track_item is null" << std::endl;
+        return -1;
     }
-    
-    // 顶层 timestamp
-    {
-        auto now = std::chrono::system_clock::now();
-        auto secs = std::chrono::duration_cast<std::chrono::seconds>(now.time_since_epoch()).count();
-        auto nanos_total = std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count();
-        int nanos = static_cast<int>(nanos_total - secs * 1000000000LL);
-        google::protobuf::Timestamp* ts = wrapper.mutable_timestamp();
-        ts->set_seconds(static_cast<long long>(secs));
-        ts->set_nanos(nanos);
+    char object_id[SAPIENT_ULID_BUF_SIZE];
+    if (!SapientTrackRegistry::instance().acquire(*track_item, ctx.now_ms, object_id)) {
+        SapientTrackScheduler::instance().unschedule(track_item->id);
+        return 1;
+    }
+    return build_detection_report_wrapper(wrapper, track_item, batch, index, object_id, report_id, ctx);
+}
+
+// 丢失航迹：沿用最后一次的航迹数据和 object_id，状态置为 "lost"
+static int build_lost_report(sapient_msg::bsi_flex_335_v2_0::SapientMessage &wrapper,
+                             const SapientLostTrack &lost,
+                             const SapientTrackBatch &batch, size_t index,
+                             const DetectionFrameContext &ctx)
+{
+    if (build_detection_report_wrapper(wrapper, &lost.last_item, batch, index, lost.object_id, NULL, ctx) != 0) {
+        return -1;
+    }
+    wrapper.mutable_detection_report()->set_state("lost");
+    return 0;
+}
+
+// 把被淘汰的航迹构建为 "lost" 报告帧，追加到 out_frames；返回构建的帧数
+static size_t append_lost_frames(std::vector<SapientFramePtr> &out_frames,
+                                 const std::vector<SapientLostTrack> &lost,
+                                 const DetectionFrameContext &ctx, SapientScopedArena &arena)
+{
+    static thread_local std::vector<RadarTrackItem> items;
+    static thread_local SapientTrackBatch batch;
+    items.clear();
+    for (size_t i = 0; i < lost.size(); i++) {
+        items.push_back(lost[i].last_item);
+    }
+    batch.convert(items.data(), items.size(), ctx.pose);
+
+    std::string json;
+    size_t built = 0;
+    for (size_t i = 0; i < lost.size(); i++) {
+        auto *wrapper = arena.create<sapient_msg::bsi_flex_335_v2_0::SapientMessage>();
+        SapientFramePtr frame;
+        if (build_lost_report(*wrapper, lost[i], batch, i, ctx) == 0 &&
+            sapient_serialize_to_frame(*wrapper, frame) == 0) {
+            sapient_json_render(*wrapper, "DetectionReport", json);
+            // 替换发送队列中该航迹未发送的报告，并结束合并（同 ID 的新航迹重新排队）
+            frame->set_conflate(SAPIENT_CONFLATE_FINAL, lost[i].last_item.id);
+            out_frames.push_back(std::move(frame));
+            built++;
+        }
+        arena.reset();
+    }
+    return built;
+}
+
+// 单条航迹经调度器决定本次是否上报（与批量版本共享额度与最长静默时间）；
+// 未选中时只刷新存活时间，返回 false
+static bool schedule_single_track(const RadarTrackItem &track_item, const DetectionFrameContext &ctx)
+{
+    static thread_local std::vector<uint8_t> selected;
+    if (SapientTrackScheduler::instance().schedule(&track_item, 1, ctx.now_ms, 1, selected) == 0) {
+        SapientTrackRegistry::instance().touch(track_item, ctx.now_ms);
+        return false;
+    }
+    return true;
+}
+
+static int sapient_build_detection_report_from_track_item(
+    std::string &out_serialized,
+    std::string &out_json,
+    const RadarTrackItem *track_item)
+{
+    SapientScopedArena arena;
+    auto *wrapper = arena.create<sapient_msg::bsi_flex_335_v2_0::SapientMessage>();
+    DetectionFrameContext ctx;
+    capture_detection_context(ctx);
+    static thread_local SapientTrackBatch batch;
+    batch.convert(track_item, track_item ? 1 : 0, ctx.pose);
+    if (track_item && detection_filtered_out(*track_item, batch, 0, ctx)) {
+        return 1;
+    }
+    if (track_item && !schedule_single_track(*track_item, ctx)) {
+        return 1;
+    }
+    int ret = build_track_report(*wrapper, track_item, batch, 0, NULL, ctx);
+    if (ret != 0) {
+        return ret;
     }
-    
-    wrapper.mutable_detection_report()->CopyFrom(detectrepo.detectionreport());
 
     // 序列化
-    if (!wrapper.SerializeToString(&out_serialized)) {
+    if (!wrapper->SerializeToString(&out_serialized)) {
         std::cerr << "序列化 SapientMessage wrapper 失败" << std::endl;
+        sapient_json_render(*wrapper, "DetectionReport", out_json, true);
         return -1;
     }
 
-    // 序列化为 JSON
-    google::protobuf::util::JsonOptions options;
-    options.add_whitespace = true;
-    auto status = google::protobuf::util::MessageToJsonString(wrapper, &out_json, options);
-    if (!status.ok()) {
-        std::cerr << "将 wrapper message 转换为 JSON 失败: " << status.ToString() << std::endl;
+    // JSON 仅用于调试，按渲染策略决定是否生成
+    sapient_json_render(*wrapper, "DetectionReport", out_json);
+    return 0;
+}
+
+// 帧缓冲版本：直接序列化到池化帧（已带长度前缀），供发送热路径使用
+// 返回 0 成功；1 本次报告被航位推算抑制、被调度器推迟或被 Task 区域筛选排除（out_frame 保持为空）；-1 失败
+int sapient_build_detection_report_frame(SapientFramePtr &out_frame, std::string &out_json,
+                                         const RadarTrackItem *track_item)
+{
+    // 构建线程复用的 arena 初始块：子消息、字符串全部在块内分配，函数返回时整体释放
+    SapientScopedArena arena;
+    auto *wrapper = arena.create<sapient_msg::bsi_flex_335_v2_0::SapientMessage>();
+    DetectionFrameContext ctx;
+    capture_detection_context(ctx);
+    static thread_local SapientTrackBatch batch;
+    batch.convert(track_item, track_item ? 1 : 0, ctx.pose);
+    if (track_item && detection_filtered_out(*track_item, batch, 0, ctx)) {
+        return 1;
+    }
+    if (track_item && !schedule_single_track(*track_item, ctx)) {
+        return 1;
+    }
+    int ret = build_track_report(*wrapper, track_item, batch, 0, NULL, ctx);
+    if (ret != 0) {
+        return ret;
+    }
+
+    if (sapient_serialize_to_frame(*wrapper, out_frame) != 0) {
+        std::cerr << "序列化 SapientMessage wrapper 到帧缓冲失败" << std::endl;
+        sapient_json_render(*wrapper, "DetectionReport", out_json, true);
         return -1;
     }
+    // 链路变慢时同一航迹只保留最新一条未发送的报告
+    out_frame->set_conflate(SAPIENT_CONFLATE_LATEST, track_item->id);
 
+    sapient_json_render(*wrapper, "DetectionReport", out_json);
     return 0;
 }
 
+// 批量版本：一帧雷达数据中的所有航迹共享同一份上下文，一次遍历构建全部帧。
+// 每条报告构建、序列化后立即复位 arena，整批只占用线程复用的初始块。
+// 本帧上报哪些航迹由调度器（sapient_track_scheduler.h）按全局预算与航迹价值决定，
+// 最多 max_reports 条（链路整形器估算的容量）；未选中的航迹只刷新存活时间（推迟，不入队）。
+// 落在 Task 忽略区、关注区之外或不满足筛选器的航迹在调度之前即被排除（sapient_task_filter.h）。
+// 构建失败的航迹被跳过，返回成功处理（构建成帧、被航位推算抑制、被推迟或被区域筛选排除）的航迹数
+// （不含随后追加的 "lost" 报告）。
+size_t sapient_build_detection_report_frames(std::vector<SapientFramePtr> &out_frames,
+                                             const RadarTrackItem *items, size_t count,
+                                             size_t max_reports)
+{
+    if (!items || count == 0) {
+        return 0;
+    }
+
+    DetectionFrameContext ctx;
+    capture_detection_context(ctx);
+
+    // 整帧一次完成坐标转换（SoA 向量化），供区域筛选与报告构建使用
+    static thread_local SapientTrackBatch batch;
+    batch.convert(items, count, ctx.pose);
+
+    // Task 区域筛选在调度之前：被排除的航迹既不占上报预算，也不刷新存活时间
+    // origin[k] 为筛选后第 k 条航迹在 batch 中的下标
+    static thread_local std::vector<uint32_t> origin;
+    origin.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        origin[i] = (uint32_t)i;
+    }
+    size_t handled = 0;
+    if (ctx.filter) {
+        static thread_local std::vector<RadarTrackItem> accepted;
+        accepted.clear();
+        accepted.reserve(count);
+        origin.clear();
+        for (size_t i = 0; i < count; i++) {
+            if (ctx.filter->accept(items[i], batch, i)) {
+                accepted.push_back(items[i]);
+                origin.push_back((uint32_t)i);
+            }
+        }
+        SapientTaskFilterEngine::instance().record(accepted.size(), count - accepted.size());
+        handled = count - accepted.size();
+        items = accepted.data();
+        count = accepted.size();
+    }
+
+    static thread_local std::vector<uint8_t> selected;
+    size_t to_build = SapientTrackScheduler::instance().schedule(items, count, ctx.now_ms, max_reports, selected);
+
+    SapientScopedArena arena;
+    std::string json;
+    out_frames.reserve(out_frames.size() + to_build);
+
+    // report_id 按块预留：同一帧的报告 ID 连续递增
+    static const size_t kIdChunk = 32;
+    char report_ids[kIdChunk][SAPIENT_ULID_BUF_SIZE];
+    size_t built = 0;
+    for (size_t i = 0; i < count; i++) {
+        const RadarTrackItem &item = items[i];
+        if (!selected[i]) {
+            SapientTrackRegistry::instance().touch(item, ctx.now_ms);
+            handled++;
+            continue;
+        }
+        if (built % kIdChunk == 0) {
+            size_t n = (to_build - built < kIdChunk) ? to_build - built : kIdChunk;
+            sapient_ulid_reserve(report_ids, n, (unsigned long long)ctx.time.unix_ms());
+        }
+        auto *wrapper = arena.create<sapient_msg::bsi_flex_335_v2_0::SapientMessage>();
+        SapientFramePtr frame;
+        int ret = build_track_report(*wrapper, &item, batch, origin[i], report_ids[built % kIdChunk], ctx);
+        built++;
+        if (ret == 1) {
+            handled++;   // 被抑制：DMM 按上次报告的速度外推即可
+        } else if (ret == 0) {
+            if (sapient_serialize_to_frame(*wrapper, frame) == 0) {
+                sapient_json_render(*wrapper, "DetectionReport", json);
+                frame->set_conflate(SAPIENT_CONFLATE_LATEST, item.id);
+                out_frames.push_back(std::move(frame));
+                handled++;
+            } else {
+                std::cerr << "序列化 SapientMessage wrapper 到帧缓冲失败" << std::endl;
+                sapient_json_render(*wrapper, "DetectionReport", json, true);
+            }
+        }
+        arena.reset();
+    }
+
+    // 每帧雷达数据顺带检查一次超时航迹
+    std::vector<SapientLostTrack> lost;
+    if (SapientTrackRegistry::instance().collect_lost(ctx.now_ms, lost) > 0) {
+        append_lost_frames(out_frames, lost, ctx, arena);
+    }
+    return handled;
+}
+
+// 定时调用：为超过最大存活时间未出现的航迹构建 "lost" 报告（没有新雷达数据时也能及时通知 DMM）
+size_t sapient_build_lost_detection_frames(std::vector<SapientFramePtr> &out_frames)
+{
+    int64_t now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    std::vector<SapientLostTrack> lost;
+    if (SapientTrackRegistry::instance().collect_lost(now_ms, lost) == 0) {
+        return 0;   // 常见情况：没有丢失的航迹，不读取雷达状态
+    }
+
+    DetectionFrameContext ctx;
+    capture_detection_context(ctx);
+    SapientScopedArena arena;
+    return append_lost_frames(out_frames, lost, ctx, arena);
+}
+
 extern "C" {
     // 为 sapient_tcp.cpp 暴露的 C++ 接口
     // 基于 RadarTrackItem（应用层数据，0x12 消息）
@@ -9,13 +9,18 @@
 #include <cstring>
 #include <vector>
 #include <algorithm>
-#include <google/protobuf/util/json_util.h>
+#include <mutex>
+#include "sapient_json.h"
+#include "sapient_clock.h"
+#include "sapient_frame.h"
+#include "sky_registrationpb.h"
 #include <google/protobuf/timestamp.pb.h>
 
 extern "C" {
     #include "../../inc/GNSS_coordinate.h"
     #include "adapter/auto_hunt_param_adapter.h"
     #include "adapter/sn_adapter.h"
+    #include "adapter/radar_state_adapter.h"
     #include "../../srv/version/version.h"
 }
 
@@ -49,8 +54,8 @@ static void getSn(void)
  *         - 精度：毫秒级（3 位小数）
  * 
  * @note 
- * - 使用 std::gmtime() 获取 UTC 时间，不受系统本地时区影响
- * - 毫秒部分通过 std::chrono 高精度时钟计算，确保准确性
+ * - 基于 SapientTime（CLOCK_REALTIME），不受系统本地时区影响，线程安全
+ * - 需要与 protobuf Timestamp 保持一致时，直接使用同一个 SapientTime 采样
  * - 符合 ISO 8601 国际标准，适用于 SAPIENT 协议的时间戳字段
  * 
  * @example
@@ -59,30 +64,8 @@ static void getSn(void)
  */
 std::string getCurrentTimeISO8601() 
 {
-    // 获取当前时间点
-    auto now = std::chrono::system_clock::now();
-
-    // 转换为 time_t 类型，以便后续格式化
-    std::time_t now_time_t = std::chrono::system_clock::to_time_t(now);
-
-    // 使用 std::gmtime 将 time_t 转为 tm 格式（UTC 时间）
-    std::tm utc_tm = *std::gmtime(&now_time_t);
-
-    // 使用字符串流格式化时间
-    std::ostringstream oss;
-    oss << std::put_time(&utc_tm, "%Y-%m-%dT%H:%M:%S");
-
-    // 获取当前时间的毫秒部分
-    auto duration = now.time_since_epoch();
-    auto milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(duration) % 1000;
-
-    // 将毫秒部分添加到字符串
-    oss << '.' << std::setw(3) << std::setfill('0') << milliseconds.count();
-
-    // 添加 Z 以指示 UTC 时间
-    oss << 'Z';
-
-    return oss.str();
+    // 秒级前缀按线程缓存，同一秒内只拼接毫秒后缀（见 sapient_clock.h）
+    return SapientTime::now().iso8601();
 }
 
 /*从完整版本字符串中提取版本号部分（可选函数）*/
@@ -185,7 +168,11 @@ int sapient_register(void)
         return -1;
     }
 
-    // 打印 JSON 以便人工查看（保留原有行为）
+    // 打印 JSON 以便人工查看（JSON 渲染关闭时只打印长度）
+    if (out_json.empty()) {
+        std::cout << "Registration built (" << out_bin.size() << " bytes); JSON rendering is disabled" << std::endl;
+        return 0;
+    }
     std::cout << "Serialized JSON output (SapientMessage wrapper): " << std::endl;
     std::cout << out_json << std::endl;
 
@@ -194,21 +181,14 @@ int sapient_register(void)
 }
 
 // ---------------------------------------------------------------------------
-// 可复用的构建函数
-// 构造 SkyRegistrationMessage，返回二进制 protobuf 到 out_serialized
-// 和格式化的 JSON 表示到 out_json。成功返回 0，失败返回 -1。
-// 该函数为 C++ 链接，可以从其他 C++ 转换单元调用
-// （例如在 `sapient_tcp.cpp` 中实现的 TCP 发送器）。
-int sapient_build_registration(std::string &out_serialized, std::string &out_json)
+// 构造不含顶层 timestamp 的 SapientMessage（node_id + registration）。
+// 内容只依赖设备 SN、产品名称、软件版本与视场配置，由下方的注册报文缓存调用。
+static void build_registration_wrapper(sapient_msg::bsi_flex_335_v2_0::SapientMessage &wrapper)
 {
     sapient_msg::bsi_flex_335_v2_0::SkyRegistrationMessage pbmsg;
 
     getSn();
 
-    /*timestamp*/
-    std::string timestamp = getCurrentTimeISO8601();
-    pbmsg.set_timestamp(timestamp);
-
     /*nodeId - 使用 UUID v5 基于设备序列号生成（确定性，符合 UUID 格式）*/
     std::string node_id = generateNodeID();
     pbmsg.set_nodeid(node_id);
@@ -632,39 +612,173 @@ int sapient_build_registration(std::string &out_serialized, std::string &out_jso
     // configdatasub->set_software_version("2.0.0");
 
     // 构造 SapientMessage wrapper，并将 pbmsg 的 registration 放入 oneof 中，
-    // 同时将 node_id 和 timestamp 放到 wrapper 顶层（避免对端解析错误）。
-    sapient_msg::bsi_flex_335_v2_0::SapientMessage wrapper;
+    // 同时将 node_id 放到 wrapper 顶层（避免对端解析错误）；timestamp 在发送时单独编码。
+    wrapper.Clear();
     if (pbmsg.nodeid().size() > 0) {
         wrapper.set_node_id(pbmsg.nodeid());
     }
-    // 顶层 timestamp 使用 google::protobuf::Timestamp 类型，
-    // 直接用当前系统时间填充 seconds/nanos，避免使用字符串赋值导致的类型不匹配。
-    {
-        auto now = std::chrono::system_clock::now();
-        auto secs = std::chrono::duration_cast<std::chrono::seconds>(now.time_since_epoch()).count();
-        auto nanos_total = std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count();
-        int nanos = static_cast<int>(nanos_total - secs * 1000000000LL);
-        google::protobuf::Timestamp* ts = wrapper.mutable_timestamp();
-        ts->set_seconds(static_cast<long long>(secs));
-        ts->set_nanos(nanos);
+    // 把 registration 字段移入 wrapper 的 registration oneof
+    wrapper.mutable_registration()->Swap(pbmsg.mutable_registration());
+}
+
+// ---------------------------------------------------------------------------
+// 注册报文缓存
+// 首次连接、断线超过 2 分钟重连、RegistrationAck 超时以及 "Registration" 任务都会发送注册报文，
+// 而其内容在设备运行期间几乎不变。这里只在输入变化时重建并序列化一次，
+// 之后每次发送只需编码新的顶层 timestamp 并与缓存的字节拼接。
+namespace {
+
+struct RegistrationCache {
+    std::mutex mutex;
+    bool valid;
+    unsigned int state_generation;   // 上次检查 SN 时的 RadarState 版本号
+    std::string sn;
+    std::string version;             // get_embed_software_ps_version_string() 原文
+    std::string body;                // 不含 timestamp 的 SapientMessage 序列化结果
+    sapient_msg::bsi_flex_335_v2_0::SapientMessage wrapper;   // 仅用于 JSON 渲染
+    unsigned long long builds;
+    unsigned long long hits;
+
+    RegistrationCache() : valid(false), state_generation(0), builds(0), hits(0) {}
+};
+
+RegistrationCache &registration_cache()
+{
+    static RegistrationCache *cache = new RegistrationCache();
+    return *cache;
+}
+
+// timestamp 字段：1 字节 tag + 1 字节长度 + Timestamp（seconds/nanos 最多 17 字节）
+const size_t kMaxTimestampField = 24;
+
+// 编码顶层 timestamp 字段（字段号 1）。字段按编号升序写在缓存的 node_id(2) / registration(4)
+// 之前，与整条消息直接序列化的结果逐字节相同。
+size_t encode_timestamp_field(const SapientTime &now, uint8_t *out)
+{
+    google::protobuf::Timestamp ts;
+    now.to_timestamp(&ts);
+    size_t len = ts.ByteSizeLong();
+    out[0] = 0x0A;                  // (1 << 3) | WIRETYPE_LENGTH_DELIMITED
+    out[1] = (uint8_t)len;          // len < 128，单字节 varint
+    ts.SerializeWithCachedSizesToArray(out + 2);
+    return 2 + len;
+}
+
+// 判断缓存输入是否变化（持锁调用）。产品名称与视场配置为编译期常量，
+// 运行时修改由 sapient_registration_invalidate() 通知。
+bool registration_inputs_changed(RegistrationCache &cache)
+{
+    if (!cache.valid) return true;
+
+    const char *full_version = get_embed_software_ps_version_string();
+    if (cache.version != (full_version ? full_version : "")) return true;
+
+    // SN 优先取自 RadarState，RadarState 未更新时无需重新读取
+    unsigned int generation = get_radar_state_generation();
+    if (generation != cache.state_generation) {
+        cache.state_generation = generation;
+        char buffer[SN_MAX_SIZE+1] = {0};
+        if (read_sn(buffer, SN_MAX_SIZE) >= 0 && cache.sn != buffer) return true;
     }
-    // 把 registration 字段拷入 wrapper 的 registration oneof
-    wrapper.mutable_registration()->CopyFrom(pbmsg.registration());
+    return false;
+}
 
-    // 序列化 wrapper 到二进制
-    if (!wrapper.SerializeToString(&out_serialized)) {
+// 确保缓存有效（持锁调用）
+int ensure_registration_cache(RegistrationCache &cache)
+{
+    if (!registration_inputs_changed(cache)) {
+        cache.hits++;
+        return 0;
+    }
+
+    cache.valid = false;
+    cache.state_generation = get_radar_state_generation();
+    build_registration_wrapper(cache.wrapper);
+    if (!cache.wrapper.SerializeToString(&cache.body)) {
         std::cerr << "Failed to serialize SapientMessage wrapper in builder" << std::endl;
+        std::string json;
+        sapient_json_render(cache.wrapper, "Registration", json, true);
         return -1;
     }
+    const char *full_version = get_embed_software_ps_version_string();
+    cache.sn = g_sn;
+    cache.version = full_version ? full_version : "";
+    cache.valid = true;
+    cache.builds++;
+    std::cout << "Registration cache rebuilt (" << cache.body.size() << " bytes, build #"
+              << cache.builds << ")" << std::endl;
+    return 0;
+}
 
-    // 序列化 wrapper 到 JSON（用于调试/日志）
-    google::protobuf::util::JsonOptions options; 
-    options.add_whitespace = true;  // 格式化输出增加可读性
-    auto status = google::protobuf::util::MessageToJsonString(wrapper, &out_json, options);
-    if (!status.ok()) {
-        std::cerr << "Failed to convert wrapper message to JSON format: " << status.ToString() << std::endl;
-        return -1;
+// 按 sapient_json.h 的渲染策略生成 JSON（持锁调用）；渲染时临时带上本次的 timestamp
+void render_registration_json(RegistrationCache &cache, const SapientTime &now, std::string &out_json)
+{
+    if (sapient_json_get_mode() == SAPIENT_JSON_OFF) {
+        out_json.clear();
+        return;
     }
+    now.to_timestamp(cache.wrapper.mutable_timestamp());
+    sapient_json_render(cache.wrapper, "Registration", out_json);
+    cache.wrapper.clear_timestamp();
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// 可复用的构建函数
+// 返回二进制 SapientMessage（Registration）到 out_serialized
+// 和格式化的 JSON 表示到 out_json。成功返回 0，失败返回 -1。
+// 该函数为 C++ 链接，可以从其他 C++ 转换单元调用。
+int sapient_build_registration(std::string &out_serialized, std::string &out_json)
+{
+    RegistrationCache &cache = registration_cache();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    if (ensure_registration_cache(cache) != 0) return -1;
+
+    const SapientTime now = SapientTime::now();
+    uint8_t ts_field[kMaxTimestampField];
+    size_t ts_len = encode_timestamp_field(now, ts_field);
+    out_serialized.reserve(ts_len + cache.body.size());
+    out_serialized.assign((const char *)ts_field, ts_len);
+    out_serialized.append(cache.body);
+
+    render_registration_json(cache, now, out_json);
+    return 0;
+}
 
+// 直接组帧到池化帧缓冲（TCP 发送路径使用，不经过中间 std::string）
+int sapient_build_registration_frame(SapientFramePtr &out)
+{
+    RegistrationCache &cache = registration_cache();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    if (ensure_registration_cache(cache) != 0) return -1;
+
+    const SapientTime now = SapientTime::now();
+    out = SapientFramePool::instance().acquire(kMaxTimestampField + cache.body.size());
+    size_t ts_len = encode_timestamp_field(now, out->body());
+    memcpy(out->body() + ts_len, cache.body.data(), cache.body.size());
+    out->commit(ts_len + cache.body.size());
+
+    std::string json;
+    render_registration_json(cache, now, json);
     return 0;
-}
\ No newline at end of file
+}
+
+extern "C" {
+
+void sapient_registration_invalidate(void)
+{
+    RegistrationCache &cache = registration_cache();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    cache.valid = false;
+}
+
+void sapient_registration_get_cache_stats(unsigned long long *builds, unsigned long long *hits)
+{
+    RegistrationCache &cache = registration_cache();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    if (builds) *builds = cache.builds;
+    if (hits) *hits = cache.hits;
+}
+
+} // extern "C"
@@ -12,8 +12,25 @@ extern "C" {
 
 int sapient_register(void);
 
+/* 注册报文缓存失效：SN、产品名称、软件版本或视场配置在运行时变化后调用，
+ * 下次发送 Registration 时重新构建。SN 与软件版本的变化会被自动检测。
+ */
+void sapient_registration_invalidate(void);
+
+/* 注册报文缓存统计：builds 为重建次数，hits 为直接复用缓存的次数（参数可为 NULL） */
+void sapient_registration_get_cache_stats(unsigned long long *builds, unsigned long long *hits);
+
 #ifdef __cplusplus
 }
+
+#include <string>
+#include "sapient_frame.h"
+
+// 构建 Registration：缓存字节前拼接本次的顶层 timestamp，成功返回 0，失败返回 -1
+int sapient_build_registration(std::string &out_serialized, std::string &out_json);
+
+// 同上，直接组帧到池化帧缓冲（含 4 字节长度前缀），供 TCP 发送路径使用
+int sapient_build_registration_frame(SapientFramePtr &out);
 #endif
 
 
@@ -4,11 +4,14 @@
 #include <cstdint>
 #include <limits>
 #include <cmath>
-#include <google/protobuf/util/json_util.h>
+#include <mutex>
 #include <google/protobuf/timestamp.pb.h>
 #include "../sapient/status_report.pb.h"
 #include "../sapient/sapient_message.pb.h"
 #include "sapient_nodeid.h"
+#include "sapient_frame.h"
+#include "sapient_json.h"
+#include "sapient_clock.h"
 
 extern std::string getCurrentTimeISO8601();
 
@@ -20,8 +23,8 @@ extern "C" {
     #include "adapter/radar_state_adapter.h"
 }
 
-// 声明在 sky_detection_reportpb.cpp 中实现的 ULID 生成函数
-extern "C" void generate_ulid(char *ulid);
+// 单调 ULID 生成函数
+#include "sapient_ulid.h"
 
 // 声明在 sky_task_handler.cpp 中实现的任务查询函数（C++ 函数）
 #include "sky_task_handler.h"
@@ -84,6 +87,12 @@ static StatusSnapshot last_snapshot = {
     -999.0f                          // temperature
 };
 
+// 最近一次完整状态报告（report_id、active_task_id 每次重新设置）；
+// 与 last_snapshot 一起由 g_status_mutex 保护
+static std::mutex g_status_mutex;
+static sapient_msg::bsi_flex_335_v2_0::StatusReport g_full_status;
+static bool g_full_status_valid = false;
+
 // 解析雷达状态位（Bit 定义参见 RadarState.status 注释）
 static void parse_radar_status(uint32_t status, 
                                uint8_t *motion_state,    // B2B1B0: 静止/运动/转动
@@ -103,127 +112,13 @@ static void parse_radar_status(uint32_t status,
     *attitude_source = (status >> 15) & 0x03; // Bit 15-16
 }
 
-// C++ 构建函数：生成二进制 protobuf 和 JSON（用于日志/调试）
-// 构造 StatusReport，封装进 SapientMessage wrapper，返回序列化的 wrapper
-int sapient_build_status_report(std::string &out_serialized, std::string &out_json)
+// 填充完整状态报告的可选部分（位置、电源、视场与全部状态条目）；
+// 只在状态变化或 DMM 通过 "Status" 任务请求时构建，心跳只携带必选字段
+static void fill_full_status_report(sapient_msg::bsi_flex_335_v2_0::StatusReport &statusrepo,
+                                    const RadarState &radar_state,
+                                    const radar_sensor_sample_t &sensors,
+                                    bool has_sensors)
 {
-    // 使用生成的 protobuf 类型 StatusReport
-    sapient_msg::bsi_flex_335_v2_0::StatusReport statusrepo;
-
-    // 生成并设置 report_id
-    char ulid[27] = {0};
-    generate_ulid(ulid);
-    statusrepo.set_report_id(ulid);
-
-    // 设置 active_task_id（当前执行的任务 ID）
-    std::string current_task_id = sapient_get_current_task_id();
-    if (!current_task_id.empty()) {
-        statusrepo.set_active_task_id(current_task_id);
-    }
-
-    // ======================== 获取雷达状态数据 ========================
-    RadarState radar_state;
-    memset(&radar_state, 0, sizeof(RadarState));
-    int ret = get_radar_state(&radar_state);
-    if (ret != 0) {
-        std::cerr << "Warning: Failed to get radar state, using default values" << std::endl;
-    }
-
-    // 提取关键字段，构建当前状态快照
-    uint8_t maxFaultLevel = 0;
-    if (radar_state.faultCount > 0) {
-        for (uint32_t i = 0; i < radar_state.faultCount && i < 64; i++) {
-            if (radar_state.fault[i].faultLevel > maxFaultLevel) {
-                maxFaultLevel = radar_state.fault[i].faultLevel;
-            }
-        }
-    }
-    
-    // 获取功能状态
-    int track_enabled = get_track_enabled_status();
-    int otm_mode = get_otm_mode_status();
-    
-    // 获取杂波抑制状态
-    clutter_status_t clutter_status;
-    memset(&clutter_status, 0, sizeof(clutter_status_t));
-    get_clutter_status(&clutter_status);
-    
-    // 获取温度
-    float temperature = get_radar_temperature();
-
-    StatusSnapshot current = {
-        // 基础状态
-        radar_state.has_sysStatus ? radar_state.sysStatus : 0,
-        radar_state.faultCount,
-        maxFaultLevel,
-        // 位置和姿态
-        radar_state.has_radarLLA ? radar_state.radarLLA.longitude : 0.0,
-        radar_state.has_radarLLA ? radar_state.radarLLA.latitude : 0.0,
-        radar_state.has_radarLLA ? radar_state.radarLLA.altitude : 0.0,
-        (radar_state.has_attitude && radar_state.attitude.has_heading) ? radar_state.attitude.heading : 0.0,
-        (radar_state.has_attitude && radar_state.attitude.has_pitching) ? radar_state.attitude.pitching : 0.0,
-        (radar_state.has_attitude && radar_state.attitude.has_rolling) ? radar_state.attitude.rolling : 0.0,
-        // 功能状态
-        static_cast<bool>(track_enabled),
-        static_cast<bool>(otm_mode),
-        // 杂波抑制状态
-        static_cast<uint32_t>(clutter_status.filter_level),
-        static_cast<bool>(clutter_status.weather_clutter_filter),
-        // 温度
-        temperature
-    };
-
-    // 判断 info 字段：状态是否有变化
-    if (current == last_snapshot) {
-        statusrepo.set_info(sapient_msg::bsi_flex_335_v2_0::StatusReport_Info_INFO_UNCHANGED);
-    } else {
-        statusrepo.set_info(sapient_msg::bsi_flex_335_v2_0::StatusReport_Info_INFO_NEW);
-        last_snapshot = current;  // 更新上次快照
-    }
-
-    // ======================== system 映射 ========================
-    // 根据最高故障级别判断系统状态
-    sapient_msg::bsi_flex_335_v2_0::StatusReport_System sys_enum;
-    if (maxFaultLevel == 0x03) {
-        // 0x03: 无法使用
-        sys_enum = sapient_msg::bsi_flex_335_v2_0::StatusReport_System_SYSTEM_ERROR;
-    } else if (maxFaultLevel == 0x02) {
-        // 0x02: 功能受限
-        sys_enum = sapient_msg::bsi_flex_335_v2_0::StatusReport_System_SYSTEM_WARNING;
-    } else if (maxFaultLevel == 0x01) {
-        // 0x01: 告警信息
-        sys_enum = sapient_msg::bsi_flex_335_v2_0::StatusReport_System_SYSTEM_WARNING;
-    } else if (radar_state.has_sysStatus && 
-               (radar_state.sysStatus == 3 || radar_state.sysStatus == 4 || radar_state.sysStatus == 5)) {
-        // 系统状态：待机/正常探测/搜索模式
-        sys_enum = sapient_msg::bsi_flex_335_v2_0::StatusReport_System_SYSTEM_OK;
-    } else {
-        // 其他状态：初始化、自检等
-        sys_enum = sapient_msg::bsi_flex_335_v2_0::StatusReport_System_SYSTEM_UNSPECIFIED;
-    }
-    statusrepo.set_system(sys_enum);
-
-    // ======================== mode 映射 ========================
-    // 根据系统状态 (sysStatus) 和雷达状态位 (status) 综合判断
-    std::string mode_str = "unknown";
-    if (radar_state.has_sysStatus) {
-        switch (radar_state.sysStatus) {
-            case 0: mode_str = "default"; break;
-            case 1: mode_str = "initializing"; break;
-            case 2: mode_str = "self_checking"; break;
-            case 3: mode_str = "standby"; break;
-            case 4: mode_str = "normal_detection"; break;  // TAS/TWS切换
-            case 5: mode_str = "search_mode"; break;       // TWS
-            case 6: mode_str = "fire_control"; break;      // 预留
-            case 11: mode_str = "test_mode"; break;
-            case 22: mode_str = "factory_mode"; break;
-            case 33: mode_str = "mesh_network"; break;
-            case 99: mode_str = "error"; break;
-            default: mode_str = "unknown"; break;
-        }
-    }
-    statusrepo.set_mode(mode_str);
-
     // ======================== node_location（设备节点位置）========================
     if (radar_state.has_radarLLA && 
         (radar_state.radarLLA.longitude != 0.0 || radar_state.radarLLA.latitude != 0.0)) {
@@ -395,7 +290,7 @@ int sapient_build_status_report(std::string &out_serialized, std::string &out_js
     }
     
     // 1.5. 检测状态（trackEnabled）
-    // 注意：track_enabled 已在快照构建时获取，这里直接使用
+    // 注意：track_enabled 来自传感器采样快照（sensors.track_enabled）
     // if (!track_enabled) {
     //     // 如果雷达未启动侦测，报告 NOT_DETECTING
     //     add_status(StatusReport_StatusLevel_STATUS_LEVEL_WARNING_STATUS,
@@ -404,8 +299,8 @@ int sapient_build_status_report(std::string &out_serialized, std::string &out_js
     // }
     
     // 1.6. OTM 模式（运动灵敏度相关）
-    // 注意：otm_mode 已在快照构建时获取，这里直接使用
-    if (otm_mode) {
+    // 注意：otm_mode 来自传感器采样快照
+    if (sensors.otm_mode) {
         add_status(StatusReport_StatusLevel_STATUS_LEVEL_INFORMATION_STATUS,
                    StatusReport_StatusType_STATUS_TYPE_MOTION_SENSITIVITY,
                    "OTM_Mode_Enabled");
@@ -416,8 +311,9 @@ int sapient_build_status_report(std::string &out_serialized, std::string &out_js
     }
 
     // 2. 杂波抑制状态（Clutter）
-    // 注意：clutter_status 已在快照构建时获取，这里直接使用
-    if (get_clutter_status(&clutter_status) == 0) {
+    // 注意：杂波状态来自传感器采样快照，不再重复读取系统配置
+    if (has_sensors) {
+        const clutter_status_t &clutter_status = sensors.clutter;
         char clutter_str[128];
         
         // 滤波等级（杂波相关）
@@ -439,7 +335,8 @@ int sapient_build_status_report(std::string &out_serialized, std::string &out_js
     }
 
     // 3. 温度
-    // 注意：temperature 已在快照构建时获取，这里直接使用
+    // 注意：温度来自传感器采样快照，不在构建路径上读取硬件寄存器
+    float temperature = sensors.temperature;
     if (temperature > 0.0f) {
         char temp_str[64];
         snprintf(temp_str, sizeof(temp_str), "Temperature=%.1f°C", temperature);
@@ -472,43 +369,189 @@ int sapient_build_status_report(std::string &out_serialized, std::string &out_js
             add_status(fault_level, StatusReport_StatusType_STATUS_TYPE_INTERNAL_FAULT, fault_str);
         }
     }
+}
+
+// 构造 StatusReport，封装进 SapientMessage wrapper
+// 状态无变化且未要求完整报告时只发送必选字段（report_id、system、info、mode）与 INFO_UNCHANGED；
+// full 为 true 时（RegistrationAck 后的初始状态、DMM 的 "Status" 任务）始终发送完整报告
+static int build_status_report_wrapper(sapient_msg::bsi_flex_335_v2_0::SapientMessage &wrapper, bool full)
+{
+    // 直接在 wrapper 的 status_report oneof 中构建
+    sapient_msg::bsi_flex_335_v2_0::StatusReport &statusrepo = *wrapper.mutable_status_report();
+
+    // 报文时间：report_id 的 ULID 与 wrapper Timestamp 共用一次时钟采样
+    const SapientTime now = SapientTime::now();
+
+    // ======================== 获取雷达状态数据 ========================
+    RadarState radar_state;
+    memset(&radar_state, 0, sizeof(RadarState));
+    int ret = get_radar_state(&radar_state);
+    if (ret != 0) {
+        std::cerr << "Warning: Failed to get radar state, using default values" << std::endl;
+    }
+
+    // 提取关键字段，构建当前状态快照
+    uint8_t maxFaultLevel = 0;
+    if (radar_state.faultCount > 0) {
+        for (uint32_t i = 0; i < radar_state.faultCount && i < 64; i++) {
+            if (radar_state.fault[i].faultLevel > maxFaultLevel) {
+                maxFaultLevel = radar_state.fault[i].faultLevel;
+            }
+        }
+    }
+    
+    // 功能状态、杂波抑制状态与温度：读取传感器采样器发布的快照（不接触硬件与配置管理器）
+    radar_sensor_sample_t sensors;
+    bool has_sensors = (get_radar_sensor_sample(&sensors) == 0);
+    if (!has_sensors) {
+        std::cerr << "Warning: No sensor sample yet, using default values" << std::endl;
+    }
+
+    StatusSnapshot current = {
+        // 基础状态
+        radar_state.has_sysStatus ? radar_state.sysStatus : 0,
+        radar_state.faultCount,
+        maxFaultLevel,
+        // 位置和姿态
+        radar_state.has_radarLLA ? radar_state.radarLLA.longitude : 0.0,
+        radar_state.has_radarLLA ? radar_state.radarLLA.latitude : 0.0,
+        radar_state.has_radarLLA ? radar_state.radarLLA.altitude : 0.0,
+        (radar_state.has_attitude && radar_state.attitude.has_heading) ? radar_state.attitude.heading : 0.0,
+        (radar_state.has_attitude && radar_state.attitude.has_pitching) ? radar_state.attitude.pitching : 0.0,
+        (radar_state.has_attitude && radar_state.attitude.has_rolling) ? radar_state.attitude.rolling : 0.0,
+        // 功能状态
+        static_cast<bool>(sensors.track_enabled),
+        static_cast<bool>(sensors.otm_mode),
+        // 杂波抑制状态
+        static_cast<uint32_t>(sensors.clutter.filter_level),
+        static_cast<bool>(sensors.clutter.weather_clutter_filter),
+        // 温度
+        sensors.temperature
+    };
+
+    // ======================== system 映射 ========================
+    // 根据最高故障级别判断系统状态
+    sapient_msg::bsi_flex_335_v2_0::StatusReport_System sys_enum;
+    if (maxFaultLevel == 0x03) {
+        // 0x03: 无法使用
+        sys_enum = sapient_msg::bsi_flex_335_v2_0::StatusReport_System_SYSTEM_ERROR;
+    } else if (maxFaultLevel == 0x02) {
+        // 0x02: 功能受限
+        sys_enum = sapient_msg::bsi_flex_335_v2_0::StatusReport_System_SYSTEM_WARNING;
+    } else if (maxFaultLevel == 0x01) {
+        // 0x01: 告警信息
+        sys_enum = sapient_msg::bsi_flex_335_v2_0::StatusReport_System_SYSTEM_WARNING;
+    } else if (radar_state.has_sysStatus && 
+               (radar_state.sysStatus == 3 || radar_state.sysStatus == 4 || radar_state.sysStatus == 5)) {
+        // 系统状态：待机/正常探测/搜索模式
+        sys_enum = sapient_msg::bsi_flex_335_v2_0::StatusReport_System_SYSTEM_OK;
+    } else {
+        // 其他状态：初始化、自检等
+        sys_enum = sapient_msg::bsi_flex_335_v2_0::StatusReport_System_SYSTEM_UNSPECIFIED;
+    }
+
+    // ======================== mode 映射 ========================
+    // 根据系统状态 (sysStatus) 和雷达状态位 (status) 综合判断
+    std::string mode_str = "unknown";
+    if (radar_state.has_sysStatus) {
+        switch (radar_state.sysStatus) {
+            case 0: mode_str = "default"; break;
+            case 1: mode_str = "initializing"; break;
+            case 2: mode_str = "self_checking"; break;
+            case 3: mode_str = "standby"; break;
+            case 4: mode_str = "normal_detection"; break;  // TAS/TWS切换
+            case 5: mode_str = "search_mode"; break;       // TWS
+            case 6: mode_str = "fire_control"; break;      // 预留
+            case 11: mode_str = "test_mode"; break;
+            case 22: mode_str = "factory_mode"; break;
+            case 33: mode_str = "mesh_network"; break;
+            case 99: mode_str = "error"; break;
+            default: mode_str = "unknown"; break;
+        }
+    }
+
+    // 判断 info 字段：状态是否有变化
+    std::lock_guard<std::mutex> lock(g_status_mutex);
+    bool changed = !(current == last_snapshot);
+    if (changed) {
+        last_snapshot = current;  // 更新上次快照
+    }
+
+    if (changed || (full && !g_full_status_valid)) {
+        // 状态变化：重新构建完整报告并缓存
+        fill_full_status_report(statusrepo, radar_state, sensors, has_sensors);
+        g_full_status = statusrepo;
+        g_full_status_valid = true;
+    } else if (full) {
+        // 状态未变但需要完整报告：复用缓存
+        statusrepo = g_full_status;
+    }
+
+    // 必选字段（缓存的完整报告中不含 report_id 与 active_task_id）
+    char ulid[SAPIENT_ULID_BUF_SIZE];
+    sapient_ulid_generate_at(ulid, (unsigned long long)now.unix_ms());
+    statusrepo.set_report_id(ulid, SAPIENT_ULID_LEN);
+    statusrepo.set_system(sys_enum);
+    statusrepo.set_info(changed ? sapient_msg::bsi_flex_335_v2_0::StatusReport_Info_INFO_NEW
+                                : sapient_msg::bsi_flex_335_v2_0::StatusReport_Info_INFO_UNCHANGED);
+    statusrepo.set_mode(mode_str);
+
+    // 设置 active_task_id（当前执行的任务 ID）
+    std::string current_task_id = sapient_get_current_task_id();
+    if (!current_task_id.empty()) {
+        statusrepo.set_active_task_id(current_task_id);
+    } else {
+        statusrepo.clear_active_task_id();
+    }
 
     // ======================== 构造 SapientMessage wrapper ========================
-    sapient_msg::bsi_flex_335_v2_0::SapientMessage wrapper;
     std::string node_id = generateNodeID();
     if (node_id.size() > 0) {
         wrapper.set_node_id(node_id);
     }
     
     // 顶层 timestamp 使用 google::protobuf::Timestamp 类型
-    {
-        auto now = std::chrono::system_clock::now();
-        auto secs = std::chrono::duration_cast<std::chrono::seconds>(now.time_since_epoch()).count();
-        auto nanos_total = std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count();
-        int nanos = static_cast<int>(nanos_total - secs * 1000000000LL);
-        google::protobuf::Timestamp* ts = wrapper.mutable_timestamp();
-        ts->set_seconds(static_cast<long long>(secs));
-        ts->set_nanos(nanos);
+    now.to_timestamp(wrapper.mutable_timestamp());
+
+    return 0;
+}
+
+// C++ 构建函数：生成二进制 protobuf 和 JSON（用于日志/调试，按 sapient_json.h 的渲染策略生成）
+// 构造 StatusReport，封装进 SapientMessage wrapper，返回序列化的 wrapper
+int sapient_build_status_report(std::string &out_serialized, std::string &out_json)
+{
+    sapient_msg::bsi_flex_335_v2_0::SapientMessage wrapper;
+    if (build_status_report_wrapper(wrapper, false) != 0) {
+        return -1;
     }
-    
-    // 把 status_report 字段拷入 wrapper 的 status_report oneof
-    wrapper.mutable_status_report()->CopyFrom(statusrepo);
 
     // 序列化 wrapper 到二进制
     if (!wrapper.SerializeToString(&out_serialized)) {
         std::cerr << "序列化 SapientMessage wrapper 失败" << std::endl;
+        sapient_json_render(wrapper, "StatusReport", out_json, true);
         return -1;
     }
 
-    // 序列化 wrapper 到 JSON（用于调试/日志）
-    google::protobuf::util::JsonOptions options; 
-    options.add_whitespace = true;
-    auto status = google::protobuf::util::MessageToJsonString(wrapper, &out_json, options);
-    if (!status.ok()) {
-        std::cerr << "将 wrapper message 转换为 JSON 失败: " << status.ToString() << std::endl;
+    sapient_json_render(wrapper, "StatusReport", out_json);
+    return 0;
+}
+
+// 帧缓冲版本：直接序列化到池化帧（已带长度前缀），供发送热路径使用
+// full 为 false 时状态无变化只发送紧凑心跳，为 true 时始终发送完整报告
+int sapient_build_status_report_frame(SapientFramePtr &out_frame, std::string &out_json, bool full)
+{
+    sapient_msg::bsi_flex_335_v2_0::SapientMessage wrapper;
+    if (build_status_report_wrapper(wrapper, full) != 0) {
+        return -1;
+    }
+
+    if (sapient_serialize_to_frame(wrapper, out_frame) != 0) {
+        std::cerr << "序列化 SapientMessage wrapper 到帧缓冲失败" << std::endl;
+        sapient_json_render(wrapper, "StatusReport", out_json, true);
         return -1;
     }
 
+    sapient_json_render(wrapper, "StatusReport", out_json);
     return 0;
 }
 
@@ -519,6 +562,10 @@ extern "C" {
         std::string bin, json;
         int rc = sapient_build_status_report(bin, json);
         if (rc != 0) return rc;
+        if (json.empty()) {
+            std::cout << "StatusReport built (" << bin.size() << " bytes); JSON rendering is disabled" << std::endl;
+            return 0;
+        }
         std::cout << "Serialized JSON output: " << std::endl;
         std::cout << json << std::endl;
         return 0;
@@ -3,14 +3,17 @@
 #include "../sapient/sapient_message.pb.h"
 #include "sky_task_handler.h"
 #include "sapient_nodeid.h"
+#include "sapient_task_filter.h"
 #include <iostream>
 #include <chrono>
 #include <string>
 #include <algorithm>
 #include <cctype>
-#include <google/protobuf/util/json_util.h>
+#include "sapient_json.h"
+#include "sapient_clock.h"
 #include <google/protobuf/timestamp.pb.h>
 #include <mutex>
+#include <memory>
 
 // 定义日志模块标签
 #define LOG_TAG "sapient_task"
@@ -39,11 +42,7 @@ static bool iequals(const std::string &a, const std::string &b) {
 // 工具函数：为消息封装设置当前 UTC 时间戳
 static void set_current_timestamp(::google::protobuf::Timestamp *ts)
 {
-    auto now = std::chrono::system_clock::now();
-    auto seconds = std::chrono::duration_cast<std::chrono::seconds>(now.time_since_epoch()).count();
-    auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count() % 1000000000;
-    ts->set_seconds(seconds);
-    ts->set_nanos((int32_t)nanos);
+    SapientTime::now().to_timestamp(ts);
 }
 
 // 内部处理：解析接收到的 Task 并决定是否接受
@@ -57,8 +56,7 @@ static bool handle_task_internal(const sapient_msg::bsi_flex_335_v2_0::Task &tas
     action_out = TASK_ACTION_NONE;
     
     // 打印收到的任务 ID 与控制指令
-    std::string task_id = task.has_task_id() ? task.task_id() : "(no task_id)";
-    LOGI("received Sapient Task: task_id=%s\n", task_id.c_str());
+    LOGI("received Sapient Task: task_id=%s\n", task.has_task_id() ? task.task_id().c_str() : "(no task_id)");
 
     // 提取顶层控制指令（control 字段）
     if (task.has_control()) {
@@ -75,7 +73,7 @@ static bool handle_task_internal(const sapient_msg::bsi_flex_335_v2_0::Task &tas
 
     // 提取 command.request 字段（关键：判断任务类型）
     if (task.has_command() && task.command().has_request()) {
-        std::string request = task.command().request();
+        const std::string &request = task.command().request();
         LOGI("  Task command.request=%s\n", request.c_str());
         
         // 根据请求类型设置响应动作（支持不区分大小写匹配）
@@ -92,81 +90,109 @@ static bool handle_task_internal(const sapient_msg::bsi_flex_335_v2_0::Task &tas
         reason_out = "Task accepted for processing";
     }
 
-    // 提取区域（如存在）
-    if (task.region_size() > 0) {
+    // 区域与筛选器：编译后替换当前生效的筛选（STOP/PAUSE 时清除，其它任务不带区域 START 时清除）；
+    // 无法编译的区域拒绝整个任务
+    if (task.region_size() > 0 || task.has_control()) {
         LOGI("  Task region count=%d\n", task.region_size());
+        std::string filter_reason;
+        if (SapientTaskFilterEngine::instance().apply_task(task, filter_reason) != 0) {
+            reason_out = "Task rejected: " + filter_reason;
+            action_out = TASK_ACTION_NONE;
+            return false;
+        }
+        if (!filter_reason.empty()) {
+            reason_out += " (" + filter_reason + ")";
+        }
     }
 
-    // 目前：统一接受所有任务
-    // TODO：实现真实任务执行与校验（启动/停止检测、应用筛选器等）
+    // 目前：区域筛选之外的内容统一接受
+    // TODO：control 的 START/STOP/PAUSE 只作用于区域筛选，尚未启停雷达检测；
+    //       command 中 request 以外的指令（detection_threshold、detection_report_rate、
+    //       classification_threshold、mode_change、look_at、move_to、patrol、follow）只接受不执行
     return true;
 }
 
 // 构建 TaskAck 响应，并封装到 SapientMessage。
-// 成功返回 0，失败返回 -1。
-// out_serialized：封装 TaskAck 的 SapientMessage 二进制
-// out_json：便于调试的 JSON 文本
-int sapient_build_task_ack(std::string &out_serialized, std::string &out_json,
-                            const std::string &task_id_in, bool accepted, const std::string &reason_in)
+static void build_task_ack_wrapper(sapient_msg::bsi_flex_335_v2_0::SapientMessage &wrapper,
+                                   const std::string &task_id_in, bool accepted, const std::string &reason_in)
 {
     using namespace sapient_msg::bsi_flex_335_v2_0;
 
-    // Build TaskAck message
-    TaskAck ack;
+    // 直接在封装消息内构建 TaskAck（与封装消息共用 arena，不再额外拷贝）
+    TaskAck *ack = wrapper.mutable_task_ack();
     if (!task_id_in.empty()) {
-        ack.set_task_id(task_id_in);
+        ack->set_task_id(task_id_in);
     }
     if (accepted) {
-        ack.set_task_status(TaskAck::TASK_STATUS_ACCEPTED);
+        ack->set_task_status(TaskAck::TASK_STATUS_ACCEPTED);
     } else {
-        ack.set_task_status(TaskAck::TASK_STATUS_REJECTED);
+        ack->set_task_status(TaskAck::TASK_STATUS_REJECTED);
     }
     if (!reason_in.empty()) {
-        ack.add_reason(reason_in);
+        ack->add_reason(reason_in);
     }
 
     // 将 TaskAck 封装到 SapientMessage 中
-    SapientMessage wrapper;
     set_current_timestamp(wrapper.mutable_timestamp());
     std::string node_id = generateNodeID();
     if (!node_id.empty()) {
         wrapper.set_node_id(node_id);
     }
-    wrapper.set_allocated_task_ack(new TaskAck(ack));
+}
+
+// 按渲染策略转换为 JSON（用于日志打印）；拒绝的 TaskAck 视为错误事件
+static void task_ack_to_json(const sapient_msg::bsi_flex_335_v2_0::SapientMessage &wrapper,
+                             bool accepted, std::string &out_json)
+{
+    sapient_json_render(wrapper, "TaskAck", out_json, !accepted, true);
+}
+
+// 构建 TaskAck 响应，并封装到 SapientMessage。
+// 成功返回 0，失败返回 -1。
+// out_serialized：封装 TaskAck 的 SapientMessage 二进制
+// out_json：便于调试的 JSON 文本
+int sapient_build_task_ack(std::string &out_serialized, std::string &out_json,
+                            const std::string &task_id_in, bool accepted, const std::string &reason_in)
+{
+    sapient_msg::bsi_flex_335_v2_0::SapientMessage wrapper;
+    build_task_ack_wrapper(wrapper, task_id_in, accepted, reason_in);
 
     // 序列化为二进制
     if (!wrapper.SerializeToString(&out_serialized)) {
         std::cerr << "Failed to serialize TaskAck message" << std::endl;
+        task_ack_to_json(wrapper, false, out_json);
         return -1;
     }
 
-    // 转换为 JSON（用于日志打印）
-    google::protobuf::util::JsonPrintOptions options;
-    options.add_whitespace = true;
-    options.always_print_primitive_fields = true;
-    if (!google::protobuf::util::MessageToJsonString(wrapper, &out_json, options).ok()) {
-        std::cerr << "Failed to convert TaskAck message to JSON" << std::endl;
+    task_ack_to_json(wrapper, accepted, out_json);
+    return 0;
+}
+
+// 帧缓冲版本：SapientMessage 直接序列化到池化帧（已带长度前缀）
+int sapient_build_task_ack_frame(SapientFramePtr &out_frame, std::string &out_json,
+                                 const std::string &task_id_in, bool accepted, const std::string &reason_in)
+{
+    sapient_msg::bsi_flex_335_v2_0::SapientMessage wrapper;
+    build_task_ack_wrapper(wrapper, task_id_in, accepted, reason_in);
+
+    if (sapient_serialize_to_frame(wrapper, out_frame) != 0) {
+        std::cerr << "Failed to serialize TaskAck message into frame" << std::endl;
+        task_ack_to_json(wrapper, false, out_json);
         return -1;
     }
 
+    task_ack_to_json(wrapper, accepted, out_json);
     return 0;
 }
 
-// 处理 Task 原始字节（来源于 SapientMessage.task）
+// 处理已解析的 Task（来源于 SapientMessage.task，按引用传入，不再序列化/重新解析）
 // 构建并返回 TaskAck 响应（使用 C++ 链接，因为涉及 std::string）。
-int sapient_handle_task(const void *task_data, size_t task_len, 
-                        std::string &out_ack_serialized, std::string &out_ack_json,
+int sapient_handle_task(const sapient_msg::bsi_flex_335_v2_0::Task &task,
+                        SapientFramePtr &out_ack_frame, std::string &out_ack_json,
                         int &out_action)
 {
     using namespace sapient_msg::bsi_flex_335_v2_0;
 
-    // 从字节解析 Task
-    Task task;
-    if (!task.ParseFromArray(task_data, (int)task_len)) {
-        LOGE("Failed to parse Task message\n");
-        return -1;
-    }
-
     // 处理任务并决定接受/拒绝，同时获取需要执行的动作
     std::string reason;
     TaskActionType action = TASK_ACTION_NONE;
@@ -175,23 +201,67 @@ int sapient_handle_task(const void *task_data, size_t task_len,
     out_action = (int)action;
 
     // 构建 TaskAck 响应
-    std::string task_id = task.has_task_id() ? task.task_id() : "";
+    static const std::string kNoTaskId;
+    const std::string &task_id = task.has_task_id() ? task.task_id() : kNoTaskId;
     
     // 如果任务被接受，设置当前任务ID（用于在status report中显示）
     if (accepted && !task_id.empty()) {
         sapient_set_current_task_id(task_id);
     }
-    
-    int ret = sapient_build_task_ack(out_ack_serialized, out_ack_json, task_id, accepted, reason);
-    if (ret != 0) {
+
+    // TaskAck 封装消息与收到的 Task 分配在同一个 arena 上（无 arena 时在堆上分配并自动释放）
+    google::protobuf::Arena *arena = task.GetArena();
+    SapientMessage *wrapper = google::protobuf::Arena::CreateMessage<SapientMessage>(arena);
+    std::unique_ptr<SapientMessage> heap_owner(arena ? nullptr : wrapper);
+    build_task_ack_wrapper(*wrapper, task_id, accepted, reason);
+
+    if (sapient_serialize_to_frame(*wrapper, out_ack_frame) != 0) {
         LOGE("sapient_build_task_ack failed\n");
+        task_ack_to_json(*wrapper, false, out_ack_json);
         return -1;
     }
+    task_ack_to_json(*wrapper, accepted, out_ack_json);
 
     LOGI("Task handled; TaskAck prepared (accepted=%d, action=%d)\n", accepted, out_action);
     return 0;
 }
 
+// 处理 Task 原始字节（兼容接口：解析到栈上 arena 后转交给已解析版本）
+int sapient_handle_task(const void *task_data, size_t task_len, 
+                        SapientFramePtr &out_ack_frame, std::string &out_ack_json,
+                        int &out_action)
+{
+    using namespace sapient_msg::bsi_flex_335_v2_0;
+
+    alignas(8) char arena_block[2048];
+    google::protobuf::ArenaOptions arena_options;
+    arena_options.initial_block = arena_block;
+    arena_options.initial_block_size = sizeof(arena_block);
+    google::protobuf::Arena arena(arena_options);
+
+    // 从字节解析 Task
+    Task *task = google::protobuf::Arena::CreateMessage<Task>(&arena);
+    if (!task->ParseFromArray(task_data, (int)task_len)) {
+        LOGE("Failed to parse Task message\n");
+        return -1;
+    }
+    return sapient_handle_task(*task, out_ack_frame, out_ack_json, out_action);
+}
+
+// 处理 Task 原始字节，输出不带长度前缀的 TaskAck 二进制（兼容接口：拷贝帧缓冲版本的消息体）
+int sapient_handle_task(const void *task_data, size_t task_len,
+                        std::string &out_ack_serialized, std::string &out_ack_json,
+                        int &out_action)
+{
+    SapientFramePtr frame;
+    int ret = sapient_handle_task(task_data, task_len, frame, out_ack_json, out_action);
+    if (ret != 0) {
+        return ret;
+    }
+    out_ack_serialized.assign((const char *)frame->body(), frame->body_len);
+    return 0;
+}
+
 // 获取当前活跃的任务ID（线程安全）
 // 返回当前任务ID，若无活跃任务则返回空字符串
 std::string sapient_get_current_task_id() {
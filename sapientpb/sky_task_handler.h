@@ -20,6 +20,9 @@
 // 仅提供 C++ 接口：使用 std::string，避免 extern "C" 冲突。
 #include <stddef.h>
 #include <string>
+#include "sapient_frame.h"
+
+namespace sapient_msg { namespace bsi_flex_335_v2_0 { class Task; } }
 
 // Task 请求类型枚举（用于指示需要执行的响应动作）
 enum TaskActionType {
@@ -45,12 +48,29 @@ void sapient_set_current_task_id(const std::string &task_id);
  */
 void sapient_clear_current_task_id();
 
+/**
+ * @brief 处理已解析的 SAPIENT Task 消息并构建 TaskAck 应答
+ *
+ * @param[in]  task               已解析的 Task（通常是接收线程中 SapientMessage.task() 的引用）
+ * @param[out] out_ack_frame      输出封装 TaskAck 的 SapientMessage 帧（已带长度前缀）
+ * @param[out] out_ack_json       输出用于调试的 JSON 文本（按 sapient_json.h 的渲染策略生成，默认为空）
+ * @param[out] out_action         输出需要执行的动作类型（见 TaskActionType）
+ *
+ * @return 0 成功；-1 构建 TaskAck 失败
+ *
+ * @note 若 task 分配在 arena 上，TaskAck 封装消息也在同一个 arena 上构建，
+ *       不再经过“序列化 Task → 再解析”的往返。
+ */
+int sapient_handle_task(const sapient_msg::bsi_flex_335_v2_0::Task &task,
+                        SapientFramePtr &out_ack_frame, std::string &out_ack_json,
+                        int &out_action);
+
 /**
  * @brief 处理 SAPIENT Task 消息并构建 TaskAck 应答
  * 
  * @param[in]  task_data          Task 的原始 protobuf 字节内容
  * @param[in]  task_len           Task 消息长度
- * @param[out] out_ack_serialized 输出封装 TaskAck 的 SapientMessage 二进制
+ * @param[out] out_ack_serialized 输出封装 TaskAck 的 SapientMessage 二进制（不带长度前缀）
  * @param[out] out_ack_json       输出用于调试的 JSON 文本
  * @param[out] out_action         输出需要执行的动作类型（见 TaskActionType）
  * 
@@ -62,6 +82,7 @@ void sapient_clear_current_task_id();
  *       - command.request="Registration" → action=TASK_ACTION_SEND_REGISTRATION
  *       - command.request="Status" → action=TASK_ACTION_SEND_STATUS
  *       - 其他 → action=TASK_ACTION_NONE（仅回复 TaskAck）
+ *       发送路径请使用帧缓冲版本，避免一次消息体拷贝
  * 
  * @warning 该函数使用 C++ 接口（std::string），仅供 C++ 代码调用
  */
@@ -69,4 +90,28 @@ int sapient_handle_task(const void *task_data, size_t task_len,
                         std::string &out_ack_serialized, std::string &out_ack_json,
                         int &out_action);
 
+/**
+ * @brief 处理 SAPIENT Task 消息并构建 TaskAck 应答（原始字节输入、帧缓冲输出版本）
+ * 
+ * @param[in]  task_data          Task 的原始 protobuf 字节内容
+ * @param[in]  task_len           Task 消息长度
+ * @param[out] out_ack_frame      输出封装 TaskAck 的 SapientMessage 帧（已带长度前缀）
+ * @param[out] out_ack_json       输出用于调试的 JSON 文本（按 sapient_json.h 的渲染策略生成，默认为空）
+ * @param[out] out_action         输出需要执行的动作类型（见 TaskActionType）
+ * 
+ * @return int 错误码
+ *         - 0: 成功
+ *         - -1: 失败（解析错误或构建 TaskAck 失败）
+ * 
+ * @note 支持的 Task 类型：
+ *       - command.request="Registration" → action=TASK_ACTION_SEND_REGISTRATION
+ *       - command.request="Status" → action=TASK_ACTION_SEND_STATUS
+ *       - 其他 → action=TASK_ACTION_NONE（仅回复 TaskAck）
+ * 
+ * @warning 该函数使用 C++ 接口（std::string / SapientFramePtr），仅供 C++ 代码调用
+ */
+int sapient_handle_task(const void *task_data, size_t task_len,
+                        SapientFramePtr &out_ack_frame, std::string &out_ack_json,
+                        int &out_action);
+
 #endif /* __SKY_TASK_HANDLER_H_ */